@@ -4,44 +4,190 @@
 //
 
 #include "AppController.h"
+#include "Log.h"
+
 #include <iostream>
+#include <thread>
+
+namespace {
+
+//==============================================================================
+
+// How often the loop looks whether the computer has finished its turn.
+const std::chrono::milliseconds s_thinkingPollInterval(10);
+
+//==============================================================================
+
+} // anonymous namespace
+
+AppSettings::AppSettings()
+	: m_hasComputerPlayer(false)
+	, m_isComputerWhite(false)
+	, m_hashMegabytes(s_defaultHashMegabytes)
+	, m_threadCount(1)
+	, m_isPonderingEnabled(true)
+	, m_isBoardFlipped(false)
+{
+}
+
+//---------------------------------------------------------------
+
+RenderStats::RenderStats()
+	: m_frameCount(0)
+	, m_drawSeconds(0.0)
+	, m_idleSeconds(0.0)
+	, m_totalSeconds(0.0)
+{
+}
+
+//---------------------------------------------------------------
 
-AppController::AppController()
+AppController::AppController(const AppSettings& settings)
 	: m_mainWindow(sf::VideoMode(800, 800), "Checkers")
 	, m_sceneRenderer(m_mainWindow, &m_game)
 	, m_game()
+	, m_boardInput(m_mainWindow, m_game)
+	, m_isSceneDirty(true)
+	, m_isBoardFlipped(false)
 {
+	if (settings.m_hasComputerPlayer)
+		m_computerPlayer.reset(new ComputerPlayer(settings.m_isComputerWhite, settings.m_searchLimits,
+			settings.m_hashMegabytes, settings.m_threadCount, settings.m_isPonderingEnabled));
+
+	m_game.SetBoardChangedCallback([this]() { m_isSceneDirty = true; });
+	if (!settings.m_recordFilePath.empty() && m_recordWriter.Open(settings.m_recordFilePath))
+		m_game.SetRecordWriter(&m_recordWriter);
+
+	SetBoardFlipped(settings.m_isBoardFlipped);
 }
 
 void AppController::Run()
 {
+	auto startTime = std::chrono::steady_clock::now();
+
 	while (m_mainWindow.isOpen())
 	{
+		if (m_isSceneDirty)
+			Draw();
+
+		// The computer starts thinking after the human move has been drawn, and plays once it is done.
+		if (m_computerPlayer && IsComputerTurn())
+		{
+			Position before = m_game.GetPosition();
+			m_computerPlayer->Update(m_game);
+
+			// Events are handled while it thinks, and like on any other idle frame once the game is over.
+			if (m_game.GetPosition() != before)
+				continue;
+		}
+
 		ProcessEvents();
-		Draw();
 	}
+
+	m_renderStats.m_totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+	double idleShare = m_renderStats.m_totalSeconds > 0.0
+		? m_renderStats.m_idleSeconds / m_renderStats.m_totalSeconds : 0.0;
+	LOG_INFO(Logger::CATEGORY_RENDER, "Drew " + std::to_string(m_renderStats.m_frameCount) + " frames in "
+		+ std::to_string(m_renderStats.m_totalSeconds) + " seconds, " + std::to_string(m_renderStats.m_drawSeconds)
+		+ " seconds drawing, idle " + std::to_string(static_cast<int>(idleShare * 100.0)) + "% of the time");
 }
 
 void AppController::Draw()
 {
 	if (m_mainWindow.isOpen())
 	{
+		auto startTime = std::chrono::steady_clock::now();
+
 		m_sceneRenderer.Draw();
 		m_mainWindow.display();
+
+		m_isSceneDirty = false;
+		++m_renderStats.m_frameCount;
+		m_renderStats.m_drawSeconds +=
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
 	}
 }
 
 void AppController::ProcessEvents()
 {
+	auto startTime = std::chrono::steady_clock::now();
+
 	sf::Event event;
-	while (m_mainWindow.pollEvent(event))
+	if (m_computerPlayer && m_computerPlayer->IsThinking())
 	{
-		if (event.type == sf::Event::Closed)
-			m_mainWindow.close();
-
-		if (event.type == sf::Event::MouseButtonPressed)
+		// Back to the loop every now and then to see whether the computer has finished.
+		if (!m_mainWindow.pollEvent(event))
 		{
-			m_sceneRenderer.OnMouseClick(sf::Vector2i(event.mouseButton.x, event.mouseButton.y));
+			std::this_thread::sleep_for(s_thinkingPollInterval);
+			m_renderStats.m_idleSeconds +=
+				std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+			return;
 		}
 	}
+	else if (!m_mainWindow.waitEvent(event))
+	{
+		return;
+	}
+
+	m_renderStats.m_idleSeconds +=
+		std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+	HandleEvent(event);
+	while (m_mainWindow.pollEvent(event))
+	{
+		HandleEvent(event);
+	}
+}
+
+void AppController::HandleEvent(const sf::Event& event)
+{
+	if (event.type == sf::Event::Closed)
+		m_mainWindow.close();
+
+	// The window contents may be lost when it is resized or comes back to the front.
+	if (event.type == sf::Event::Resized || event.type == sf::Event::GainedFocus)
+		m_isSceneDirty = true;
+
+	// Clicks are ignored while it is the computer's turn.
+	if (event.type == sf::Event::MouseButtonPressed && !IsComputerTurn())
+	{
+		m_boardInput.OnMouseClick(sf::Vector2i(event.mouseButton.x, event.mouseButton.y));
+	}
+
+	if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::BackSpace)
+		TakeBack();
+
+	if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F)
+		SetBoardFlipped(!m_isBoardFlipped);
+}
+
+void AppController::SetBoardFlipped(bool isBoardFlipped)
+{
+	// The view keeps its size, so the board still stretches with the window.
+	sf::View view = m_mainWindow.getView();
+	view.setRotation(isBoardFlipped ? 180.0f : 0.0f);
+	m_mainWindow.setView(view);
+
+	m_isBoardFlipped = isBoardFlipped;
+	m_isSceneDirty = true;
+}
+
+void AppController::TakeBack()
+{
+	// Neither the turn being searched nor the position being pondered can come up any more.
+	if (m_computerPlayer)
+		m_computerPlayer->Stop();
+
+	m_game.TakeBack();
+
+	// Against the computer its reply goes too, so the human is to move again.
+	if (IsComputerTurn())
+		m_game.TakeBack();
+}
+
+bool AppController::IsComputerTurn() const
+{
+	return m_computerPlayer
+		&& m_computerPlayer->IsWhitePlayer() == m_game.GetPosition().m_isWhitePlayerTurn;
 }
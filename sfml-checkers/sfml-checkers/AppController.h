@@ -5,22 +5,96 @@
 
 #pragma once
 
+#include "BoardInput.h"
 #include "SceneRenderer.h"
 #include "Game.h"
+#include "ComputerPlayer.h"
+#include "GameRecord.h"
 
 #include <SFML/Graphics.hpp>
 
+#include <chrono>
+#include <memory>
+#include <string>
+
+struct AppSettings
+{
+	AppSettings();
+
+	// Whether one side is played by the computer, and which one.
+	bool m_hasComputerPlayer;
+	bool m_isComputerWhite;
+
+	SearchLimits m_searchLimits;
+
+	// Memory budget of the transposition table, allocated once at startup.
+	size_t m_hashMegabytes;
+
+	// Search threads of the computer player.
+	int m_threadCount;
+
+	// Whether the computer player keeps searching while the human thinks.
+	bool m_isPonderingEnabled;
+
+	// Whether the board is shown upside down, black at the top.
+	bool m_isBoardFlipped;
+
+	// Record file the games are appended to, none if empty.
+	std::string m_recordFilePath;
+};
+
+// How the render loop spent its time.
+struct RenderStats
+{
+	RenderStats();
+
+	uint64_t m_frameCount;
+
+	// Wall time spent drawing, and blocked waiting for events.
+	double m_drawSeconds;
+	double m_idleSeconds;
+	double m_totalSeconds;
+};
+
+// Runs the window. Nothing is drawn while nothing changes: the loop blocks on the next event and
+// only redraws once the board or the window changed. While the computer thinks it wakes up every
+// few milliseconds instead, to play the turn once the search finished.
 class AppController
 {
 public:
-	AppController();
+	AppController(const AppSettings& settings);
 
 	void Run();
 	void Draw();
+
+	// Blocks until an event arrives, then handles it and every other one that is pending. While the
+	// computer thinks it waits no longer than the poll interval.
 	void ProcessEvents();
 
+	const RenderStats& GetRenderStats() const { return m_renderStats; }
+
 private:
+	// Takes back the last turn of the human player, and the computer's reply to it.
+	void TakeBack();
+
+	// Whether the side to move is played by the computer.
+	bool IsComputerTurn() const;
+
+	void HandleEvent(const sf::Event& event);
+
+	// Turns the board around by rotating the view, which the input mapping follows.
+	void SetBoardFlipped(bool isBoardFlipped);
+
 	sf::RenderWindow m_mainWindow;
 	Game m_game;
 	SceneRenderer m_sceneRenderer;
+	BoardInput m_boardInput;
+	std::unique_ptr<ComputerPlayer> m_computerPlayer;
+	GameRecordWriter m_recordWriter;
+
+	// Set when the board or the window changed since the last frame.
+	bool m_isSceneDirty;
+	bool m_isBoardFlipped;
+
+	RenderStats m_renderStats;
 };
@@ -0,0 +1,161 @@
+//---------------------------------------------------------------
+//
+// BatchMoveGenerator.cpp
+//
+
+#include "BatchMoveGenerator.h"
+#include "MoveGenerator.h"
+
+#include <algorithm>
+
+namespace {
+
+//==============================================================================
+
+// Positions a thread takes at a time.
+const size_t s_chunkSize = 256;
+
+// Turns a thread collects before reserving room for them in the output. A position is only
+// started with room for the most turns it could have.
+const int s_stagedTurnCapacity = 1024;
+
+//==============================================================================
+
+} // anonymous namespace
+
+BatchMoveGenerator::BatchMoveGenerator(int threadCount)
+	: m_batchNumber(0)
+	, m_busyWorkerCount(0)
+	, m_isShuttingDown(false)
+	, m_positions(nullptr)
+	, m_positionCount(0)
+	, m_turns(nullptr)
+	, m_turnCapacity(0)
+	, m_ranges(nullptr)
+	, m_nextChunk(0)
+	, m_nextTurn(0)
+{
+	for (int i = 1; i < threadCount; ++i)
+	{
+		m_threads.emplace_back(&BatchMoveGenerator::RunWorker, this);
+	}
+}
+
+BatchMoveGenerator::~BatchMoveGenerator()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isShuttingDown = true;
+	}
+
+	m_workReady.notify_all();
+	for (std::thread& thread : m_threads)
+	{
+		thread.join();
+	}
+}
+
+bool BatchMoveGenerator::Generate(const Position* positions, size_t positionCount, PackedMove* turnsOut,
+	size_t turnCapacity, TurnRange* rangesOut, uint64_t& turnCountOut)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_positions = positions;
+		m_positionCount = positionCount;
+		m_turns = turnsOut;
+		m_turnCapacity = turnCapacity;
+		m_ranges = rangesOut;
+		m_nextChunk = 0;
+		m_nextTurn = 0;
+		m_busyWorkerCount = static_cast<int>(m_threads.size());
+		++m_batchNumber;
+	}
+
+	m_workReady.notify_all();
+	GenerateChunks();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_workDone.wait(lock, [this]() { return m_busyWorkerCount == 0; });
+
+	turnCountOut = m_nextTurn;
+	return turnCountOut <= turnCapacity;
+}
+
+void BatchMoveGenerator::RunWorker()
+{
+	uint64_t finishedBatchNumber = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_workReady.wait(lock, [&]() { return m_isShuttingDown || m_batchNumber != finishedBatchNumber; });
+			if (m_isShuttingDown)
+				return;
+
+			finishedBatchNumber = m_batchNumber;
+		}
+
+		GenerateChunks();
+
+		bool isLastWorker;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			isLastWorker = --m_busyWorkerCount == 0;
+		}
+
+		if (isLastWorker)
+			m_workDone.notify_one();
+	}
+}
+
+void BatchMoveGenerator::GenerateChunks()
+{
+	MoveList turns;
+	PackedMove stagedTurns[s_stagedTurnCapacity];
+	int stagedCount = 0;
+
+	// Positions whose turns are staged, from the first one on.
+	size_t firstStagedPosition = 0;
+
+	// Reserves room for the staged turns and copies them out, offsetting the ranges of their
+	// positions, which hold offsets into the staging buffer until then.
+	auto flushStagedTurns = [&](size_t endPosition)
+	{
+		uint64_t offset = m_nextTurn.fetch_add(stagedCount);
+		if (offset + stagedCount <= m_turnCapacity)
+			std::copy(stagedTurns, stagedTurns + stagedCount, m_turns + offset);
+
+		for (size_t i = firstStagedPosition; i < endPosition; ++i)
+		{
+			m_ranges[i].m_offset += static_cast<uint32_t>(offset);
+		}
+
+		stagedCount = 0;
+		firstStagedPosition = endPosition;
+	};
+
+	for (;;)
+	{
+		size_t chunkStart = m_nextChunk.fetch_add(1) * s_chunkSize;
+		if (chunkStart >= m_positionCount)
+			break;
+
+		size_t chunkEnd = std::min(chunkStart + s_chunkSize, m_positionCount);
+		firstStagedPosition = chunkStart;
+		for (size_t i = chunkStart; i < chunkEnd; ++i)
+		{
+			if (stagedCount + s_maxMoveCount > s_stagedTurnCapacity)
+				flushStagedTurns(i);
+
+			turns.Clear();
+			MoveGenerator::GenerateTurns(m_positions[i], turns);
+
+			m_ranges[i].m_offset = static_cast<uint32_t>(stagedCount);
+			m_ranges[i].m_count = static_cast<uint32_t>(turns.GetSize());
+			std::copy(turns.begin(), turns.end(), stagedTurns + stagedCount);
+			stagedCount += turns.GetSize();
+		}
+
+		flushStagedTurns(chunkEnd);
+	}
+}
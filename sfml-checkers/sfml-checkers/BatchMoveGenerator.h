@@ -0,0 +1,78 @@
+//---------------------------------------------------------------
+//
+// BatchMoveGenerator.h
+//
+
+#pragma once
+
+#include "MoveList.h"
+#include "Position.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Where the turns of one position are in the output buffer.
+struct TurnRange
+{
+	uint32_t m_offset;
+	uint32_t m_count;
+};
+
+// Legal turns of many independent positions at once, for data pipelines. No Game is involved: every
+// position goes straight through MoveGenerator::GenerateTurns. The threads are started once and
+// wait between batches, and generating allocates nothing.
+//
+// Threads take the positions in chunks, collect the turns of a chunk on their stack and then
+// reserve room for them in the output with one atomic add. Each position's turns are contiguous
+// and in generator order, but chunks land in the buffer in the order they finish, so the ranges
+// say where each position's turns are.
+class BatchMoveGenerator
+{
+public:
+	// The calling thread works too, so this starts threadCount - 1 threads.
+	explicit BatchMoveGenerator(int threadCount);
+	~BatchMoveGenerator();
+
+	BatchMoveGenerator(const BatchMoveGenerator&) = delete;
+	BatchMoveGenerator& operator=(const BatchMoveGenerator&) = delete;
+
+	// Writes the turns of every position to turnsOut and where they are to rangesOut, which has room
+	// for one range per position. The total number of turns is returned in turnCountOut. Returns
+	// false if that is more than turnCapacity, the output is then incomplete and the call should be
+	// repeated with a buffer of at least that size.
+	bool Generate(const Position* positions, size_t positionCount, PackedMove* turnsOut, size_t turnCapacity,
+		TurnRange* rangesOut, uint64_t& turnCountOut);
+
+	int GetThreadCount() const { return static_cast<int>(m_threads.size()) + 1; }
+
+private:
+	void RunWorker();
+
+	// Takes chunks until there are none left.
+	void GenerateChunks();
+
+	std::vector<std::thread> m_threads;
+
+	std::mutex m_mutex;
+	std::condition_variable m_workReady;
+	std::condition_variable m_workDone;
+
+	// Counts batches, so a waiting worker can tell a new one from the one it finished.
+	uint64_t m_batchNumber;
+	int m_busyWorkerCount;
+	bool m_isShuttingDown;
+
+	// The batch under way.
+	const Position* m_positions;
+	size_t m_positionCount;
+	PackedMove* m_turns;
+	size_t m_turnCapacity;
+	TurnRange* m_ranges;
+
+	std::atomic<size_t> m_nextChunk;
+	std::atomic<uint64_t> m_nextTurn;
+};
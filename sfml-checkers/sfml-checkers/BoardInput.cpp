@@ -0,0 +1,49 @@
+//---------------------------------------------------------------
+//
+// BoardInput.cpp
+//
+
+#include "BoardInput.h"
+#include "Game.h"
+#include "Log.h"
+
+#include <cmath>
+
+BoardInput::BoardInput(const sf::RenderWindow& window, Game& game)
+	: m_window(&window)
+	, m_game(&game)
+{
+}
+
+BoardInput::~BoardInput()
+{
+}
+
+void BoardInput::OnMouseClick(const sf::Vector2i& pixel)
+{
+	LOG_DEBUG_OUTPUT_WINDOW(Logger::CATEGORY_INPUT, "Mouse button Clicked: (" + std::to_string(pixel.x) + " , "
+		+ std::to_string(pixel.y) + ") ");
+
+	BoardIndex boardIndex = GetBoardIndexFromPixel(pixel);
+	if (boardIndex.first < 0)
+	{
+		LOG_DEBUG_OUTPUT_WINDOW(Logger::CATEGORY_INPUT, "Failed to find a valid location.");
+		return;
+	}
+
+	// Notify game of a move selection event
+	m_game->OnMoveSelectionEvent(boardIndex);
+}
+
+BoardIndex BoardInput::GetBoardIndexFromPixel(const sf::Vector2i& pixel) const
+{
+	// Undoes the view: its scale after a resize, and its rotation when the board is flipped.
+	sf::Vector2f coords = m_window->mapPixelToCoords(pixel);
+
+	int row = static_cast<int>(std::floor(coords.y / s_squareSize));
+	int col = static_cast<int>(std::floor(coords.x / s_squareSize));
+	if (row < 0 || row >= s_boardSize || col < 0 || col >= s_boardSize)
+		return BoardIndex(-1, -1);
+
+	return BoardIndex(row, col);
+}
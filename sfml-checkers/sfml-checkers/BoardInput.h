@@ -0,0 +1,32 @@
+//---------------------------------------------------------------
+//
+// BoardInput.h
+//
+
+#pragma once
+
+#include "CheckersTypes.h"
+
+#include <SFML/Graphics.hpp>
+
+class Game;
+
+// Turns window input into board selections. A click is mapped to its square arithmetically through
+// the current view of the window, so it costs the same however the window is sized, however the
+// board is oriented and whatever else is drawn on top.
+class BoardInput
+{
+public:
+	BoardInput(const sf::RenderWindow& window, Game& game);
+	~BoardInput();
+
+	// Selects the square under the pixel, if there is one.
+	void OnMouseClick(const sf::Vector2i& pixel);
+
+	// Returns the square under the pixel, or an invalid index (-1, -1) off the board.
+	BoardIndex GetBoardIndexFromPixel(const sf::Vector2i& pixel) const;
+
+private:
+	const sf::RenderWindow* m_window;
+	Game* m_game;
+};
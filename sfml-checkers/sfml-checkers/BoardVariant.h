@@ -0,0 +1,334 @@
+//---------------------------------------------------------------
+//
+// BoardVariant.h
+//
+// Board geometry and rule sets for draughts variants, and a position that works with any of
+// them. The game itself plays English draughts on the 8x8 Position, which is tuned for exactly
+// that board. These templates run the other variants on the same engine: every rule set gets its
+// own constant direction tables and the narrowest bitboard its squares fit in.
+//
+
+#pragma once
+
+#include "CheckersTypes.h"
+
+#include <cstdint>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// English draughts, the rules of the game: men only move and capture forward, kings move a single
+// step, any capture may be chosen and a man crowned during a capture ends the turn there.
+struct EnglishRules
+{
+	static const int s_boardSize = 8;
+	static const int s_rowsPerSide = 3;
+	static const bool s_hasFlyingKings = false;
+	static const bool s_canMenCaptureBackward = false;
+	static const bool s_isMaximumCaptureMandatory = false;
+	static const bool s_doesCrowningEndTurn = true;
+
+	// Whether captures that reach the same square over the same pieces along different paths are
+	// different moves.
+	static const bool s_isCapturePathSignificant = true;
+};
+
+// International draughts on 10x10: kings fly along the whole diagonal, men capture backward too,
+// the capture taking the most pieces is mandatory and a man is only crowned if it ends its turn on
+// the far row.
+struct InternationalRules
+{
+	static const int s_boardSize = 10;
+	static const int s_rowsPerSide = 4;
+	static const bool s_hasFlyingKings = true;
+	static const bool s_canMenCaptureBackward = true;
+	static const bool s_isMaximumCaptureMandatory = true;
+	static const bool s_doesCrowningEndTurn = false;
+	static const bool s_isCapturePathSignificant = false;
+};
+
+// Canadian draughts, the international rules on 12x12.
+struct CanadianRules : InternationalRules
+{
+	static const int s_boardSize = 12;
+	static const int s_rowsPerSide = 5;
+};
+
+//---------------------------------------------------------------
+
+// Bitboard of a board with more than 64 playable squares.
+struct WideBitboard
+{
+	constexpr WideBitboard()
+		: m_low(0)
+		, m_high(0)
+	{
+	}
+
+	constexpr WideBitboard(uint64_t low, uint64_t high)
+		: m_low(low)
+		, m_high(high)
+	{
+	}
+
+	constexpr WideBitboard operator&(const WideBitboard& other) const { return WideBitboard(m_low & other.m_low, m_high & other.m_high); }
+	constexpr WideBitboard operator|(const WideBitboard& other) const { return WideBitboard(m_low | other.m_low, m_high | other.m_high); }
+	constexpr WideBitboard operator^(const WideBitboard& other) const { return WideBitboard(m_low ^ other.m_low, m_high ^ other.m_high); }
+	constexpr WideBitboard operator~() const { return WideBitboard(~m_low, ~m_high); }
+
+	WideBitboard& operator&=(const WideBitboard& other) { return *this = *this & other; }
+	WideBitboard& operator|=(const WideBitboard& other) { return *this = *this | other; }
+	WideBitboard& operator^=(const WideBitboard& other) { return *this = *this ^ other; }
+
+	constexpr bool operator==(const WideBitboard& other) const { return m_low == other.m_low && m_high == other.m_high; }
+	constexpr bool operator!=(const WideBitboard& other) const { return !(*this == other); }
+
+	constexpr explicit operator bool() const { return m_low != 0 || m_high != 0; }
+
+	uint64_t m_low;
+	uint64_t m_high;
+};
+
+// Square and bit counting operations on the bitboard types of the variants.
+template <class BitboardType>
+struct BitboardTraits;
+
+template <>
+struct BitboardTraits<uint32_t>
+{
+	static constexpr uint32_t SquareMask(int square) { return uint32_t(1) << square; }
+
+	// The bitboard must not be empty.
+	static int GetLowestSquare(uint32_t bitboard)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, bitboard);
+		return static_cast<int>(index);
+#else
+		return __builtin_ctz(bitboard);
+#endif
+	}
+
+	static int GetSquareCount(uint32_t bitboard)
+	{
+#if defined(_MSC_VER)
+		return static_cast<int>(__popcnt(bitboard));
+#else
+		return __builtin_popcount(bitboard);
+#endif
+	}
+
+	static uint32_t RemoveLowestSquare(uint32_t bitboard) { return bitboard & (bitboard - 1); }
+};
+
+template <>
+struct BitboardTraits<uint64_t>
+{
+	static constexpr uint64_t SquareMask(int square) { return uint64_t(1) << square; }
+
+	static int GetLowestSquare(uint64_t bitboard)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward64(&index, bitboard);
+		return static_cast<int>(index);
+#else
+		return __builtin_ctzll(bitboard);
+#endif
+	}
+
+	static int GetSquareCount(uint64_t bitboard)
+	{
+#if defined(_MSC_VER)
+		return static_cast<int>(__popcnt64(bitboard));
+#else
+		return __builtin_popcountll(bitboard);
+#endif
+	}
+
+	static uint64_t RemoveLowestSquare(uint64_t bitboard) { return bitboard & (bitboard - 1); }
+};
+
+template <>
+struct BitboardTraits<WideBitboard>
+{
+	static constexpr WideBitboard SquareMask(int square)
+	{
+		return square < 64 ? WideBitboard(uint64_t(1) << square, 0) : WideBitboard(0, uint64_t(1) << (square - 64));
+	}
+
+	static int GetLowestSquare(const WideBitboard& bitboard)
+	{
+		return bitboard.m_low ? BitboardTraits<uint64_t>::GetLowestSquare(bitboard.m_low)
+			: 64 + BitboardTraits<uint64_t>::GetLowestSquare(bitboard.m_high);
+	}
+
+	static int GetSquareCount(const WideBitboard& bitboard)
+	{
+		return BitboardTraits<uint64_t>::GetSquareCount(bitboard.m_low)
+			+ BitboardTraits<uint64_t>::GetSquareCount(bitboard.m_high);
+	}
+
+	static WideBitboard RemoveLowestSquare(const WideBitboard& bitboard)
+	{
+		return bitboard.m_low ? WideBitboard(bitboard.m_low & (bitboard.m_low - 1), bitboard.m_high)
+			: WideBitboard(0, bitboard.m_high & (bitboard.m_high - 1));
+	}
+};
+
+//---------------------------------------------------------------
+
+// Diagonal directions, south being toward the higher rows.
+enum BoardDirection
+{
+	DIRECTION_SOUTH_EAST,
+	DIRECTION_SOUTH_WEST,
+	DIRECTION_NORTH_EAST,
+	DIRECTION_NORTH_WEST,
+	DIRECTION_COUNT,
+};
+
+// Playable squares of a square board, numbered row by row from the top left like the 8x8 board:
+// even rows have their playable squares on the odd columns, odd rows on the even columns. Rather
+// than the shifts of the 8x8 generator, which depend on the board width, every square looks up its
+// neighbors in a table built at compile time.
+template <int BoardSize>
+struct BoardGeometry
+{
+	static const int s_boardSize = BoardSize;
+	static const int s_squaresPerRow = BoardSize / 2;
+	static const int s_squareCount = BoardSize * BoardSize / 2;
+
+	// 32 squares on 8x8, 50 on 10x10 and 72 on 12x12.
+	typedef std::conditional_t<(s_squareCount <= 32), uint32_t,
+		std::conditional_t<(s_squareCount <= 64), uint64_t, WideBitboard>> Bitboard;
+	typedef BitboardTraits<Bitboard> Traits;
+
+	struct NeighborTable
+	{
+		// The square one step in every direction, -1 off the board.
+		int8_t m_neighbors[s_squareCount][DIRECTION_COUNT];
+	};
+
+	static constexpr int GetRow(int square) { return square / s_squaresPerRow; }
+	static constexpr int GetColumn(int square) { return 2 * (square % s_squaresPerRow) + ((GetRow(square) & 1) ^ 1); }
+
+	static constexpr NeighborTable CreateNeighborTable()
+	{
+		NeighborTable table = {};
+		const int rowSteps[DIRECTION_COUNT] = { 1, 1, -1, -1 };
+		const int columnSteps[DIRECTION_COUNT] = { 1, -1, 1, -1 };
+
+		for (int square = 0; square < s_squareCount; ++square)
+		{
+			for (int direction = 0; direction < DIRECTION_COUNT; ++direction)
+			{
+				int row = GetRow(square) + rowSteps[direction];
+				int column = GetColumn(square) + columnSteps[direction];
+				bool isOnBoard = row >= 0 && row < BoardSize && column >= 0 && column < BoardSize;
+				table.m_neighbors[square][direction] =
+					static_cast<int8_t>(isOnBoard ? row * s_squaresPerRow + column / 2 : -1);
+			}
+		}
+
+		return table;
+	}
+
+	static constexpr Bitboard CreateRowMask(int firstRow, int rowCount)
+	{
+		Bitboard mask = Bitboard();
+		for (int square = firstRow * s_squaresPerRow; square < (firstRow + rowCount) * s_squaresPerRow; ++square)
+		{
+			mask = mask | Traits::SquareMask(square);
+		}
+
+		return mask;
+	}
+
+	static constexpr NeighborTable s_neighborTable = CreateNeighborTable();
+
+	static constexpr Bitboard s_allSquares = CreateRowMask(0, BoardSize);
+	static constexpr Bitboard s_topRow = CreateRowMask(0, 1);
+	static constexpr Bitboard s_bottomRow = CreateRowMask(BoardSize - 1, 1);
+
+	static int GetNeighbor(int square, BoardDirection direction) { return s_neighborTable.m_neighbors[square][direction]; }
+};
+
+//---------------------------------------------------------------
+
+// A turn of a variant: the piece's source and final destination, and every piece it captured.
+template <class Rules>
+struct VariantMove
+{
+	typedef typename BoardGeometry<Rules::s_boardSize>::Bitboard Bitboard;
+
+	bool IsCapture() const { return static_cast<bool>(m_capturedPieces); }
+
+	bool operator==(const VariantMove& other) const
+	{
+		return m_source == other.m_source && m_destination == other.m_destination
+			&& m_capturedPieces == other.m_capturedPieces;
+	}
+
+	Bitboard m_capturedPieces;
+	int8_t m_source;
+	int8_t m_destination;
+};
+
+// The Position of a variant: bitboards of the white pieces, the black pieces and the kings, and
+// the side to move. As on 8x8 white starts on top, moves south and moves first.
+template <class Rules>
+struct VariantPosition
+{
+	typedef BoardGeometry<Rules::s_boardSize> Geometry;
+	typedef typename Geometry::Bitboard Bitboard;
+	typedef typename Geometry::Traits Traits;
+
+	static VariantPosition CreateStartPosition()
+	{
+		VariantPosition position;
+		position.m_whitePieces = Geometry::CreateRowMask(0, Rules::s_rowsPerSide);
+		position.m_blackPieces = Geometry::CreateRowMask(Rules::s_boardSize - Rules::s_rowsPerSide, Rules::s_rowsPerSide);
+		position.m_kings = Bitboard();
+		position.m_isWhitePlayerTurn = true;
+		return position;
+	}
+
+	// Plays the turn and passes it to the opponent. A man ending on the far row is crowned.
+	void MakeMove(const VariantMove<Rules>& move)
+	{
+		Bitboard sourceMask = Traits::SquareMask(move.m_source);
+		Bitboard destinationMask = Traits::SquareMask(move.m_destination);
+		bool isKing = static_cast<bool>(m_kings & sourceMask);
+
+		Bitboard& pieces = m_isWhitePlayerTurn ? m_whitePieces : m_blackPieces;
+		Bitboard& enemies = m_isWhitePlayerTurn ? m_blackPieces : m_whitePieces;
+
+		// Cleared before setting, a capture sequence may end on its own source square.
+		pieces = (pieces & ~sourceMask) | destinationMask;
+		enemies = enemies & ~move.m_capturedPieces;
+		m_kings = m_kings & ~(sourceMask | move.m_capturedPieces);
+
+		if (isKing || (destinationMask & GetCrownRow()))
+			m_kings = m_kings | destinationMask;
+
+		m_isWhitePlayerTurn = !m_isWhitePlayerTurn;
+	}
+
+	Bitboard GetOccupied() const { return m_whitePieces | m_blackPieces; }
+	Bitboard GetEmpty() const { return Geometry::s_allSquares & ~GetOccupied(); }
+
+	Bitboard GetPlayerPieces() const { return m_isWhitePlayerTurn ? m_whitePieces : m_blackPieces; }
+	Bitboard GetEnemyPieces() const { return m_isWhitePlayerTurn ? m_blackPieces : m_whitePieces; }
+
+	// The row the men of the side to move are crowned on.
+	Bitboard GetCrownRow() const { return m_isWhitePlayerTurn ? Geometry::s_bottomRow : Geometry::s_topRow; }
+
+	Bitboard m_whitePieces;
+	Bitboard m_blackPieces;
+	Bitboard m_kings;
+	bool m_isWhitePlayerTurn;
+};
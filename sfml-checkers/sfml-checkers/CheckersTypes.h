@@ -4,7 +4,7 @@
 //
 
 #pragma once
-#include <vector>
+#include <utility>
 
 namespace {
 	const float s_squareSize = 100.0f;
@@ -22,5 +22,4 @@ enum PieceDisplayType
 	INVALID = -1,
 };
 
-typedef std::vector<std::vector<PieceDisplayType>> BoardData;
 typedef std::pair<int, int> BoardIndex;
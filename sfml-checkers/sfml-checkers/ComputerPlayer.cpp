@@ -0,0 +1,173 @@
+//---------------------------------------------------------------
+//
+// ComputerPlayer.cpp
+//
+
+#include "ComputerPlayer.h"
+#include "Game.h"
+#include "Log.h"
+#include "MoveGenerator.h"
+
+ComputerPlayer::ComputerPlayer(bool isWhitePlayer, const SearchLimits& searchLimits, size_t hashMegabytes,
+	int threadCount, bool isPonderingEnabled)
+	: m_isWhitePlayer(isWhitePlayer)
+	, m_searchLimits(searchLimits)
+	, m_searchEngine(hashMegabytes, threadCount)
+	, m_isThinking(false)
+	, m_isTurnStopped(false)
+	, m_isTurnDone(false)
+	, m_isPonderingEnabled(isPonderingEnabled)
+	, m_isPondering(false)
+	, m_isPonderStopped(false)
+	, m_isPonderDone(false)
+{
+}
+
+ComputerPlayer::~ComputerPlayer()
+{
+	Stop();
+}
+
+void ComputerPlayer::Update(Game& game)
+{
+	if (game.GetPosition().m_isWhitePlayerTurn != m_isWhitePlayer)
+		return;
+
+	if (!m_isThinking)
+	{
+		// Without a legal turn the game is over, there is nothing to search.
+		MoveList turns;
+		MoveGenerator::GenerateTurns(game.GetPosition(), turns);
+		if (!turns.IsEmpty())
+			StartThinking(game.GetPosition());
+
+		return;
+	}
+
+	if (!m_isTurnDone)
+		return;
+
+	m_turnThread.join();
+	m_isThinking = false;
+
+	const SearchResult& result = m_turnResult;
+	if (result.m_bestMove.empty())
+		return;
+
+	LOG_INFO(Logger::CATEGORY_SEARCH, "Computer searched depth " + std::to_string(result.m_depth) + ", score "
+		+ std::to_string(result.m_score) + ", " + std::to_string(result.m_nodes) + " nodes, "
+		+ std::to_string(static_cast<uint64_t>(result.m_nodesPerSecond)) + " nodes/sec, branching factor "
+		+ std::to_string(result.m_effectiveBranchingFactor) + ", hash hits "
+		+ std::to_string(result.m_hashHitRate) + ", hash collisions " + std::to_string(result.m_hashCollisionRate));
+
+	game.PlayMove(result.m_bestTurn);
+
+	if (m_isPonderingEnabled && result.m_hasPonderTurn)
+		StartPondering(game.GetPosition(), result.m_ponderTurn);
+}
+
+void ComputerPlayer::Stop()
+{
+	m_isTurnStopped = true;
+	m_isPonderStopped = true;
+
+	// The turn thread may be waiting for the ponder search, which the flag ends as well.
+	if (m_isThinking)
+	{
+		m_turnThread.join();
+		m_isThinking = false;
+	}
+
+	StopPondering();
+}
+
+void ComputerPlayer::StartThinking(const Position& position)
+{
+	bool isPonderHit = m_isPondering && position == m_ponderPosition;
+	if (isPonderHit)
+		LOG_INFO(Logger::CATEGORY_SEARCH, "Ponder hit");
+	else if (m_isPondering)
+		LOG_INFO(Logger::CATEGORY_SEARCH, "Ponder miss");
+
+	SearchLimits turnLimits = m_searchLimits;
+	turnLimits.m_stopFlag = &m_isTurnStopped;
+
+	m_isTurnStopped = false;
+	m_isTurnDone = false;
+	m_isThinking = true;
+
+	// Pondering is only touched by the turn thread until Update or Stop joined it.
+	m_turnThread = std::thread([this, position, turnLimits, isPonderHit]()
+	{
+		if (isPonderHit)
+		{
+			m_turnResult = FinishPonderHit();
+		}
+		else
+		{
+			StopPondering();
+			m_turnResult = m_searchEngine.Search(position, turnLimits);
+		}
+
+		m_isTurnDone = true;
+	});
+}
+
+void ComputerPlayer::StopPondering()
+{
+	if (!m_isPondering)
+		return;
+
+	m_isPonderStopped = true;
+	m_ponderThread.join();
+	m_isPondering = false;
+}
+
+void ComputerPlayer::StartPondering(const Position& position, const PackedMove& expectedReply)
+{
+	m_ponderPosition = position;
+	UndoRecord undo;
+	m_ponderPosition.MakeMove(expectedReply.GetSource(), expectedReply.GetDestination(),
+		expectedReply.GetCapturedPieces(), undo);
+
+	// No time limit while the opponent thinks, the other limits are those of a normal search.
+	SearchLimits ponderLimits = m_searchLimits;
+	ponderLimits.m_moveTimeMs = 0;
+	ponderLimits.m_stopFlag = &m_isPonderStopped;
+
+	m_isPonderStopped = false;
+	m_isPonderDone = false;
+	m_ponderStartTime = std::chrono::steady_clock::now();
+	m_isPondering = true;
+
+	m_ponderThread = std::thread([this, ponderLimits]()
+	{
+		SearchResult result = m_searchEngine.Search(m_ponderPosition, ponderLimits);
+
+		std::lock_guard<std::mutex> lock(m_ponderMutex);
+		m_ponderResult = result;
+		m_isPonderDone = true;
+		m_ponderDone.notify_one();
+	});
+}
+
+SearchResult ComputerPlayer::FinishPonderHit()
+{
+	// Without a move time the ponder search ends at the same depth or node limit a normal search
+	// would, with one the time already spent pondering counts. Stop ends it early either way.
+	{
+		std::unique_lock<std::mutex> lock(m_ponderMutex);
+		if (m_searchLimits.m_moveTimeMs > 0)
+		{
+			auto deadline = m_ponderStartTime + std::chrono::milliseconds(m_searchLimits.m_moveTimeMs);
+			m_ponderDone.wait_until(lock, deadline, [this]() { return m_isPonderDone; });
+		}
+		else
+		{
+			m_ponderDone.wait(lock, [this]() { return m_isPonderDone; });
+		}
+	}
+
+	StopPondering();
+	return m_ponderResult;
+}
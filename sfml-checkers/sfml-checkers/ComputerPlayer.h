@@ -0,0 +1,90 @@
+//---------------------------------------------------------------
+//
+// ComputerPlayer.h
+//
+
+#pragma once
+
+#include "Search.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+class Game;
+
+// Plays one side of the game. It is an alternative move source to the mouse: the chosen turn is
+// played with Game::PlayMove as one move, a capture chain included, after the same legality check
+// every turn goes through.
+//
+// Turns are searched on a thread of their own, the caller only checks now and then whether the
+// search has finished, so the window keeps handling events while the computer thinks.
+//
+// With pondering on, the player keeps searching on another thread while the opponent thinks: it
+// guesses the reply from its last search and searches the position after it, in the same engine
+// and so the same transposition table. If the opponent plays the guessed reply, that search carries
+// on into the answer. Otherwise it is stopped and the real position searched, starting from a table
+// warmed by both searches.
+class ComputerPlayer
+{
+public:
+	ComputerPlayer(bool isWhitePlayer, const SearchLimits& searchLimits, size_t hashMegabytes, int threadCount,
+		bool isPonderingEnabled);
+	~ComputerPlayer();
+
+	// Starts searching if it is this player's turn, and plays the turn once the search finished,
+	// then starts pondering. Never waits for the search.
+	void Update(Game& game);
+
+	// Whether a turn is being searched, Update plays it once it is done.
+	bool IsThinking() const { return m_isThinking; }
+
+	// Stops the search of a turn and pondering, and waits for their threads, which takes no more
+	// than a few thousand nodes. Used when the game changes other than by a move of the opponent.
+	void Stop();
+
+	bool IsWhitePlayer() const { return m_isWhitePlayer; }
+
+private:
+	// Searches the turn on the turn thread, from the ponder search if it searched this position.
+	void StartThinking(const Position& position);
+
+	void StopPondering();
+
+	// Searches the position after the expected reply on the ponder thread.
+	void StartPondering(const Position& position, const PackedMove& expectedReply);
+
+	// The opponent played the expected reply: lets the ponder search use what is left of the move
+	// time counted from when it started, or finish its depth or node limit, and returns its result.
+	// Runs on the turn thread.
+	SearchResult FinishPonderHit();
+
+	bool m_isWhitePlayer;
+	SearchLimits m_searchLimits;
+	SearchEngine m_searchEngine;
+
+	bool m_isThinking;
+	std::thread m_turnThread;
+	std::atomic<bool> m_isTurnStopped;
+
+	// Written by the turn thread before it sets the done flag.
+	std::atomic<bool> m_isTurnDone;
+	SearchResult m_turnResult;
+
+	bool m_isPonderingEnabled;
+	bool m_isPondering;
+	std::thread m_ponderThread;
+	std::atomic<bool> m_isPonderStopped;
+
+	// The position being pondered and when that started. Written before the thread starts.
+	Position m_ponderPosition;
+	std::chrono::steady_clock::time_point m_ponderStartTime;
+
+	// Written by the ponder thread when its search ends.
+	std::mutex m_ponderMutex;
+	std::condition_variable m_ponderDone;
+	bool m_isPonderDone;
+	SearchResult m_ponderResult;
+};
@@ -0,0 +1,210 @@
+//---------------------------------------------------------------
+//
+// EvalBenchMain.cpp
+//
+// Evaluation benchmark. Collects positions from random games, checks that every batch kernel scores
+// them exactly as the scalar evaluation does, and reports the positions per second of the scalar
+// evaluation one position at a time and of every kernel the processor supports.
+//
+// usage: eval-bench [--positions <count>] [--passes <count>] [--seed <seed>]
+//
+
+#include "Evaluation.h"
+#include "Game.h"
+#include "MoveGenerator.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+//==============================================================================
+
+const int s_defaultPositionCount = 1000000;
+const int s_defaultPassCount = 10;
+
+// Random games are cut off after this many turns.
+const int s_maxGameTurns = 200;
+
+struct EvalBenchOptions
+{
+	EvalBenchOptions()
+		: m_positionCount(s_defaultPositionCount)
+		, m_passCount(s_defaultPassCount)
+		, m_seed(1)
+	{
+	}
+
+	int m_positionCount;
+	int m_passCount;
+	uint64_t m_seed;
+};
+
+void PrintUsage()
+{
+	std::printf("usage: eval-bench [--positions <count>] [--passes <count>] [--seed <seed>]\n"
+		"  --positions  positions to evaluate, defaults to %d\n"
+		"  --passes     times every position is evaluated, defaults to %d\n"
+		"  --seed       seed of the random games the positions come from\n",
+		s_defaultPositionCount, s_defaultPassCount);
+}
+
+bool ParseOptions(int argc, char** argv, EvalBenchOptions& optionsOut)
+{
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string argument(argv[i]);
+		std::string value(argv[i + 1]);
+
+		if (argument == "--positions")
+			optionsOut.m_positionCount = std::atoi(value.c_str());
+		else if (argument == "--passes")
+			optionsOut.m_passCount = std::atoi(value.c_str());
+		else if (argument == "--seed")
+			optionsOut.m_seed = std::strtoull(value.c_str(), nullptr, 10);
+		else
+			return false;
+	}
+
+	return (argc % 2) == 1 && optionsOut.m_positionCount > 0 && optionsOut.m_passCount > 0;
+}
+
+// Every position of random games played through Game, until there are enough.
+void CollectPositions(const EvalBenchOptions& options, std::vector<Position>& positionsOut)
+{
+	std::mt19937_64 random(options.m_seed);
+	MoveList turns;
+	while (static_cast<int>(positionsOut.size()) < options.m_positionCount)
+	{
+		Game game;
+		for (int turn = 0; turn < s_maxGameTurns && static_cast<int>(positionsOut.size()) < options.m_positionCount;
+			++turn)
+		{
+			positionsOut.push_back(game.GetPosition());
+
+			turns.Clear();
+			MoveGenerator::GenerateTurns(game.GetPosition(), turns);
+			if (turns.IsEmpty())
+				break;
+
+			game.PlayMove(turns[static_cast<int>(random() % turns.GetSize())]);
+		}
+	}
+}
+
+double GetSecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void PrintRate(const char* name, uint64_t evaluationCount, double seconds, double baseRate, int64_t checksum)
+{
+	double rate = seconds > 0.0 ? evaluationCount / seconds : 0.0;
+	std::printf("%-8s %12.0f positions/sec  %5.2fx  (checksum %lld)\n", name, rate,
+		baseRate > 0.0 ? rate / baseRate : 1.0, static_cast<long long>(checksum));
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+	EvalBenchOptions options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	std::vector<Position> positions;
+	CollectPositions(options, positions);
+
+	std::vector<std::unique_ptr<PositionBatch>> batches;
+	for (const Position& position : positions)
+	{
+		if (batches.empty() || batches.back()->IsFull())
+			batches.emplace_back(new PositionBatch());
+
+		batches.back()->Add(position);
+	}
+
+	// The scalar evaluation is the reference every kernel must match.
+	std::vector<int> expectedScores(positions.size());
+	for (size_t i = 0; i < positions.size(); ++i)
+	{
+		expectedScores[i] = Evaluation::Evaluate(positions[i]);
+	}
+
+	std::printf("%d positions, %d passes\n", static_cast<int>(positions.size()), options.m_passCount);
+	uint64_t evaluationCount = static_cast<uint64_t>(positions.size()) * options.m_passCount;
+
+	auto startTime = std::chrono::steady_clock::now();
+	int64_t checksum = 0;
+	for (int pass = 0; pass < options.m_passCount; ++pass)
+	{
+		for (const Position& position : positions)
+		{
+			checksum += Evaluation::Evaluate(position);
+		}
+	}
+
+	double scalarSeconds = GetSecondsSince(startTime);
+	double scalarRate = scalarSeconds > 0.0 ? evaluationCount / scalarSeconds : 0.0;
+	PrintRate("single", evaluationCount, scalarSeconds, 0.0, checksum);
+
+	int scores[s_evaluationBatchSize];
+	bool isEveryKernelExact = true;
+	for (int kernel = 0; kernel < KERNEL_COUNT; ++kernel)
+	{
+		EvaluationKernel evaluationKernel = static_cast<EvaluationKernel>(kernel);
+		const char* name = Evaluation::GetKernelName(evaluationKernel);
+		if (!Evaluation::IsKernelSupported(evaluationKernel))
+		{
+			std::printf("%-8s not supported\n", name);
+			continue;
+		}
+
+		size_t mismatchCount = 0;
+		for (size_t i = 0; i < batches.size(); ++i)
+		{
+			Evaluation::EvaluateBatch(*batches[i], evaluationKernel, scores);
+			for (int j = 0; j < batches[i]->GetSize(); ++j)
+			{
+				if (scores[j] != expectedScores[i * s_evaluationBatchSize + j])
+					++mismatchCount;
+			}
+		}
+
+		if (mismatchCount != 0)
+		{
+			std::printf("%-8s %llu positions scored differently from the scalar evaluation\n", name,
+				static_cast<unsigned long long>(mismatchCount));
+			isEveryKernelExact = false;
+			continue;
+		}
+
+		startTime = std::chrono::steady_clock::now();
+		checksum = 0;
+		for (int pass = 0; pass < options.m_passCount; ++pass)
+		{
+			for (const std::unique_ptr<PositionBatch>& batch : batches)
+			{
+				Evaluation::EvaluateBatch(*batch, evaluationKernel, scores);
+				for (int j = 0; j < batch->GetSize(); ++j)
+				{
+					checksum += scores[j];
+				}
+			}
+		}
+
+		PrintRate(name, evaluationCount, GetSecondsSince(startTime), scalarRate, checksum);
+	}
+
+	return isEveryKernelExact ? 0 : 1;
+}
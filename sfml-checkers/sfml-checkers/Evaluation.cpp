@@ -0,0 +1,155 @@
+//---------------------------------------------------------------
+//
+// Evaluation.cpp
+//
+
+#include "Evaluation.h"
+#include "EvaluationTerms.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace {
+
+//==============================================================================
+
+// One position at a time, in plain integer arithmetic.
+struct ScalarLanes
+{
+	typedef uint32_t Vector;
+
+	static const int s_width = 1;
+
+	static Vector Load(const uint32_t* values) { return *values; }
+	static void Store(int32_t* values, Vector vector) { *values = static_cast<int32_t>(vector); }
+	static Vector Set(uint32_t value) { return value; }
+
+	static Vector And(Vector left, Vector right) { return left & right; }
+	static Vector AndNot(Vector left, Vector right) { return left & ~right; }
+	static Vector Or(Vector left, Vector right) { return left | right; }
+	static Vector Add(Vector left, Vector right) { return left + right; }
+	static Vector Sub(Vector left, Vector right) { return left - right; }
+	static Vector Multiply(Vector vector, int factor) { return vector * static_cast<uint32_t>(factor); }
+
+	template <int Amount>
+	static Vector Shift(Vector vector)
+	{
+		if constexpr (Amount > 0)
+			return vector << Amount;
+		else
+			return vector >> -Amount;
+	}
+
+	static Vector PopCount(Vector vector) { return static_cast<Vector>(GetSquareCount(vector)); }
+
+	static Vector NegateUnless(Vector vector, Vector flag) { return flag ? vector : 0u - vector; }
+};
+
+bool IsProcessorSupporting(EvaluationKernel kernel)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	int registers[4];
+	__cpuid(registers, 1);
+	bool hasSse41 = (registers[2] & (1 << 19)) != 0;
+
+	// AVX2 also needs the operating system to save the wide registers.
+	bool hasAvxState = (registers[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+	__cpuidex(registers, 7, 0);
+	bool hasAvx2 = hasAvxState && (registers[1] & (1 << 5)) != 0;
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+	bool hasSse41 = __builtin_cpu_supports("sse4.1");
+	bool hasAvx2 = __builtin_cpu_supports("avx2");
+#else
+	bool hasSse41 = false;
+	bool hasAvx2 = false;
+#endif
+
+	switch (kernel)
+	{
+	case KERNEL_SCALAR:
+		return true;
+	case KERNEL_SSE41:
+		return hasSse41;
+	case KERNEL_AVX2:
+		return hasAvx2;
+	default:
+		return false;
+	}
+}
+
+// The fastest supported kernel, found once.
+EvaluationKernel GetBestKernel()
+{
+	static const EvaluationKernel s_bestKernel = []()
+	{
+		if (Evaluation::IsKernelSupported(KERNEL_AVX2))
+			return KERNEL_AVX2;
+		if (Evaluation::IsKernelSupported(KERNEL_SSE41))
+			return KERNEL_SSE41;
+		return KERNEL_SCALAR;
+	}();
+
+	return s_bestKernel;
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+int Evaluation::Evaluate(const Position& position)
+{
+	return static_cast<int32_t>(EvaluateLanes<ScalarLanes>(position.m_whitePieces, position.m_blackPieces,
+		position.m_kings, position.m_isWhitePlayerTurn ? 1 : 0));
+}
+
+void Evaluation::EvaluateBatch(const PositionBatch& batch, int* scoresOut)
+{
+	EvaluateBatch(batch, GetBestKernel(), scoresOut);
+}
+
+void Evaluation::EvaluateBatch(const PositionBatch& batch, EvaluationKernel kernel, int* scoresOut)
+{
+	int scoredCount = 0;
+	if (kernel == KERNEL_AVX2)
+	{
+		scoredCount = EvaluationKernels::EvaluateBatchAvx2(batch.m_whitePieces, batch.m_blackPieces, batch.m_kings,
+			batch.m_isWhitePlayerTurn, batch.m_size, scoresOut);
+	}
+	else if (kernel == KERNEL_SSE41)
+	{
+		scoredCount = EvaluationKernels::EvaluateBatchSse41(batch.m_whitePieces, batch.m_blackPieces, batch.m_kings,
+			batch.m_isWhitePlayerTurn, batch.m_size, scoresOut);
+	}
+
+	// Whatever is left over past the last full group of lanes.
+	EvaluateBatchLanes<ScalarLanes>(batch.m_whitePieces + scoredCount, batch.m_blackPieces + scoredCount,
+		batch.m_kings + scoredCount, batch.m_isWhitePlayerTurn + scoredCount, batch.m_size - scoredCount,
+		scoresOut + scoredCount);
+}
+
+bool Evaluation::IsKernelSupported(EvaluationKernel kernel)
+{
+	if (kernel == KERNEL_SSE41 && !EvaluationKernels::HasSse41())
+		return false;
+	if (kernel == KERNEL_AVX2 && !EvaluationKernels::HasAvx2())
+		return false;
+
+	return IsProcessorSupporting(kernel);
+}
+
+const char* Evaluation::GetKernelName(EvaluationKernel kernel)
+{
+	switch (kernel)
+	{
+	case KERNEL_SCALAR:
+		return "scalar";
+	case KERNEL_SSE41:
+		return "sse4.1";
+	case KERNEL_AVX2:
+		return "avx2";
+	default:
+		return "unknown";
+	}
+}
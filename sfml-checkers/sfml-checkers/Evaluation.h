@@ -0,0 +1,84 @@
+//---------------------------------------------------------------
+//
+// Evaluation.h
+//
+
+#pragma once
+
+#include "Position.h"
+
+#include <cstdint>
+
+namespace {
+	// Positions a batch holds, a multiple of the widest kernel's lanes.
+	const int s_evaluationBatchSize = 256;
+}
+
+// Positions laid out as one array per bitboard, so a kernel loads the same bitboard of several
+// positions with one instruction. Fixed capacity, it never allocates. Positions of a game are added
+// from Game::GetPosition.
+struct PositionBatch
+{
+	PositionBatch()
+		: m_size(0)
+	{
+	}
+
+	void Add(const Position& position)
+	{
+		m_whitePieces[m_size] = position.m_whitePieces;
+		m_blackPieces[m_size] = position.m_blackPieces;
+		m_kings[m_size] = position.m_kings;
+		m_isWhitePlayerTurn[m_size] = position.m_isWhitePlayerTurn ? 1 : 0;
+		++m_size;
+	}
+
+	void Clear() { m_size = 0; }
+
+	int GetSize() const { return m_size; }
+	bool IsFull() const { return m_size == s_evaluationBatchSize; }
+
+	alignas(32) Bitboard m_whitePieces[s_evaluationBatchSize];
+	alignas(32) Bitboard m_blackPieces[s_evaluationBatchSize];
+	alignas(32) Bitboard m_kings[s_evaluationBatchSize];
+	alignas(32) uint32_t m_isWhitePlayerTurn[s_evaluationBatchSize];
+
+	int m_size;
+};
+
+// Ways to evaluate a batch. Every kernel gives exactly the scores of Evaluation::Evaluate.
+enum EvaluationKernel
+{
+	KERNEL_SCALAR,
+
+	// Four positions at a time.
+	KERNEL_SSE41,
+
+	// Eight positions at a time.
+	KERNEL_AVX2,
+
+	KERNEL_COUNT,
+};
+
+namespace Evaluation {
+
+//==============================================================================
+
+// Static score of the position from the point of view of the side to move: material, kings, the
+// advancement of the men, men guarding the back rank, mobility and the center squares.
+int Evaluate(const Position& position);
+
+// Scores every position of the batch with the fastest kernel the processor supports.
+void EvaluateBatch(const PositionBatch& batch, int* scoresOut);
+
+// Scores every position of the batch with the kernel, which must be supported.
+void EvaluateBatch(const PositionBatch& batch, EvaluationKernel kernel, int* scoresOut);
+
+// Whether this build and the processor it runs on support the kernel.
+bool IsKernelSupported(EvaluationKernel kernel);
+
+const char* GetKernelName(EvaluationKernel kernel);
+
+//==============================================================================
+
+} // namespace Evaluation
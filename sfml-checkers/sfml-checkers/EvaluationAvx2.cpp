@@ -0,0 +1,100 @@
+//---------------------------------------------------------------
+//
+// EvaluationAvx2.cpp
+//
+// The evaluation eight positions at a time. Built with AVX2 enabled, only called once the processor
+// is known to have it.
+//
+
+#include "EvaluationTerms.h"
+
+#if defined(__AVX2__)
+#define CHECKERS_HAS_AVX2_KERNEL
+#include <immintrin.h>
+#endif
+
+#if defined(CHECKERS_HAS_AVX2_KERNEL)
+
+namespace {
+
+//==============================================================================
+
+struct Avx2Lanes
+{
+	typedef __m256i Vector;
+
+	static const int s_width = 8;
+
+	static Vector Load(const uint32_t* values) { return _mm256_load_si256(reinterpret_cast<const __m256i*>(values)); }
+	static void Store(int32_t* values, Vector vector) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(values), vector); }
+	static Vector Set(uint32_t value) { return _mm256_set1_epi32(static_cast<int>(value)); }
+
+	static Vector And(Vector left, Vector right) { return _mm256_and_si256(left, right); }
+	static Vector AndNot(Vector left, Vector right) { return _mm256_andnot_si256(right, left); }
+	static Vector Or(Vector left, Vector right) { return _mm256_or_si256(left, right); }
+	static Vector Add(Vector left, Vector right) { return _mm256_add_epi32(left, right); }
+	static Vector Sub(Vector left, Vector right) { return _mm256_sub_epi32(left, right); }
+	static Vector Multiply(Vector vector, int factor) { return _mm256_mullo_epi32(vector, _mm256_set1_epi32(factor)); }
+
+	template <int Amount>
+	static Vector Shift(Vector vector)
+	{
+		if constexpr (Amount > 0)
+			return _mm256_slli_epi32(vector, Amount);
+		else
+			return _mm256_srli_epi32(vector, -Amount);
+	}
+
+	// Bits of every nibble looked up in a table, then the byte counts of each lane added up. The
+	// lookup works within each 128 bit half, so the table is in both.
+	static Vector PopCount(Vector vector)
+	{
+		const __m256i nibbleCounts = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+			0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+		const __m256i lowNibbles = _mm256_set1_epi8(0x0F);
+
+		__m256i low = _mm256_shuffle_epi8(nibbleCounts, _mm256_and_si256(vector, lowNibbles));
+		__m256i high = _mm256_shuffle_epi8(nibbleCounts, _mm256_and_si256(_mm256_srli_epi16(vector, 4), lowNibbles));
+		__m256i byteCounts = _mm256_add_epi8(low, high);
+
+		__m256i pairCounts = _mm256_maddubs_epi16(byteCounts, _mm256_set1_epi8(1));
+		return _mm256_madd_epi16(pairCounts, _mm256_set1_epi16(1));
+	}
+
+	// Lanes whose flag is zero are negated: flipping the bits and subtracting the all ones mask.
+	static Vector NegateUnless(Vector vector, Vector flags)
+	{
+		__m256i mask = _mm256_cmpeq_epi32(flags, _mm256_setzero_si256());
+		return _mm256_sub_epi32(_mm256_xor_si256(vector, mask), mask);
+	}
+};
+
+//==============================================================================
+
+} // anonymous namespace
+
+int EvaluationKernels::EvaluateBatchAvx2(const uint32_t* whitePieces, const uint32_t* blackPieces,
+	const uint32_t* kings, const uint32_t* isWhitePlayerTurn, int count, int32_t* scoresOut)
+{
+	return EvaluateBatchLanes<Avx2Lanes>(whitePieces, blackPieces, kings, isWhitePlayerTurn, count, scoresOut);
+}
+
+bool EvaluationKernels::HasAvx2()
+{
+	return true;
+}
+
+#else
+
+int EvaluationKernels::EvaluateBatchAvx2(const uint32_t*, const uint32_t*, const uint32_t*, const uint32_t*, int,
+	int32_t*)
+{
+	return 0;
+}
+
+bool EvaluationKernels::HasAvx2()
+{
+	return false;
+}
+
+#endif
@@ -0,0 +1,98 @@
+//---------------------------------------------------------------
+//
+// EvaluationSse41.cpp
+//
+// The evaluation four positions at a time. Built with SSE4.1 enabled, only called once the
+// processor is known to have it.
+//
+
+#include "EvaluationTerms.h"
+
+#if defined(__SSE4_1__) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+#define CHECKERS_HAS_SSE41_KERNEL
+#include <immintrin.h>
+#endif
+
+#if defined(CHECKERS_HAS_SSE41_KERNEL)
+
+namespace {
+
+//==============================================================================
+
+struct Sse41Lanes
+{
+	typedef __m128i Vector;
+
+	static const int s_width = 4;
+
+	static Vector Load(const uint32_t* values) { return _mm_load_si128(reinterpret_cast<const __m128i*>(values)); }
+	static void Store(int32_t* values, Vector vector) { _mm_storeu_si128(reinterpret_cast<__m128i*>(values), vector); }
+	static Vector Set(uint32_t value) { return _mm_set1_epi32(static_cast<int>(value)); }
+
+	static Vector And(Vector left, Vector right) { return _mm_and_si128(left, right); }
+	static Vector AndNot(Vector left, Vector right) { return _mm_andnot_si128(right, left); }
+	static Vector Or(Vector left, Vector right) { return _mm_or_si128(left, right); }
+	static Vector Add(Vector left, Vector right) { return _mm_add_epi32(left, right); }
+	static Vector Sub(Vector left, Vector right) { return _mm_sub_epi32(left, right); }
+	static Vector Multiply(Vector vector, int factor) { return _mm_mullo_epi32(vector, _mm_set1_epi32(factor)); }
+
+	template <int Amount>
+	static Vector Shift(Vector vector)
+	{
+		if constexpr (Amount > 0)
+			return _mm_slli_epi32(vector, Amount);
+		else
+			return _mm_srli_epi32(vector, -Amount);
+	}
+
+	// Bits of every nibble looked up in a table, then the byte counts of each lane added up.
+	static Vector PopCount(Vector vector)
+	{
+		const __m128i nibbleCounts = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+		const __m128i lowNibbles = _mm_set1_epi8(0x0F);
+
+		__m128i low = _mm_shuffle_epi8(nibbleCounts, _mm_and_si128(vector, lowNibbles));
+		__m128i high = _mm_shuffle_epi8(nibbleCounts, _mm_and_si128(_mm_srli_epi16(vector, 4), lowNibbles));
+		__m128i byteCounts = _mm_add_epi8(low, high);
+
+		__m128i pairCounts = _mm_maddubs_epi16(byteCounts, _mm_set1_epi8(1));
+		return _mm_madd_epi16(pairCounts, _mm_set1_epi16(1));
+	}
+
+	// Lanes whose flag is zero are negated: flipping the bits and subtracting the all ones mask.
+	static Vector NegateUnless(Vector vector, Vector flags)
+	{
+		__m128i mask = _mm_cmpeq_epi32(flags, _mm_setzero_si128());
+		return _mm_sub_epi32(_mm_xor_si128(vector, mask), mask);
+	}
+};
+
+//==============================================================================
+
+} // anonymous namespace
+
+int EvaluationKernels::EvaluateBatchSse41(const uint32_t* whitePieces, const uint32_t* blackPieces,
+	const uint32_t* kings, const uint32_t* isWhitePlayerTurn, int count, int32_t* scoresOut)
+{
+	return EvaluateBatchLanes<Sse41Lanes>(whitePieces, blackPieces, kings, isWhitePlayerTurn, count, scoresOut);
+}
+
+bool EvaluationKernels::HasSse41()
+{
+	return true;
+}
+
+#else
+
+int EvaluationKernels::EvaluateBatchSse41(const uint32_t*, const uint32_t*, const uint32_t*, const uint32_t*, int,
+	int32_t*)
+{
+	return 0;
+}
+
+bool EvaluationKernels::HasSse41()
+{
+	return false;
+}
+
+#endif
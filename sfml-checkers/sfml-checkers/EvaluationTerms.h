@@ -0,0 +1,158 @@
+//---------------------------------------------------------------
+//
+// EvaluationTerms.h
+//
+// The evaluation written once over a lane type, so the scalar code and every SIMD kernel add up the
+// same terms in the same integer arithmetic and score alike. A lane type supplies a vector of 32
+// bit lanes and the handful of operations on it the terms use.
+//
+// The kernels include this into translation units built for their own instruction sets. Everything
+// here has internal linkage and nothing else of the engine is included, so no inline function
+// compiled for one instruction set can be picked by the linker for another.
+//
+
+#pragma once
+
+#include <cstdint>
+
+namespace {
+
+//==============================================================================
+
+const int s_manValue = 100;
+const int s_kingValue = 140;
+const int s_advancementValue = 3;
+const int s_backRankValue = 12;
+const int s_centerValue = 6;
+const int s_mobilityValue = 2;
+
+// Crowning rows, the back ranks of the other side.
+const uint32_t s_topRowSquares = 0x0000000F;
+const uint32_t s_bottomRowSquares = 0xF0000000;
+
+// The middle two squares of the four middle rows.
+const uint32_t s_centerSquares = 0x00666600;
+
+// Rows whose number has bit 0, 1 or 2 set. Counting a man once per set bit of its row weighs it by
+// its row, without a loop over the rows.
+const uint32_t s_rowBit0Squares = 0xF0F0F0F0;
+const uint32_t s_rowBit1Squares = 0xFF00FF00;
+const uint32_t s_rowBit2Squares = 0xFFFF0000;
+
+// Squares on rows 0, 2, 4, 6 and on rows 1, 3, 5, 7, and the first and last square of every row.
+const uint32_t s_evenRowSquares = 0x0F0F0F0F;
+const uint32_t s_oddRowSquares = 0xF0F0F0F0;
+const uint32_t s_leftEdgeSquares = 0x11111111;
+const uint32_t s_rightEdgeSquares = 0x88888888;
+
+// Moves squares one step diagonally, as MoveGenerator does: a shift whose size depends on the parity
+// of the row, with the squares that would leave the board sideways masked out first.
+template <class Lanes, int VerticalDirection, int HorizontalDirection>
+typename Lanes::Vector StepLanes(typename Lanes::Vector squares)
+{
+	const int evenRowShift = VerticalDirection * 4 + (HorizontalDirection > 0 ? 1 : 0);
+	const int oddRowShift = VerticalDirection * 4 - (HorizontalDirection < 0 ? 1 : 0);
+	const uint32_t evenRowSources = HorizontalDirection > 0 ? s_evenRowSquares & ~s_rightEdgeSquares : s_evenRowSquares;
+	const uint32_t oddRowSources = HorizontalDirection < 0 ? s_oddRowSquares & ~s_leftEdgeSquares : s_oddRowSquares;
+
+	return Lanes::Or(Lanes::template Shift<evenRowShift>(Lanes::And(squares, Lanes::Set(evenRowSources))),
+		Lanes::template Shift<oddRowShift>(Lanes::And(squares, Lanes::Set(oddRowSources))));
+}
+
+// Number of single steps the pieces can make to empty squares. Men step only forward, white south
+// and black north, kings every way.
+template <class Lanes, int ForwardDirection>
+typename Lanes::Vector CountStepsLanes(typename Lanes::Vector men, typename Lanes::Vector kings,
+	typename Lanes::Vector empty)
+{
+	typename Lanes::Vector pieces = Lanes::Or(men, kings);
+	typename Lanes::Vector steps = Lanes::Add(
+		Lanes::PopCount(Lanes::And(StepLanes<Lanes, ForwardDirection, 1>(pieces), empty)),
+		Lanes::PopCount(Lanes::And(StepLanes<Lanes, ForwardDirection, -1>(pieces), empty)));
+
+	return Lanes::Add(steps, Lanes::Add(
+		Lanes::PopCount(Lanes::And(StepLanes<Lanes, -ForwardDirection, 1>(kings), empty)),
+		Lanes::PopCount(Lanes::And(StepLanes<Lanes, -ForwardDirection, -1>(kings), empty))));
+}
+
+// Score from the point of view of the side to move. isWhitePlayerTurn is 1 or 0 in each lane.
+template <class Lanes>
+typename Lanes::Vector EvaluateLanes(typename Lanes::Vector whitePieces, typename Lanes::Vector blackPieces,
+	typename Lanes::Vector kings, typename Lanes::Vector isWhitePlayerTurn)
+{
+	typedef typename Lanes::Vector Vector;
+
+	Vector whiteMen = Lanes::AndNot(whitePieces, kings);
+	Vector blackMen = Lanes::AndNot(blackPieces, kings);
+	Vector whiteKings = Lanes::And(whitePieces, kings);
+	Vector blackKings = Lanes::And(blackPieces, kings);
+	Vector empty = Lanes::AndNot(Lanes::Set(0xFFFFFFFF), Lanes::Or(whitePieces, blackPieces));
+
+	Vector score = Lanes::Add(
+		Lanes::Multiply(Lanes::Sub(Lanes::PopCount(whiteMen), Lanes::PopCount(blackMen)), s_manValue),
+		Lanes::Multiply(Lanes::Sub(Lanes::PopCount(whiteKings), Lanes::PopCount(blackKings)), s_kingValue));
+
+	// Men are worth more the closer they get to crowning. White advances down the board, so a white
+	// man counts its row and a black man seven minus its row, the bits its row does not have.
+	Vector whiteRows = Lanes::Add(Lanes::PopCount(Lanes::And(whiteMen, Lanes::Set(s_rowBit0Squares))),
+		Lanes::Add(Lanes::Multiply(Lanes::PopCount(Lanes::And(whiteMen, Lanes::Set(s_rowBit1Squares))), 2),
+			Lanes::Multiply(Lanes::PopCount(Lanes::And(whiteMen, Lanes::Set(s_rowBit2Squares))), 4)));
+	Vector blackRows = Lanes::Add(Lanes::PopCount(Lanes::AndNot(blackMen, Lanes::Set(s_rowBit0Squares))),
+		Lanes::Add(Lanes::Multiply(Lanes::PopCount(Lanes::AndNot(blackMen, Lanes::Set(s_rowBit1Squares))), 2),
+			Lanes::Multiply(Lanes::PopCount(Lanes::AndNot(blackMen, Lanes::Set(s_rowBit2Squares))), 4)));
+	score = Lanes::Add(score, Lanes::Multiply(Lanes::Sub(whiteRows, blackRows), s_advancementValue));
+
+	// Men left on the back rank keep the opponent from crowning.
+	score = Lanes::Add(score, Lanes::Multiply(Lanes::Sub(
+		Lanes::PopCount(Lanes::And(whiteMen, Lanes::Set(s_topRowSquares))),
+		Lanes::PopCount(Lanes::And(blackMen, Lanes::Set(s_bottomRowSquares)))), s_backRankValue));
+
+	score = Lanes::Add(score, Lanes::Multiply(Lanes::Sub(
+		Lanes::PopCount(Lanes::And(whitePieces, Lanes::Set(s_centerSquares))),
+		Lanes::PopCount(Lanes::And(blackPieces, Lanes::Set(s_centerSquares)))), s_centerValue));
+
+	score = Lanes::Add(score, Lanes::Multiply(Lanes::Sub(CountStepsLanes<Lanes, 1>(whiteMen, whiteKings, empty),
+		CountStepsLanes<Lanes, -1>(blackMen, blackKings, empty)), s_mobilityValue));
+
+	return Lanes::NegateUnless(score, isWhitePlayerTurn);
+}
+
+// Scores the positions in groups of the lane width and returns how many it scored. What is left
+// over is for the caller to score.
+template <class Lanes>
+int EvaluateBatchLanes(const uint32_t* whitePieces, const uint32_t* blackPieces, const uint32_t* kings,
+	const uint32_t* isWhitePlayerTurn, int count, int32_t* scoresOut)
+{
+	int i = 0;
+	for (; i + Lanes::s_width <= count; i += Lanes::s_width)
+	{
+		Lanes::Store(scoresOut + i, EvaluateLanes<Lanes>(Lanes::Load(whitePieces + i), Lanes::Load(blackPieces + i),
+			Lanes::Load(kings + i), Lanes::Load(isWhitePlayerTurn + i)));
+	}
+
+	return i;
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+namespace EvaluationKernels {
+
+//==============================================================================
+
+// The SIMD kernels, each in a translation unit of its own. They return how many positions they
+// scored, zero if the build has no such kernel.
+int EvaluateBatchSse41(const uint32_t* whitePieces, const uint32_t* blackPieces, const uint32_t* kings,
+	const uint32_t* isWhitePlayerTurn, int count, int32_t* scoresOut);
+
+int EvaluateBatchAvx2(const uint32_t* whitePieces, const uint32_t* blackPieces, const uint32_t* kings,
+	const uint32_t* isWhitePlayerTurn, int count, int32_t* scoresOut);
+
+// Whether the kernel was built in.
+bool HasSse41();
+bool HasAvx2();
+
+//==============================================================================
+
+} // namespace EvaluationKernels
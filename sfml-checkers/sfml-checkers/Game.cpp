@@ -4,31 +4,28 @@
 //
 
 #include "Game.h"
+#include "GameRecord.h"
 #include "Log.h"
+#include "MoveGenerator.h"
+#include "Zobrist.h"
 
 #include <assert.h>
 #include <algorithm>
+#include <cmath>
 
 namespace {
-	// White player will move South
-	const int s_south = 1;
-
-	// Black player moves North.
-	const int s_north= -1;
-
-	// These are the same for both Black and White players.
-	const int s_west = -1;
-	const int s_east = 1;
-
 	const int s_moveLength = 1;
-	const int s_jumpLength = 2;
+
+	// Hops the history has room for before it needs to grow.
+	const size_t s_historyCapacity = 512;
 }
 
 Game::Game()
-	: m_boardData(s_boardSize, std::vector<PieceDisplayType>(s_boardSize, EMPTY))
+	: m_hashKey(0)
 	, m_pendingMoveLauncher(new CheckersMoveLauncher(std::bind(&Game::OnLaunchMove, this)))
-	, m_isWhitePlayerTurn(true)
+	, m_recordWriter(nullptr)
 {
+	m_history.reserve(s_historyCapacity);
 	Setup();
 }
 
@@ -52,7 +49,7 @@ void Game::OnMoveSelectionEvent(const BoardIndex& boardIndex)
 	// Move source must contain a piece.
 	if (!m_pendingMoveLauncher->IsSourceSet() && !ContainsPiece(boardIndex))
 	{
-		LOG_DEBUG_CONSOLE("Error: Move source does not contain a piece: "
+		LOG_ERROR(Logger::CATEGORY_GAME, "Move source does not contain a piece: "
 			+ BoardIndexToString(boardIndex));
 		return;
 	}
@@ -60,14 +57,141 @@ void Game::OnMoveSelectionEvent(const BoardIndex& boardIndex)
 	m_pendingMoveLauncher->HandleMoveSelected(boardIndex);
 }
 
+bool Game::PlayMove(const PackedMove& turn)
+{
+	if (!m_history.empty() && !m_history.back().m_isTurnEnd)
+	{
+		LOG_ERROR(Logger::CATEGORY_GAME, "Cannot play a turn in the middle of a capture chain.");
+		return false;
+	}
+
+	MoveList legalTurns;
+	MoveGenerator::GenerateTurns(m_position, legalTurns);
+	if (std::find(legalTurns.begin(), legalTurns.end(), turn) == legalTurns.end())
+	{
+		LOG_ERROR(Logger::CATEGORY_GAME, "Illegal turn attempt.");
+		return false;
+	}
+
+	HistoryEntry entry;
+	entry.m_hashKey = m_hashKey;
+	entry.m_isTurnEnd = false;
+
+	// The side key is flipped back by SwitchTurns.
+	m_hashKey = Zobrist::GetKeyAfterTurn(m_position, m_hashKey, turn) ^ Zobrist::GetSideKey();
+
+	m_position.MakeMove(turn.GetSource(), turn.GetDestination(), turn.GetCapturedPieces(), entry.m_undo, false);
+	m_history.push_back(entry);
+
+	// A half selected move belongs to the turn that is over.
+	m_pendingMoveLauncher.reset(new CheckersMoveLauncher(std::bind(&Game::OnLaunchMove, this)));
+
+	SwitchTurns();
+	NotifyBoardChanged();
+	return true;
+}
+
+bool Game::PlayHop(int source, int destination)
+{
+	size_t historySize = m_history.size();
+
+	m_pendingMoveLauncher.reset(new CheckersMoveLauncher(std::bind(&Game::OnLaunchMove, this)));
+	OnMoveSelectionEvent(BoardIndexFromSquare(source));
+	OnMoveSelectionEvent(BoardIndexFromSquare(destination));
+
+	return m_history.size() != historySize;
+}
+
+bool Game::TakeBack()
+{
+	if (m_history.empty())
+		return false;
+
+	// Hops are taken back until the previous turn's last move, or the start of the game.
+	do
+	{
+		const HistoryEntry& entry = m_history.back();
+		if (entry.m_isTurnEnd)
+		{
+			m_position.m_isWhitePlayerTurn = !m_position.m_isWhitePlayerTurn;
+			if (m_recordWriter)
+				m_recordWriter->RemoveLastTurn();
+		}
+
+		m_position.UnmakeMove(entry.m_undo);
+		m_hashKey = entry.m_hashKey;
+		m_history.pop_back();
+	} while (!m_history.empty() && !m_history.back().m_isTurnEnd);
+
+	assert(m_hashKey == Zobrist::ComputeKey(m_position));
+	LOG_INFO(Logger::CATEGORY_GAME, "Took back a turn.");
+
+	// A half selected move belongs to the turn that is gone.
+	m_pendingMoveLauncher.reset(new CheckersMoveLauncher(std::bind(&Game::OnLaunchMove, this)));
+
+	PopulateLegalTurnMoves();
+	NotifyBoardChanged();
+	return true;
+}
+
+void Game::SetPosition(const Position& position)
+{
+	m_position = position;
+	m_startPosition = position;
+	m_hashKey = Zobrist::ComputeKey(m_position);
+	m_history.clear();
+
+	// Records always start from the start position, other games are not recorded.
+	if (m_recordWriter)
+		m_recordWriter->BeginGame();
+
+	m_pendingMoveLauncher.reset(new CheckersMoveLauncher(std::bind(&Game::OnLaunchMove, this)));
+
+	PopulateLegalTurnMoves();
+	NotifyBoardChanged();
+}
+
+void Game::GetTurns(std::vector<PackedMove>& turnsOut) const
+{
+	int source = -1;
+	Bitboard capturedPieces = 0;
+	for (const HistoryEntry& entry : m_history)
+	{
+		if (source < 0)
+			source = entry.m_undo.m_source;
+		capturedPieces |= entry.m_undo.m_capturedPieces;
+
+		if (entry.m_isTurnEnd)
+		{
+			turnsOut.push_back(PackedMove(source, entry.m_undo.m_destination, capturedPieces));
+			source = -1;
+			capturedPieces = 0;
+		}
+	}
+}
+
+void Game::SetBoardChangedCallback(std::function<void()> boardChangedCallback)
+{
+	m_boardChangedCallback = boardChangedCallback;
+}
+
+void Game::SetRecordWriter(GameRecordWriter* recordWriter)
+{
+	m_recordWriter = recordWriter;
+
+	// Turns recorded before belong to another game.
+	if (m_recordWriter)
+		m_recordWriter->BeginGame();
+}
+
 void Game::OnLaunchMove()
 {
 	const CheckersMove& move(m_pendingMoveLauncher->GetCheckersMove());
 
-	LOG_DEBUG_CONSOLE("Info: Attempting to move " + BoardIndexToString(move.m_moveSource) + " to "
+	LOG_INFO(Logger::CATEGORY_GAME, "Attempting to move " + BoardIndexToString(move.m_moveSource) + " to "
 		+ BoardIndexToString(move.m_moveDestination));
 
-	bool isJumpAvailable = !m_legalJumpDestinations.empty();
+	bool isJumpAvailable = !m_legalJumps.IsEmpty();
 
 	if (IsLegalJump(move))
 	{
@@ -81,7 +205,7 @@ void Game::OnLaunchMove()
 	}
 	else
 	{
-		LOG_DEBUG_CONSOLE("Info: Illegal move attempt. ");
+		LOG_INFO(Logger::CATEGORY_GAME, "Illegal move attempt. ");
 	}
 
 	// This move is complete, reset it!
@@ -90,24 +214,7 @@ void Game::OnLaunchMove()
 
 void Game::Setup()
 {
-	for (int row = 0; row < s_boardSize; ++row)
-	{
-		for (int col = 0; col < s_boardSize; ++col)
-		{
-			// Find the correct diagonal.
-			if ((row + col) % 2)
-			{
-				if (row > 4)
-					m_boardData[row][col] = BLACK;
-				else if (row < 3)
-					m_boardData[row][col] = WHITE;
-				else
-					m_boardData[row][col] = EMPTY;
-			}
-		}
-	}
-
-	PopulateLegalTurnMoves();
+	SetPosition(Position::CreateStartPosition());
 }
 
 void Game::MovePiece(const CheckersMove& currentMove)
@@ -115,13 +222,19 @@ void Game::MovePiece(const CheckersMove& currentMove)
 	const BoardIndex& source = currentMove.m_moveSource;
 	const BoardIndex& destination(currentMove.m_moveDestination);
 
-	// Move the source piece to the destination.
-	m_boardData[destination.first][destination.second] = GetPieceForMove(currentMove);
+	HistoryEntry entry;
+	entry.m_hashKey = m_hashKey;
+	entry.m_isTurnEnd = false;
 
-	// Clear previous spot.
-	m_boardData[source.first][source.second] = EMPTY;
+	PieceDisplayType movedPiece = GetPieceForMove(currentMove);
+	UpdateHashKeyForMove(source, destination, movedPiece);
+
+	// Move the source piece to the destination.
+	m_position.MakeMove(SquareFromBoardIndex(source), SquareFromBoardIndex(destination), 0, entry.m_undo, false);
+	m_history.push_back(entry);
 
 	SwitchTurns();
+	NotifyBoardChanged();
 }
 
 void Game::JumpPiece(const CheckersMove& currentMove)
@@ -137,53 +250,119 @@ void Game::JumpPiece(const CheckersMove& currentMove)
 	// Piece in between source and destination.
 	BoardIndex middleOfJumpIndex = GetTranslatedMove(source, direction.m_y, direction.m_x);
 
-	// Move the source piece to the destination.
-	m_boardData[destination.first][destination.second] = GetPieceForMove(currentMove);
+	HistoryEntry entry;
+	entry.m_hashKey = m_hashKey;
+	entry.m_isTurnEnd = false;
 
-	// Clear source spot.
-	m_boardData[source.first][source.second] = EMPTY;
+	PieceDisplayType movedPiece = GetPieceForMove(currentMove);
+	UpdateHashKeyForMove(source, destination, movedPiece);
+	m_hashKey ^= Zobrist::GetPieceKey(GetPieceForIndex(middleOfJumpIndex), SquareFromBoardIndex(middleOfJumpIndex));
 
-	// Capture the piece between source and destination.
-	m_boardData[middleOfJumpIndex.first][middleOfJumpIndex.second] = EMPTY;
+	// Move the source piece to the destination and capture the piece in between.
+	m_position.MakeMove(SquareFromBoardIndex(source), SquareFromBoardIndex(destination),
+		SquareMask(SquareFromBoardIndex(middleOfJumpIndex)), entry.m_undo, false);
+	m_history.push_back(entry);
 
-	m_legalJumpDestinations.clear();
+	m_legalJumps.Clear();
 
-	AddValidJumpsFromJump(currentMove, direction.m_y, direction.m_x);
+	// Only the piece that just jumped may continue the chain. A man that is crowned ends the turn,
+	// it may not keep jumping as a king.
+	if (!entry.m_undo.m_isCrowned)
+		MoveGenerator::GenerateJumps(m_position, SquareMask(SquareFromBoardIndex(destination)), m_legalJumps);
 
 	// If we have more jumps, we do not switch turns as the player gets to make another jump.
-	if (m_legalJumpDestinations.empty())
+	if (m_legalJumps.IsEmpty())
 	{
 		// If there are no more valid jumps, then the turn is over.
 		SwitchTurns();
 	}
+	else
+	{
+		IndexLegalDestinations();
+	}
+
+	NotifyBoardChanged();
 }
 
 void Game::SwitchTurns()
 {
 	// Toggle players
-	m_isWhitePlayerTurn = !m_isWhitePlayerTurn;
-
-	// Clear our move lists so we can look for new moves next turn.
-	m_legalJumpDestinations.clear();
-	m_legalDestinations.clear();
+	m_position.m_isWhitePlayerTurn = !m_position.m_isWhitePlayerTurn;
+	m_history.back().m_isTurnEnd = true;
+	m_hashKey ^= Zobrist::GetSideKey();
+	assert(m_hashKey == Zobrist::ComputeKey(m_position));
 
 	// Repopulate moves.
 	PopulateLegalTurnMoves();
+
+	if (m_recordWriter && m_startPosition == Position::CreateStartPosition())
+		RecordTurn();
+}
+
+void Game::NotifyBoardChanged()
+{
+	if (m_boardChangedCallback)
+		m_boardChangedCallback();
+}
+
+void Game::RecordTurn()
+{
+	// Take the hops of the turn back on a copy, to get the position it was played from and the turn
+	// as one move.
+	Position turnStart = m_position;
+	turnStart.m_isWhitePlayerTurn = !turnStart.m_isWhitePlayerTurn;
+
+	int destination = m_history.back().m_undo.m_destination;
+	int source = destination;
+	Bitboard capturedPieces = 0;
+	for (size_t i = m_history.size(); i-- > 0;)
+	{
+		if (i + 1 != m_history.size() && m_history[i].m_isTurnEnd)
+			break;
+
+		const UndoRecord& undo = m_history[i].m_undo;
+		turnStart.UnmakeMove(undo);
+		source = undo.m_source;
+		capturedPieces |= undo.m_capturedPieces;
+	}
+
+	int turnIndex = GameRecord::GetTurnIndex(turnStart, PackedMove(source, destination, capturedPieces));
+	if (turnIndex < 0)
+	{
+		LOG_ERROR(Logger::CATEGORY_GAME, "The turn played is not a generated turn, it is not recorded.");
+		return;
+	}
+
+	m_recordWriter->AppendTurn(turnIndex);
+
+	// The side to move without a legal turn has lost.
+	if (m_legalMoves.IsEmpty() && m_legalJumps.IsEmpty())
+		m_recordWriter->EndGame(m_position.m_isWhitePlayerTurn ? RESULT_BLACK_WIN : RESULT_WHITE_WIN);
 }
 
 void Game::PopulateLegalTurnMoves()
 {
-	for (int row = 0; row < s_boardSize; ++row)
+	m_legalMoves.Clear();
+	m_legalJumps.Clear();
+
+	MoveGenerator::GenerateMoves(m_position, m_legalMoves);
+	MoveGenerator::GenerateJumps(m_position, m_position.GetPlayerPieces(), m_legalJumps);
+	IndexLegalDestinations();
+}
+
+void Game::IndexLegalDestinations()
+{
+	std::fill(m_legalDestinations, m_legalDestinations + s_squareCount, 0);
+	std::fill(m_legalJumpDestinations, m_legalJumpDestinations + s_squareCount, 0);
+
+	for (const PackedMove& move : m_legalMoves)
 	{
-		for (int col = 0; col < s_boardSize; ++col)
-		{
-			BoardIndex currentIndex = std::make_pair(row, col);
-			PieceDisplayType currentPiece = m_boardData[row][col];
-			if (ContainsPiece(currentIndex) && IsPieceOfCurrentPlayer(currentPiece))
-			{
-				EvaluatePossibleMovesForIndex(currentIndex);
-			}
-		}
+		m_legalDestinations[move.GetSource()] |= SquareMask(move.GetDestination());
+	}
+
+	for (const PackedMove& jump : m_legalJumps)
+	{
+		m_legalJumpDestinations[jump.GetSource()] |= SquareMask(jump.GetDestination());
 	}
 }
 
@@ -196,7 +375,7 @@ bool Game::IsValidBoardIndex(const BoardIndex& boardIndex) const
 
 	if (!isValid)
 	{
-		LOG_DEBUG_CONSOLE("Warning: attempt to access invalid index " + BoardIndexToString(boardIndex));
+		LOG_WARNING(Logger::CATEGORY_GAME, "Attempt to access invalid index " + BoardIndexToString(boardIndex));
 	}
 
 	return isValid;
@@ -204,22 +383,16 @@ bool Game::IsValidBoardIndex(const BoardIndex& boardIndex) const
 
 bool Game::IsLegalMove(const CheckersMove& move) const
 {
-	return std::any_of(m_legalDestinations.begin(), m_legalDestinations.end(),
-		[&move](const CheckersMove& currentMove)
-	{
-		return move.m_moveSource == currentMove.m_moveSource
-			&& move.m_moveDestination == currentMove.m_moveDestination;
-	});
+	int source = SquareFromBoardIndex(move.m_moveSource);
+	int destination = SquareFromBoardIndex(move.m_moveDestination);
+	return source >= 0 && destination >= 0 && (m_legalDestinations[source] & SquareMask(destination)) != 0;
 }
 
 bool Game::IsLegalJump(const CheckersMove& move) const
 {
-	return std::any_of(m_legalJumpDestinations.begin(), m_legalJumpDestinations.end(),
-		[&move](const CheckersMove& currentMove)
-	{
-		return move.m_moveSource == currentMove.m_moveSource
-			&& move.m_moveDestination == currentMove.m_moveDestination;
-	});
+	int source = SquareFromBoardIndex(move.m_moveSource);
+	int destination = SquareFromBoardIndex(move.m_moveDestination);
+	return source >= 0 && destination >= 0 && (m_legalJumpDestinations[source] & SquareMask(destination)) != 0;
 }
 
 bool Game::IsKingableIndex(const BoardIndex& boardIndex) const
@@ -232,145 +405,27 @@ bool Game::IsKingableIndex(const BoardIndex& boardIndex) const
 bool Game::ContainsPiece(const BoardIndex& boardIndex) const
 {
 	return IsValidBoardIndex(boardIndex)
-		&& m_boardData[boardIndex.first][boardIndex.second] != EMPTY;
+		&& GetPieceForIndex(boardIndex) != EMPTY;
 }
 
 bool Game::ContainsPlayerPiece(const BoardIndex& boardIndex) const
 {
 	return IsValidBoardIndex(boardIndex)
-		&& IsPieceOfCurrentPlayer(m_boardData[boardIndex.first][boardIndex.second]);
+		&& IsPieceOfCurrentPlayer(GetPieceForIndex(boardIndex));
 }
 
 bool Game::ContainsEnemyPiece(const BoardIndex& boardIndex) const
 {
 	return IsValidBoardIndex(boardIndex)
-		&& m_boardData[boardIndex.first][boardIndex.second] != EMPTY
-		&& !IsPieceOfCurrentPlayer(m_boardData[boardIndex.first][boardIndex.second]);
+		&& GetPieceForIndex(boardIndex) != EMPTY
+		&& !IsPieceOfCurrentPlayer(GetPieceForIndex(boardIndex));
 }
 
 bool Game::IsPieceOfCurrentPlayer(PieceDisplayType piece) const
 {
-	return m_isWhitePlayerTurn && (piece == WHITE || piece == WHITE_KING)
-		|| !m_isWhitePlayerTurn && (piece == BLACK || piece == BLACK_KING);
-}
-
-void Game::EvaluatePossibleMovesForIndex(const BoardIndex& boardIndex)
-{
-	LOG_DEBUG_CONSOLE("Info: Evaluating moves for " + BoardIndexToString(boardIndex));
-
-	switch (m_boardData[boardIndex.first][boardIndex.second])
-	{
-	case BLACK:
-		// Look for jumps and move looking North East and North West.
-		AddValidMoveForDirection(boardIndex, s_north, s_west);
-		AddValidMoveForDirection(boardIndex, s_north, s_east);
-		AddValidJumpForDirection(boardIndex, s_north, s_west);
-		AddValidJumpForDirection(boardIndex, s_north, s_east);
-		break;
-	case WHITE:
-		// Look for jumps and move looking South East and South West.
-		AddValidMoveForDirection(boardIndex, s_south, s_west);
-		AddValidJumpForDirection(boardIndex, s_south, s_west);
-		AddValidMoveForDirection(boardIndex, s_south, s_east);
-		AddValidJumpForDirection(boardIndex, s_south, s_east);
-		break;
-	case BLACK_KING:
-	case WHITE_KING:
-		// Look for jumps and moves in all directions.
-		AddValidMoveForDirection(boardIndex, s_north, s_west);
-		AddValidMoveForDirection(boardIndex, s_north, s_east);
-		AddValidMoveForDirection(boardIndex, s_south, s_west);
-		AddValidMoveForDirection(boardIndex, s_south, s_east);
-		AddValidJumpForDirection(boardIndex, s_north, s_west);
-		AddValidJumpForDirection(boardIndex, s_north, s_east);
-		AddValidJumpForDirection(boardIndex, s_south, s_west);
-		AddValidJumpForDirection(boardIndex, s_south, s_east);
-		break;
-	case EMPTY:
-	default:
-		break;
-	}
-}
-
-void Game::AddValidMoveForDirection(const BoardIndex& currentPosition, int verticalDirection,
-	int horizontalDirection)
-{
-	BoardIndex newPosition = std::make_pair(currentPosition.first + verticalDirection,
-		currentPosition.second + horizontalDirection);
-
-	if (!IsValidBoardIndex(newPosition))
-		return;
-
-	// Normal move.
-	if (!ContainsPiece(newPosition))
-	{
-		LOG_DEBUG_CONSOLE("Info: Added Valid Destination: " + BoardIndexToString(newPosition));
-		m_legalDestinations.push_back(CreateCheckersMove(currentPosition, newPosition));
-	}
-}
-
-void Game::AddValidJumpForDirection(const BoardIndex& currentPosition, int verticalDirection,
-	int horizontalDirection)
-{
-	// Two spaces in the same direction we are headed.
-	BoardIndex jumpPosition = GetTranslatedJump(currentPosition, verticalDirection, horizontalDirection);
-
-	// One space in the same direction we are headed.
-	BoardIndex middlePosition = GetTranslatedMove(currentPosition, verticalDirection, horizontalDirection);
-
-	if (!IsValidBoardIndex(jumpPosition) || !IsValidBoardIndex(middlePosition))
-		return;
-
-	// If the location contains a piece that is not mine
-	if (ContainsEnemyPiece(middlePosition) && !ContainsPiece(jumpPosition))
-	{
-		LOG_DEBUG_CONSOLE("Info: Added Valid Jump Destination: " + BoardIndexToString(jumpPosition));
-		m_legalJumpDestinations.push_back(CreateCheckersMove(currentPosition, jumpPosition));
-	}
-}
-
-void Game::AddValidJumpsFromJump(const CheckersMove& currentMove,
-	int verticalDirection, int horizontalDirection)
-{
-	Vector2D direction(currentMove.m_verticalDirection, currentMove.m_horizontalDirection);
-	const BoardIndex& destination(currentMove.m_moveDestination);
-
-	Vector2D invertedDirection(direction.m_y * -1, direction.m_x * -1);
-
-	// After the jump, we need to look east or west in the same direction to see if we can jump again.
-	BoardIndex lookaheadHorizontal = GetTranslatedMove(currentMove.m_moveDestination,
-		direction.m_y, direction.m_x);
-
-	BoardIndex lookaheadHorizontalInverted = GetTranslatedMove(currentMove.m_moveDestination,
-		direction.m_y, invertedDirection.m_x);
-
-	if (IsValidBoardIndex(lookaheadHorizontal) &&
-		!IsPieceOfCurrentPlayer(GetPieceForIndex(lookaheadHorizontal)))
-	{
-		// Look in the same vertical direction and horizontal direction.
-		AddValidJumpForDirection(destination, direction.m_y, direction.m_x);
-	}
-
-	if (IsValidBoardIndex(lookaheadHorizontalInverted) &&
-		!IsPieceOfCurrentPlayer(GetPieceForIndex(lookaheadHorizontalInverted)))
-	{
-		// Look in the same vertical direction and opposite horizontal direction.
-		AddValidJumpForDirection(destination, direction.m_y, invertedDirection.m_x);
-	}
-
-	if (GetPieceForIndex(currentMove.m_moveDestination) == BLACK_KING
-		|| GetPieceForIndex(currentMove.m_moveDestination) == WHITE_KING)
-	{
-		BoardIndex lookaheadVerticalInverted = GetTranslatedMove(currentMove.m_moveDestination,
-			invertedDirection.m_y, direction.m_x);
-
-		if (IsValidBoardIndex(lookaheadVerticalInverted) &&
-			!IsPieceOfCurrentPlayer(GetPieceForIndex(lookaheadVerticalInverted)))
-		{
-			// Look in the opposite vertical direction and same horizontal direction.
-			AddValidJumpForDirection(destination, invertedDirection.m_y, direction.m_x);
-		}
-	}
+	bool isWhitePlayerTurn = m_position.m_isWhitePlayerTurn;
+	return isWhitePlayerTurn && (piece == WHITE || piece == WHITE_KING)
+		|| !isWhitePlayerTurn && (piece == BLACK || piece == BLACK_KING);
 }
 
 BoardIndex Game::GetTranslatedMove(const BoardIndex& source, int verticalDirection,
@@ -380,12 +435,6 @@ BoardIndex Game::GetTranslatedMove(const BoardIndex& source, int verticalDirecti
 		source.second + s_moveLength * horizontalDirection);
 }
 
-BoardIndex Game::GetTranslatedJump(const BoardIndex& source, int verticalDirection, int horizontalDirection)
-{
-	return BoardIndex(source.first + s_jumpLength * verticalDirection,
-		source.second + s_jumpLength * horizontalDirection);
-}
-
 std::string Game::BoardIndexToString(const BoardIndex& index) const
 {
 	return std::string(std::to_string(index.first) +  " , ") + std::to_string(index.second);
@@ -393,7 +442,21 @@ std::string Game::BoardIndexToString(const BoardIndex& index) const
 
 PieceDisplayType Game::GetPieceForIndex(const BoardIndex& index) const
 {
-	return m_boardData[index.first][index.second];
+	int square = SquareFromBoardIndex(index);
+	if (square < 0)
+		return EMPTY;
+
+	return m_position.GetPiece(square);
+}
+
+void Game::UpdateHashKeyForMove(const BoardIndex& source, const BoardIndex& destination,
+	PieceDisplayType movedPiece)
+{
+	int sourceSquare = SquareFromBoardIndex(source);
+	int destinationSquare = SquareFromBoardIndex(destination);
+
+	m_hashKey ^= Zobrist::GetPieceKey(GetPieceForIndex(source), sourceSquare)
+		^ Zobrist::GetPieceKey(movedPiece, destinationSquare);
 }
 
 PieceDisplayType Game::GetPieceForMove(const CheckersMove& move) const
@@ -458,7 +521,7 @@ void CheckersMoveLauncher::HandleMoveSelected(const BoardIndex& move)
 {
 	if (m_isDestinationSet)
 	{
-		LOG_DEBUG_CONSOLE("Warning: This move already has a source and a destination.");
+		LOG_WARNING(Logger::CATEGORY_INPUT, "This move already has a source and a destination.");
 		assert(m_isSourceSet);
 	}
 
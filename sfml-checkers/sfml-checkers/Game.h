@@ -6,11 +6,15 @@
 #pragma once
 
 #include "CheckersTypes.h"
+#include "MoveList.h"
+#include "Position.h"
 
 #include <memory>
 #include <functional>
+#include <vector>
 
 class CheckersMoveLauncher;
+class GameRecordWriter;
 struct CheckersMove;
 
 struct Vector2D
@@ -33,7 +37,20 @@ public:
 	Game();
 	~Game();
 
-	const BoardData& GetBoardData() { return m_boardData; }
+	const Position& GetPosition() const { return m_position; }
+
+	// The position the game was started from.
+	const Position& GetStartPosition() const { return m_startPosition; }
+
+	// Starts a new game from the position.
+	void SetPosition(const Position& position);
+
+	// Appends every turn played so far as one move each, oldest first. The hops of a capture chain
+	// under way are left out.
+	void GetTurns(std::vector<PackedMove>& turnsOut) const;
+
+	// Zobrist key of the position, kept up to date incrementally by every move.
+	uint64_t GetHashKey() const { return m_hashKey; }
 
 	// Return the correct board index for UI coordinates.
 	BoardIndex GetBoardIndexFromRowCol(int row, int col) const;
@@ -41,7 +58,38 @@ public:
 	// Called in response to the UI reporting that a player made a selection.
 	void OnMoveSelectionEvent(const BoardIndex& boardIndex);
 
+	// Plays a complete turn, a whole capture chain at once. Returns false if the turn is not legal
+	// or a capture chain is already under way.
+	bool PlayMove(const PackedMove& turn);
+
+	// Plays a single move or hop between two squares as if the player had selected them, through
+	// the same legality checks. Returns false if it is not legal.
+	bool PlayHop(int source, int destination);
+
+	// Takes back the last turn, or the hops of the current one if a capture chain is under way.
+	// Returns false if there is nothing to take back.
+	bool TakeBack();
+
+	// Called whenever a move, a hop or a takeback changed the pieces on the board.
+	void SetBoardChangedCallback(std::function<void()> boardChangedCallback);
+
+	// Records every turn with the writer as it ends, and the result once the side to move has no
+	// turn left. Taken back turns are removed again. Null stops recording.
+	void SetRecordWriter(GameRecordWriter* recordWriter);
+
 private:
+	// One played move or hop, with what it takes to take it back.
+	struct HistoryEntry
+	{
+		UndoRecord m_undo;
+
+		// Zobrist key before the move.
+		uint64_t m_hashKey;
+
+		// Whether the turn passed after this move, false in the middle of a capture chain.
+		bool m_isTurnEnd;
+	};
+
 	// This is called from the CheckersMoveLauncher when the move destination is selected.
 	// This will reset the CheckersMoveLauncher unconditionally, and attempt to move.
 	void OnLaunchMove();
@@ -58,9 +106,17 @@ private:
 	// This will toggle player turns.
 	void SwitchTurns();
 
-	// Reran per turn. Contains all possible moves of a player.
+	void NotifyBoardChanged();
+
+	// Hands the turn that just ended to the record writer, and the result if the game is over.
+	void RecordTurn();
+
+	// Reran per turn. Generates all possible moves of a player from the bitboards.
 	void PopulateLegalTurnMoves();
 
+	// Rebuilds the destination lookups from the legal move and jump lists.
+	void IndexLegalDestinations();
+
 	// Returns whether the index is within the bounds of the board.
 	bool IsValidBoardIndex(const BoardIndex& boardIndex) const;
 
@@ -85,33 +141,19 @@ private:
 	// Returns whether the specified piece belongs to the player whose turn it currently is.
 	bool IsPieceOfCurrentPlayer(PieceDisplayType piece) const;
 
-	// This will attempt to add possible moves for a specific piece.
-	void EvaluatePossibleMovesForIndex(const BoardIndex& pieceIndex);
-
-	// Given a direction, will add a move to the appropriate list if it is valid.
-	void AddValidMoveForDirection(const BoardIndex& currentPosition, int verticalDirection,
-		int horizontalDirection);
-
-	// Given a direction, will add a valid jump to the jump list.
-	void AddValidJumpForDirection(const BoardIndex& currentPosition, int verticalDirection,
-		int horizontalDirection);
-
-	// Given a jump, will try and assemble the next jump in the chain if one exists.
-	void AddValidJumpsFromJump(const CheckersMove& currentMove, int verticalDirection,
-		int horizontalDirection);
-
 	// Will translate a move which is one space ahead.
 	BoardIndex GetTranslatedMove(const BoardIndex& source, int verticalDirection, int horizontalDirection);
 
-	// Will translate a jump which is two spaces ahead.
-	BoardIndex GetTranslatedJump(const BoardIndex& source, int verticalDirection, int horizontalDirection);
-
 	// Will return a string representation of a BaordIndex.
 	std::string BoardIndexToString(const BoardIndex& index) const;
 
 	// Returns PieceDisplayType for given index.
 	PieceDisplayType GetPieceForIndex(const BoardIndex& index) const;
 
+	// Moves the key of the piece from the source to the destination, the piece may be crowned.
+	void UpdateHashKeyForMove(const BoardIndex& source, const BoardIndex& destination,
+		PieceDisplayType movedPiece);
+
 	// Returns the appropriate piece for the destination of the move that was given.
 	PieceDisplayType GetPieceForMove(const CheckersMove& move) const;
 
@@ -119,20 +161,32 @@ private:
 	CheckersMove CreateCheckersMove(const BoardIndex& sourceIndex,
 		const BoardIndex& destinationIndex) const;
 
-	// Contains every movable index and what type of piece if any is there.
-	BoardData m_boardData;
+	// Bitboards for every playable square and the side to move.
+	Position m_position;
+	Position m_startPosition;
+
+	// Zobrist key of m_position.
+	uint64_t m_hashKey;
+
+	// Every move and hop played so far, the latest last.
+	std::vector<HistoryEntry> m_history;
 
 	// Stores the source move and destination move when requested by the player.
 	std::unique_ptr<CheckersMoveLauncher> m_pendingMoveLauncher;
 
+	std::function<void()> m_boardChangedCallback;
+
+	GameRecordWriter* m_recordWriter;
+
 	// This list is populated each turn and represents all possible moves of that player.
-	std::vector<CheckersMove> m_legalDestinations;
+	MoveList m_legalMoves;
 
 	// If this list is not empty, a move must come from this list.
-	std::vector<CheckersMove> m_legalJumpDestinations;
+	MoveList m_legalJumps;
 
-	// Toggle value. If it is not white player's turn, it is black players turn.
-	bool m_isWhitePlayerTurn;
+	// Destinations of the legal moves and jumps, indexed by source square.
+	Bitboard m_legalDestinations[s_squareCount];
+	Bitboard m_legalJumpDestinations[s_squareCount];
 };
 
 //---------------------------------------------------------------
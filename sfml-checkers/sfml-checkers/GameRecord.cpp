@@ -0,0 +1,292 @@
+//---------------------------------------------------------------
+//
+// GameRecord.cpp
+//
+
+#include "GameRecord.h"
+#include "Log.h"
+#include "MoveGenerator.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+//==============================================================================
+
+const char s_magic[4] = { 'C', 'K', 'G', 'R' };
+const uint8_t s_version = 1;
+const size_t s_headerSize = 8;
+
+// Ends the turns of a game, turn indices are written plus one.
+const uint8_t s_endOfGame = 0;
+
+// Buffered bytes past which the writer writes them out.
+const size_t s_flushSize = 1 << 16;
+
+void WriteHeader(std::vector<uint8_t>& bytesOut)
+{
+	bytesOut.insert(bytesOut.end(), s_magic, s_magic + sizeof(s_magic));
+	bytesOut.push_back(s_version);
+	bytesOut.resize(bytesOut.size() + s_headerSize - sizeof(s_magic) - 1, 0);
+}
+
+bool IsValidHeader(const uint8_t* data, uint64_t size)
+{
+	return size >= s_headerSize && std::memcmp(data, s_magic, sizeof(s_magic)) == 0 && data[4] == s_version;
+}
+
+// Seven bits per byte, lowest first, the high bit set on every byte but the last.
+void WriteVarint(uint32_t value, std::vector<uint8_t>& bytesOut)
+{
+	while (value >= 0x80)
+	{
+		bytesOut.push_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+
+	bytesOut.push_back(static_cast<uint8_t>(value));
+}
+
+// Returns false if the data ends in the middle of the varint.
+bool ReadVarint(const uint8_t* data, uint64_t size, uint64_t& offset, uint32_t& valueOut)
+{
+	uint32_t value = 0;
+	for (int shift = 0; offset < size && shift < 32; shift += 7)
+	{
+		uint8_t byte = data[offset++];
+		value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+		{
+			valueOut = value;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+int GameRecord::GetTurnIndex(const Position& position, const PackedMove& turn)
+{
+	MoveList turns;
+	MoveGenerator::GenerateTurns(position, turns);
+
+	const PackedMove* found = std::find(turns.begin(), turns.end(), turn);
+	return found != turns.end() ? static_cast<int>(found - turns.begin()) : -1;
+}
+
+bool GameRecord::GetTurn(const Position& position, int turnIndex, PackedMove& turnOut)
+{
+	MoveList turns;
+	MoveGenerator::GenerateTurns(position, turns);
+	if (turnIndex < 0 || turnIndex >= turns.GetSize())
+		return false;
+
+	turnOut = turns[turnIndex];
+	return true;
+}
+
+//---------------------------------------------------------------
+
+GameRecordWriter::GameRecordWriter()
+	: m_file(nullptr)
+	, m_result(RESULT_UNFINISHED)
+{
+}
+
+GameRecordWriter::~GameRecordWriter()
+{
+	Close();
+}
+
+bool GameRecordWriter::Open(const std::string& filePath)
+{
+	Close();
+
+	// An existing file must already be a record file, the games are added to it.
+	uint8_t header[s_headerSize];
+	size_t headerSize = 0;
+	if (std::FILE* existingFile = std::fopen(filePath.c_str(), "rb"))
+	{
+		headerSize = std::fread(header, 1, s_headerSize, existingFile);
+		std::fclose(existingFile);
+
+		if (headerSize != 0 && !IsValidHeader(header, headerSize))
+		{
+			LOG_ERROR(Logger::CATEGORY_GAME, "Not a game record file: " + filePath);
+			return false;
+		}
+	}
+
+	m_file = std::fopen(filePath.c_str(), "ab");
+	if (!m_file)
+	{
+		LOG_ERROR(Logger::CATEGORY_GAME, "Cannot open the game record file " + filePath);
+		return false;
+	}
+
+	if (headerSize == 0)
+		WriteHeader(m_buffer);
+
+	return true;
+}
+
+void GameRecordWriter::Close()
+{
+	if (!m_file)
+		return;
+
+	BeginGame();
+	Flush();
+
+	std::fclose(m_file);
+	m_file = nullptr;
+}
+
+void GameRecordWriter::AppendTurn(int turnIndex)
+{
+	if (m_result != RESULT_UNFINISHED)
+		BeginGame();
+
+	m_turnIndices.push_back(turnIndex);
+}
+
+void GameRecordWriter::RemoveLastTurn()
+{
+	if (m_turnIndices.empty())
+		return;
+
+	m_turnIndices.pop_back();
+	m_result = RESULT_UNFINISHED;
+}
+
+void GameRecordWriter::EndGame(GameResult result)
+{
+	if (!m_turnIndices.empty())
+		m_result = result;
+}
+
+void GameRecordWriter::BeginGame()
+{
+	if (m_turnIndices.empty())
+		return;
+
+	for (int turnIndex : m_turnIndices)
+	{
+		WriteVarint(static_cast<uint32_t>(turnIndex) + 1, m_buffer);
+	}
+
+	m_buffer.push_back(s_endOfGame);
+	m_buffer.push_back(static_cast<uint8_t>(m_result));
+	m_turnIndices.clear();
+	m_result = RESULT_UNFINISHED;
+
+	if (m_buffer.size() >= s_flushSize)
+		Flush();
+}
+
+void GameRecordWriter::Flush()
+{
+	if (!m_file || m_buffer.empty())
+		return;
+
+	std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file);
+	std::fflush(m_file);
+	m_buffer.clear();
+}
+
+//---------------------------------------------------------------
+
+GameRecordReader::GameRecordReader()
+	: m_offset(0)
+	, m_isInGame(false)
+	, m_isTruncated(false)
+	, m_result(RESULT_UNFINISHED)
+{
+}
+
+GameRecordReader::~GameRecordReader()
+{
+	Close();
+}
+
+bool GameRecordReader::Open(const std::string& filePath)
+{
+	Close();
+
+	if (!m_file.Open(filePath, FILE_ACCESS_SEQUENTIAL))
+	{
+		LOG_ERROR(Logger::CATEGORY_GAME, "Cannot open the game record file " + filePath);
+		return false;
+	}
+
+	if (!IsValidHeader(m_file.GetData(), m_file.GetSize()))
+	{
+		LOG_ERROR(Logger::CATEGORY_GAME, "Not a game record file: " + filePath);
+		Close();
+		return false;
+	}
+
+	m_offset = s_headerSize;
+	return true;
+}
+
+void GameRecordReader::Close()
+{
+	m_file.Close();
+	m_offset = 0;
+	m_isInGame = false;
+	m_isTruncated = false;
+	m_result = RESULT_UNFINISHED;
+}
+
+bool GameRecordReader::NextGame()
+{
+	int turnIndex;
+	while (m_isInGame && NextTurn(turnIndex))
+	{
+	}
+
+	if (m_offset >= m_file.GetSize())
+		return false;
+
+	m_isInGame = true;
+	m_result = RESULT_UNFINISHED;
+	return true;
+}
+
+bool GameRecordReader::NextTurn(int& turnIndexOut)
+{
+	if (!m_isInGame)
+		return false;
+
+	const uint8_t* data = m_file.GetData();
+	uint64_t size = m_file.GetSize();
+
+	uint32_t value;
+	if (!ReadVarint(data, size, m_offset, value))
+	{
+		m_isTruncated = true;
+		m_isInGame = false;
+		m_offset = size;
+		return false;
+	}
+
+	if (value == s_endOfGame)
+	{
+		m_isInGame = false;
+		if (m_offset < size)
+			m_result = static_cast<GameResult>(data[m_offset++]);
+		else
+			m_isTruncated = true;
+
+		return false;
+	}
+
+	turnIndexOut = static_cast<int>(value - 1);
+	return true;
+}
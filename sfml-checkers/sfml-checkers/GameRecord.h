@@ -0,0 +1,139 @@
+//---------------------------------------------------------------
+//
+// GameRecord.h
+//
+// Compact binary game records. A file starts with an 8 byte header, the magic "CKGR", a version
+// byte and three reserved bytes. Then come the games, each one a varint per turn holding the index
+// of the turn plus one among the turns MoveGenerator::GenerateTurns lists for the position, a zero
+// byte ending the game, and a result byte. Every game starts from the start position, so that is
+// all it takes to replay it: a turn costs a single byte.
+//
+
+#pragma once
+
+#include "MappedFile.h"
+#include "MoveList.h"
+#include "Position.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+enum GameResult
+{
+	RESULT_UNFINISHED,
+	RESULT_WHITE_WIN,
+	RESULT_BLACK_WIN,
+	RESULT_DRAW,
+};
+
+namespace GameRecord {
+
+//==============================================================================
+
+// Index of the turn among the turns generated for the position, -1 if it is not one of them.
+int GetTurnIndex(const Position& position, const PackedMove& turn);
+
+// The turn with the index among the turns generated for the position. Returns false if there is no
+// such turn.
+bool GetTurn(const Position& position, int turnIndex, PackedMove& turnOut);
+
+//==============================================================================
+
+} // namespace GameRecord
+
+//---------------------------------------------------------------
+
+// Appends games to a record file. The turns of the game under way are kept in memory, so a turn
+// can still be taken back, even once the game is over. A game is only encoded into the buffer, which
+// is written out in large blocks, when the next one begins or the writer closes. A writer belongs
+// to one thread.
+class GameRecordWriter
+{
+public:
+	GameRecordWriter();
+
+	// Ends the game under way as unfinished and writes out what is buffered.
+	~GameRecordWriter();
+
+	// Opens the file for appending, writing the header if it is new. Returns false if it cannot be
+	// opened or is not a record file.
+	bool Open(const std::string& filePath);
+
+	void Close();
+
+	bool IsOpen() const { return m_file != nullptr; }
+
+	// Adds a turn to the game under way. After the game was ended this begins a new one.
+	void AppendTurn(int turnIndex);
+
+	// Removes the last turn of the game under way, if there is one. A game that was ended is under
+	// way again, its result is forgotten.
+	void RemoveLastTurn();
+
+	// Sets the result of the game under way. Its turns can still be taken back until the next game
+	// begins.
+	void EndGame(GameResult result);
+
+	// Encodes the game under way with its result, unfinished if it was not ended, so nothing of it
+	// can be taken back any more. Does nothing if no turn was played.
+	void BeginGame();
+
+	// Writes the buffered games to the file.
+	void Flush();
+
+private:
+	std::FILE* m_file;
+
+	// Turns of the game under way, and its result once it was ended.
+	std::vector<int> m_turnIndices;
+	GameResult m_result;
+
+	// Finished games not written out yet.
+	std::vector<uint8_t> m_buffer;
+};
+
+//---------------------------------------------------------------
+
+// Reads a record file through a memory mapping, so files far larger than memory can be walked
+// without loading them. Games and their turns are read in order:
+//
+//   while (reader.NextGame())
+//       while (reader.NextTurn(turnIndex))
+//           ...
+//   reader.GetResult()
+class GameRecordReader
+{
+public:
+	GameRecordReader();
+	~GameRecordReader();
+
+	// Maps the file. Returns false if it cannot be mapped or is not a record file.
+	bool Open(const std::string& filePath);
+
+	void Close();
+
+	// Moves to the next game, skipping what is left of the current one. Returns false at the end.
+	bool NextGame();
+
+	// Reads the next turn of the current game. Returns false once the game is over, its result is
+	// then available.
+	bool NextTurn(int& turnIndexOut);
+
+	// Result of the current game, once all its turns were read.
+	GameResult GetResult() const { return m_result; }
+
+	// Whether the file ended in the middle of a game, which happens when its writer was killed.
+	bool IsTruncated() const { return m_isTruncated; }
+
+	uint64_t GetSize() const { return m_file.GetSize(); }
+
+private:
+	MappedFile m_file;
+	uint64_t m_offset;
+
+	bool m_isInGame;
+	bool m_isTruncated;
+	GameResult m_result;
+};
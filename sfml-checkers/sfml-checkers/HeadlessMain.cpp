@@ -0,0 +1,199 @@
+//---------------------------------------------------------------
+//
+// HeadlessMain.cpp
+//
+// Headless game driver. Plays the engine against itself without a window, through the same Game
+// the GUI uses, and prints the moves and the result. Links only the engine library.
+//
+// usage: checkers-headless [--depth <plies>] [--movetime <ms>] [--nodes <count>] [--hash <MB>]
+//                          [--max-turns <count>] [--tablebase <directory>] [--book <file>] [--network <file>]
+//
+
+#include "Game.h"
+#include "MoveGenerator.h"
+#include "NeuralNetwork.h"
+#include "OpeningBook.h"
+#include "Search.h"
+#include "Tablebase.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+namespace {
+
+//==============================================================================
+
+const int s_defaultDepth = 8;
+
+// A game still going after this many turns is scored a draw.
+const int s_defaultMaxTurns = 200;
+
+struct HeadlessOptions
+{
+	HeadlessOptions()
+		: m_hashMegabytes(16)
+		, m_maxTurns(s_defaultMaxTurns)
+	{
+		m_searchLimits.m_maxDepth = s_defaultDepth;
+		m_searchLimits.m_moveTimeMs = 0;
+	}
+
+	SearchLimits m_searchLimits;
+	size_t m_hashMegabytes;
+	int m_maxTurns;
+	std::string m_tablebaseDirectory;
+	std::string m_bookPath;
+	std::string m_networkPath;
+};
+
+void PrintUsage()
+{
+	std::printf("usage: checkers-headless [--depth <plies>] [--movetime <ms>] [--nodes <count>] [--hash <MB>]\n"
+		"                         [--max-turns <count>] [--tablebase <directory>] [--book <file>] [--network <file>]\n"
+		"  --depth      search depth of every move, defaults to %d\n"
+		"  --movetime   search time of every move instead of a fixed depth\n"
+		"  --nodes      node limit of every move instead of a fixed depth, plays the same game every time\n"
+		"  --hash       transposition table size of each side, defaults to 16 MB\n"
+		"  --max-turns  turns after which the game is a draw, defaults to %d\n"
+		"  --tablebase  directory of endgame tables for both sides to probe\n"
+		"  --book       opening book both sides play from while it has the position\n"
+		"  --network    network weights both sides evaluate with instead of the hand written evaluation\n",
+		s_defaultDepth, s_defaultMaxTurns);
+}
+
+bool ParseOptions(int argc, char** argv, HeadlessOptions& optionsOut)
+{
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string argument(argv[i]);
+		int value = std::atoi(argv[i + 1]);
+
+		if (argument == "--depth")
+		{
+			optionsOut.m_searchLimits.m_maxDepth = value;
+		}
+		else if (argument == "--movetime")
+		{
+			optionsOut.m_searchLimits.m_moveTimeMs = value;
+			optionsOut.m_searchLimits.m_maxDepth = 0;
+		}
+		else if (argument == "--nodes")
+		{
+			optionsOut.m_searchLimits.m_maxNodes = std::strtoull(argv[i + 1], nullptr, 10);
+			optionsOut.m_searchLimits.m_maxDepth = 0;
+		}
+		else if (argument == "--hash")
+		{
+			optionsOut.m_hashMegabytes = static_cast<size_t>(value);
+		}
+		else if (argument == "--max-turns")
+		{
+			optionsOut.m_maxTurns = value;
+		}
+		else if (argument == "--tablebase")
+		{
+			optionsOut.m_tablebaseDirectory = argv[i + 1];
+		}
+		else if (argument == "--book")
+		{
+			optionsOut.m_bookPath = argv[i + 1];
+		}
+		else if (argument == "--network")
+		{
+			optionsOut.m_networkPath = argv[i + 1];
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return (argc % 2) == 1 && optionsOut.m_hashMegabytes > 0 && optionsOut.m_maxTurns > 0;
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+	HeadlessOptions options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	// Each side searches with a table of its own, like two separate programs would.
+	SearchEngine whiteEngine(options.m_hashMegabytes);
+	SearchEngine blackEngine(options.m_hashMegabytes);
+
+	Tablebase tablebase;
+	if (!options.m_tablebaseDirectory.empty())
+	{
+		if (!tablebase.Open(options.m_tablebaseDirectory))
+		{
+			std::fprintf(stderr, "Error: no tablebase in %s\n", options.m_tablebaseDirectory.c_str());
+			return 1;
+		}
+
+		whiteEngine.SetTablebase(&tablebase);
+		blackEngine.SetTablebase(&tablebase);
+	}
+
+	OpeningBook openingBook;
+	if (!options.m_bookPath.empty())
+	{
+		if (!openingBook.Open(options.m_bookPath))
+		{
+			std::fprintf(stderr, "Error: cannot open the opening book %s\n", options.m_bookPath.c_str());
+			return 1;
+		}
+
+		whiteEngine.SetOpeningBook(&openingBook);
+		blackEngine.SetOpeningBook(&openingBook);
+	}
+
+	// Too large for the stack.
+	std::unique_ptr<NeuralNetwork> network(new NeuralNetwork());
+	if (!options.m_networkPath.empty())
+	{
+		if (!network->Load(options.m_networkPath))
+		{
+			std::fprintf(stderr, "Error: cannot load the network %s\n", options.m_networkPath.c_str());
+			return 1;
+		}
+
+		whiteEngine.SetNetwork(network.get());
+		blackEngine.SetNetwork(network.get());
+	}
+
+	Game game;
+	int turn = 0;
+	for (; turn < options.m_maxTurns; ++turn)
+	{
+		const Position& position = game.GetPosition();
+		SearchEngine& engine = position.m_isWhitePlayerTurn ? whiteEngine : blackEngine;
+
+		SearchResult result = engine.Search(position, options.m_searchLimits);
+		if (result.m_bestMove.empty())
+			break;
+
+		if (turn % 2 == 0)
+			std::printf("%d. ", turn / 2 + 1);
+		std::printf("%s ", MoveGenerator::GetNotation(position, result.m_bestTurn).c_str());
+		std::fflush(stdout);
+
+		game.PlayMove(result.m_bestTurn);
+	}
+
+	// The side to move without a legal move has lost.
+	if (turn == options.m_maxTurns)
+		std::printf("\ndraw after %d turns\n", turn);
+	else
+		std::printf("\n%s wins after %d turns\n", game.GetPosition().m_isWhitePlayerTurn ? "black" : "white", turn);
+
+	return 0;
+}
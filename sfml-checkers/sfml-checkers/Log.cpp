@@ -5,9 +5,19 @@
 
 #include "Log.h"
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
+#if defined(_WIN32)
 #define NOMINMAX
 #include <windows.h>
+#endif
 
 namespace {
 
@@ -15,51 +25,350 @@ namespace {
 
 const int s_maxLength = 70;
 
+// Longer messages are cut off when they are queued.
+const int s_maxRecordLength = 200;
+
+// Records every thread can queue before the next ones are dropped. A power of two.
+const uint64_t s_ringCapacity = 512;
+
+// How long the logging thread sleeps when it found nothing to write.
+const std::chrono::milliseconds s_idleSleep(5);
+
 enum MessageType
 {
 	DEBUG_WINDOW,
 	CONSOLE
 };
 
-void AppendLoggingInfoToLog(const std::string& fileName, int lineNumber, std::string& messageOut)
+const char* GetLevelPrefix(Logger::LogLevel level)
+{
+	switch (level)
+	{
+	case Logger::LEVEL_ERROR:
+		return "Error: ";
+	case Logger::LEVEL_WARNING:
+		return "Warning: ";
+	case Logger::LEVEL_INFO:
+		return "Info: ";
+	default:
+		return "Debug: ";
+	}
+}
+
+void AppendLoggingInfoToLog(const char* fileName, int lineNumber, std::string& messageOut)
 {
 	// Remove full path from the filename.
-	std::string strippedFilename;
-	size_t i = fileName.rfind('\\');
-	if (i != std::string::npos)
+	const char* strippedFilename = fileName;
+	for (const char* c = fileName; *c; ++c)
 	{
-		strippedFilename = fileName.substr(i + 1, fileName.length());
+		if (*c == '\\' || *c == '/')
+			strippedFilename = c + 1;
 	}
 
-	std::stringstream ss;
-	ss << messageOut;
-	ss << " <" << strippedFilename;
-	ss << "> (" << lineNumber << ")\n";
-	messageOut = ss.str();
+	messageOut += " <";
+	messageOut += strippedFilename;
+	messageOut += "> (";
+	messageOut += std::to_string(lineNumber);
+	messageOut += ")\n";
 }
 
-//==============================================================================
+// A message as it is queued by the thread that logs it: the raw parts only, the logging thread
+// formats them. File names are __FILE__ literals, so keeping the pointer is enough.
+struct LogRecord
+{
+	const char* m_fileName;
+	int m_lineNumber;
+	Logger::LogLevel m_level;
+	Logger::LogSink m_sink;
+	int m_length;
+	char m_text[s_maxRecordLength];
+};
 
-} // anonymous namespace
+void FormatRecord(const LogRecord& record, std::string& messageOut)
+{
+	messageOut = GetLevelPrefix(record.m_level);
+	messageOut.append(record.m_text, record.m_length);
+	AppendLoggingInfoToLog(record.m_fileName, record.m_lineNumber, messageOut);
+}
 
-void Logger::LogDebugMessage(const std::string& message, LogSink messageType,
-	const char* fileName, int lineNumber)
+// Single producer, single consumer queue of records. The thread that owns it pushes, the logging
+// thread pops, and neither ever waits for the other: a push to a full queue drops the record.
+class RecordRing
 {
-	if (message.empty())
-		return;
+public:
+	RecordRing()
+		: m_head(0)
+		, m_tail(0)
+		, m_droppedCount(0)
+	{
+	}
+
+	bool TryPush(const std::string& message, Logger::LogLevel level, Logger::LogSink sink, const char* fileName,
+		int lineNumber)
+	{
+		uint64_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) == s_ringCapacity)
+		{
+			m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		LogRecord& record = m_records[tail & (s_ringCapacity - 1)];
+		record.m_fileName = fileName;
+		record.m_lineNumber = lineNumber;
+		record.m_level = level;
+		record.m_sink = sink;
+		record.m_length = std::min(static_cast<int>(message.size()), s_maxRecordLength);
+		std::memcpy(record.m_text, message.data(), record.m_length);
+
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Returns the oldest record, or null if the queue is empty. It stays valid until PopFront.
+	const LogRecord* GetFront() const
+	{
+		uint64_t head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire))
+			return nullptr;
+
+		return &m_records[head & (s_ringCapacity - 1)];
+	}
+
+	void PopFront()
+	{
+		m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	uint64_t GetDroppedCount() const { return m_droppedCount.load(std::memory_order_relaxed); }
+
+private:
+	// Written by the consumer and the producer respectively, on lines of their own.
+	alignas(64) std::atomic<uint64_t> m_head;
+	alignas(64) std::atomic<uint64_t> m_tail;
+
+	std::atomic<uint64_t> m_droppedCount;
+	LogRecord m_records[s_ringCapacity];
+};
+
+// Owns the queues of every thread that logged and the thread that writes them out.
+class LogBackend
+{
+public:
+	LogBackend()
+		: m_isRunning(false)
+		, m_shouldStop(false)
+		, m_file(nullptr)
+		, m_reportedDroppedCount(0)
+	{
+	}
+
+	~LogBackend()
+	{
+		Stop();
+	}
+
+	static LogBackend& Get()
+	{
+		static LogBackend s_backend;
+		return s_backend;
+	}
+
+	bool Start(const std::string& filePath)
+	{
+		if (m_isRunning.load())
+			return true;
+
+		m_file = filePath.empty() ? stderr : std::fopen(filePath.c_str(), "w");
+		if (!m_file)
+			return false;
+
+		m_shouldStop.store(false);
+		m_thread = std::thread(&LogBackend::Run, this);
+		m_isRunning.store(true);
+		return true;
+	}
+
+	void Stop()
+	{
+		if (!m_isRunning.exchange(false))
+			return;
+
+		m_shouldStop.store(true);
+		m_thread.join();
+
+		// Records queued by threads that still saw it running.
+		WriteQueuedRecords();
 
-	std::string guardedMessage = message;
+		if (m_file != stderr)
+			std::fclose(m_file);
+		m_file = nullptr;
+	}
+
+	bool IsRunning() const { return m_isRunning.load(std::memory_order_relaxed); }
+
+	// The queue of the calling thread. Queues are never freed, so one stays valid for the logging
+	// thread after the thread that filled it is gone.
+	RecordRing& GetThreadRing()
+	{
+		static thread_local RecordRing* s_threadRing = nullptr;
+		if (!s_threadRing)
+		{
+			std::lock_guard<std::mutex> lock(m_ringsMutex);
+			m_rings.emplace_back(new RecordRing());
+			s_threadRing = m_rings.back().get();
+		}
+
+		return *s_threadRing;
+	}
+
+	uint64_t GetDroppedRecordCount()
+	{
+		std::lock_guard<std::mutex> lock(m_ringsMutex);
+
+		uint64_t droppedCount = 0;
+		for (const std::unique_ptr<RecordRing>& ring : m_rings)
+		{
+			droppedCount += ring->GetDroppedCount();
+		}
+
+		return droppedCount;
+	}
+
+private:
+	void Run()
+	{
+		while (!m_shouldStop.load())
+		{
+			if (!WriteQueuedRecords())
+				std::this_thread::sleep_for(s_idleSleep);
+		}
+	}
+
+	// Formats every queued record into one batch and writes it with a single call. Returns whether
+	// there was anything to write.
+	bool WriteQueuedRecords()
+	{
+		std::vector<RecordRing*> rings;
+		{
+			std::lock_guard<std::mutex> lock(m_ringsMutex);
+			for (const std::unique_ptr<RecordRing>& ring : m_rings)
+			{
+				rings.push_back(ring.get());
+			}
+		}
+
+		m_batch.clear();
+		uint64_t droppedCount = 0;
+		for (RecordRing* ring : rings)
+		{
+			for (const LogRecord* record = ring->GetFront(); record; record = ring->GetFront())
+			{
+				// Popping hands the slot back to the logging threads, so nothing of the record is read after.
+				FormatRecord(*record, m_message);
+#if defined(_WIN32)
+				bool isDebugWindowRecord = record->m_sink == Logger::DEBUG_WINDOW;
+#endif
+				ring->PopFront();
+
+#if defined(_WIN32)
+				if (isDebugWindowRecord && m_file == stderr)
+				{
+					OutputDebugString(m_message.c_str());
+					continue;
+				}
+#endif
+				m_batch += m_message;
+			}
+
+			droppedCount += ring->GetDroppedCount();
+		}
+
+		if (droppedCount != m_reportedDroppedCount)
+		{
+			m_batch += "Warning: " + std::to_string(droppedCount - m_reportedDroppedCount)
+				+ " log messages dropped, the log buffer was full\n";
+			m_reportedDroppedCount = droppedCount;
+		}
+
+		if (m_batch.empty())
+			return false;
+
+		std::fwrite(m_batch.data(), 1, m_batch.size(), m_file);
+		std::fflush(m_file);
+		return true;
+	}
+
+	std::atomic<bool> m_isRunning;
+	std::atomic<bool> m_shouldStop;
+	std::thread m_thread;
+
+	std::mutex m_ringsMutex;
+	std::vector<std::unique_ptr<RecordRing>> m_rings;
+
+	// Only touched by the logging thread while it runs.
+	std::FILE* m_file;
+	std::string m_batch;
+	std::string m_message;
+	uint64_t m_reportedDroppedCount;
+};
+
+// Writes the message on the calling thread, used while the logging thread is not running.
+void WriteMessage(const std::string& message, Logger::LogLevel level, Logger::LogSink messageType,
+	const char* fileName, int lineNumber)
+{
+	std::string guardedMessage = GetLevelPrefix(level);
+	guardedMessage += message;
 	AppendLoggingInfoToLog(fileName, lineNumber, guardedMessage);
 
 	switch (messageType)
 	{
-	case DEBUG_WINDOW:
+	case Logger::DEBUG_WINDOW:
+#if defined(_WIN32)
 		OutputDebugString(guardedMessage.c_str());
+#else
+		std::cerr << guardedMessage;
+#endif
 		break;
-	case CONSOLE:
+	case Logger::CONSOLE:
 		std::cout << guardedMessage;
 		break;
 	default:
 		break;
 	}
 }
+
+//==============================================================================
+
+} // anonymous namespace
+
+void Logger::LogDebugMessage(const std::string& message, LogLevel level, LogSink messageType,
+	const char* fileName, int lineNumber)
+{
+	if (message.empty())
+		return;
+
+	LogBackend& backend = LogBackend::Get();
+	if (!backend.IsRunning())
+	{
+		WriteMessage(message, level, messageType, fileName, lineNumber);
+		return;
+	}
+
+	backend.GetThreadRing().TryPush(message, level, messageType, fileName, lineNumber);
+}
+
+bool Logger::StartBackgroundLogging(const std::string& filePath)
+{
+	return LogBackend::Get().Start(filePath);
+}
+
+void Logger::StopBackgroundLogging()
+{
+	LogBackend::Get().Stop();
+}
+
+uint64_t Logger::GetDroppedRecordCount()
+{
+	return LogBackend::Get().GetDroppedRecordCount();
+}
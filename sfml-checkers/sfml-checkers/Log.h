@@ -5,9 +5,25 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <string>
-#include <iostream>
-#include <sstream>
+
+// Messages above this level are compiled out: neither formatted nor even evaluated. Defaults to
+// every level in debug builds and to errors and warnings in release builds, which keeps failures
+// visible while the info and debug messages cost nothing. Define it to override.
+#if !defined(CHECKERS_LOG_LEVEL)
+#if defined(NDEBUG) || (defined(_MSC_VER) && !defined(_DEBUG))
+#define CHECKERS_LOG_LEVEL 2
+#else
+#define CHECKERS_LOG_LEVEL 4
+#endif
+#endif
+
+// Mask of the categories compiled in, all of them unless defined otherwise.
+#if !defined(CHECKERS_LOG_CATEGORIES)
+#define CHECKERS_LOG_CATEGORIES 0xFFFFFFFF
+#endif
 
 namespace Logger {
 
@@ -19,19 +35,82 @@ enum LogSink
 	CONSOLE
 };
 
-void LogDebugMessage(const std::string& message, LogSink messageType, const char* fileName,
-	int lineNumber);
+enum LogLevel
+{
+	LEVEL_NONE,
+	LEVEL_ERROR,
+	LEVEL_WARNING,
+	LEVEL_INFO,
+	LEVEL_DEBUG,
+};
+
+enum LogCategory
+{
+	CATEGORY_GAME = 1 << 0,
+	CATEGORY_INPUT = 1 << 1,
+	CATEGORY_SEARCH = 1 << 2,
+	CATEGORY_RENDER = 1 << 3,
+};
+
+// Levels and categories enabled while running, within the ones compiled in. Everything compiled
+// in is enabled by default.
+inline std::atomic<int> s_enabledLevel(LEVEL_DEBUG);
+inline std::atomic<unsigned> s_enabledCategories(0xFFFFFFFF);
+
+inline void SetEnabledLevel(LogLevel level)
+{
+	s_enabledLevel.store(level, std::memory_order_relaxed);
+}
 
-#define LOG_DEBUG_CONSOLE(msg)                                          \
-{                                                                       \
-	LogDebugMessage(msg, Logger::CONSOLE, __FILE__, __LINE__);          \
+inline void SetEnabledCategories(unsigned categories)
+{
+	s_enabledCategories.store(categories, std::memory_order_relaxed);
+}
+
+constexpr bool IsCompiledIn(LogLevel level, LogCategory category)
+{
+	return level <= CHECKERS_LOG_LEVEL && (category & static_cast<unsigned>(CHECKERS_LOG_CATEGORIES)) != 0;
 }
 
-#define LOG_DEBUG_OUTPUT_WINDOW(msg)                                    \
-{                                                                       \
-	LogDebugMessage(msg, Logger::DEBUG_WINDOW, __FILE__, __LINE__);     \
+inline bool IsEnabled(LogLevel level, LogCategory category)
+{
+	return level <= s_enabledLevel.load(std::memory_order_relaxed)
+		&& (category & s_enabledCategories.load(std::memory_order_relaxed)) != 0;
 }
 
+// Queues the message for the logging thread, or writes it right away while that is not running.
+void LogDebugMessage(const std::string& message, LogLevel level, LogSink messageType, const char* fileName,
+	int lineNumber);
+
+// Starts the logging thread. From then on every thread that logs pushes fixed-size records into a
+// queue of its own without locking, and the logging thread formats them and writes them out in
+// batches, to the file or to stderr if the path is empty. Returns false if the file cannot be opened.
+bool StartBackgroundLogging(const std::string& filePath = std::string());
+
+// Writes out what is still queued and stops the logging thread.
+void StopBackgroundLogging();
+
+// Messages dropped so far because the queue of the thread logging them was full.
+uint64_t GetDroppedRecordCount();
+
+// The message is an expression that is only evaluated once the level and category turn out to be
+// enabled, so a disabled message costs a comparison, and one compiled out costs nothing.
+#define LOG_MESSAGE(level, category, sink, msg)                                          \
+do                                                                                       \
+{                                                                                        \
+	if constexpr (Logger::IsCompiledIn(level, category))                                 \
+	{                                                                                    \
+		if (Logger::IsEnabled(level, category))                                          \
+			Logger::LogDebugMessage(msg, level, sink, __FILE__, __LINE__);               \
+	}                                                                                    \
+} while (false)
+
+#define LOG_ERROR(category, msg) LOG_MESSAGE(Logger::LEVEL_ERROR, category, Logger::CONSOLE, msg)
+#define LOG_WARNING(category, msg) LOG_MESSAGE(Logger::LEVEL_WARNING, category, Logger::CONSOLE, msg)
+#define LOG_INFO(category, msg) LOG_MESSAGE(Logger::LEVEL_INFO, category, Logger::CONSOLE, msg)
+#define LOG_DEBUG_CONSOLE(category, msg) LOG_MESSAGE(Logger::LEVEL_DEBUG, category, Logger::CONSOLE, msg)
+#define LOG_DEBUG_OUTPUT_WINDOW(category, msg) LOG_MESSAGE(Logger::LEVEL_DEBUG, category, Logger::DEBUG_WINDOW, msg)
+
 //==============================================================================
 
 } // namespace Logger
@@ -0,0 +1,161 @@
+//---------------------------------------------------------------
+//
+// MappedFile.cpp
+//
+
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+	: m_data(nullptr)
+	, m_size(0)
+#if defined(_WIN32)
+	, m_fileHandle(INVALID_HANDLE_VALUE)
+	, m_mappingHandle(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const std::string& filePath, FileAccess access)
+{
+	Close();
+
+#if defined(_WIN32)
+	m_fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		access == FILE_ACCESS_SEQUENTIAL ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS, nullptr);
+	LARGE_INTEGER fileSize;
+	if (m_fileHandle == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_fileHandle, &fileSize))
+	{
+		Close();
+		return false;
+	}
+
+	if (fileSize.QuadPart == 0)
+		return true;
+
+	m_mappingHandle = CreateFileMappingA(m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mappingHandle)
+		m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	m_size = static_cast<uint64_t>(fileSize.QuadPart);
+#else
+	int file = open(filePath.c_str(), O_RDONLY);
+	struct stat fileStatus;
+	if (file < 0 || fstat(file, &fileStatus) != 0)
+	{
+		if (file >= 0)
+			close(file);
+		return false;
+	}
+
+	m_size = static_cast<uint64_t>(fileStatus.st_size);
+	if (m_size != 0)
+	{
+		void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (data != MAP_FAILED)
+		{
+			madvise(data, m_size, access == FILE_ACCESS_SEQUENTIAL ? MADV_SEQUENTIAL : MADV_RANDOM);
+			m_data = static_cast<const uint8_t*>(data);
+		}
+	}
+
+	// The mapping stays valid without the descriptor.
+	close(file);
+#endif
+
+	if (m_size != 0 && !m_data)
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+#if defined(_WIN32)
+	if (m_data)
+		UnmapViewOfFile(m_data);
+	if (m_mappingHandle)
+		CloseHandle(m_mappingHandle);
+	if (m_fileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle(m_fileHandle);
+
+	m_mappingHandle = nullptr;
+	m_fileHandle = INVALID_HANDLE_VALUE;
+#else
+	if (m_data)
+		munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+
+	m_data = nullptr;
+	m_size = 0;
+}
+
+//---------------------------------------------------------------
+
+AtomicFileWriter::AtomicFileWriter()
+	: m_file(nullptr)
+	, m_isWritten(false)
+{
+}
+
+AtomicFileWriter::~AtomicFileWriter()
+{
+	if (m_file)
+	{
+		std::fclose(m_file);
+		std::remove(m_temporaryPath.c_str());
+	}
+}
+
+bool AtomicFileWriter::Open(const std::string& filePath)
+{
+	m_filePath = filePath;
+	m_temporaryPath = filePath + ".tmp";
+	m_file = std::fopen(m_temporaryPath.c_str(), "wb");
+	m_isWritten = m_file != nullptr;
+	return m_isWritten;
+}
+
+void AtomicFileWriter::Write(const void* data, size_t size)
+{
+	m_isWritten = m_isWritten && std::fwrite(data, 1, size, m_file) == size;
+}
+
+bool AtomicFileWriter::Commit()
+{
+	if (!m_file)
+		return false;
+
+	bool isWritten = std::fclose(m_file) == 0 && m_isWritten;
+	m_file = nullptr;
+
+#if defined(_WIN32)
+	// Renaming onto an existing file fails here, elsewhere it replaces the file in one step.
+	if (isWritten)
+		std::remove(m_filePath.c_str());
+#endif
+
+	if (!isWritten || std::rename(m_temporaryPath.c_str(), m_filePath.c_str()) != 0)
+	{
+		std::remove(m_temporaryPath.c_str());
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,78 @@
+//---------------------------------------------------------------
+//
+// MappedFile.h
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// How a mapped file will be read, so the system pages it in to suit.
+enum FileAccess
+{
+	// Front to back once, read ahead and drop the pages behind.
+	FILE_ACCESS_SEQUENTIAL,
+
+	// Probes all over the file, read only the pages touched.
+	FILE_ACCESS_RANDOM,
+};
+
+// A whole file mapped read-only into memory. Files far larger than memory are paged in as they are
+// read, and nothing is copied.
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Maps the file, to be read the given way. Returns false if it cannot be opened or mapped. An
+	// empty file maps to no data.
+	bool Open(const std::string& filePath, FileAccess access);
+
+	void Close();
+
+	const uint8_t* GetData() const { return m_data; }
+	uint64_t GetSize() const { return m_size; }
+
+private:
+	const uint8_t* m_data;
+	uint64_t m_size;
+
+#if defined(_WIN32)
+	void* m_fileHandle;
+	void* m_mappingHandle;
+#endif
+};
+
+// A file written under a temporary name and renamed into place once complete, so a file that exists
+// under its name is always whole. Dropped without Commit, the temporary file is removed.
+class AtomicFileWriter
+{
+public:
+	AtomicFileWriter();
+	~AtomicFileWriter();
+
+	AtomicFileWriter(const AtomicFileWriter&) = delete;
+	AtomicFileWriter& operator=(const AtomicFileWriter&) = delete;
+
+	// Creates the temporary file. Returns false if it cannot be created.
+	bool Open(const std::string& filePath);
+
+	// A failed write is remembered and makes Commit fail.
+	void Write(const void* data, size_t size);
+
+	// Closes the temporary file and renames it to the file path, replacing a file already there.
+	// Returns false, and removes the temporary file, if anything could not be written.
+	bool Commit();
+
+private:
+	std::string m_filePath;
+	std::string m_temporaryPath;
+	std::FILE* m_file;
+	bool m_isWritten;
+};
@@ -0,0 +1,200 @@
+//---------------------------------------------------------------
+//
+// MoveGenBenchMain.cpp
+//
+// Batch move generation benchmark. Collects positions from random games, checks that the batch
+// generator lists exactly the turns MoveGenerator::GenerateTurns does for each, and reports the
+// positions per second of a plain loop and of the batch generator on 1, 2, 4, ... threads.
+//
+// usage: movegen-bench [--positions <count>] [--passes <count>] [--threads <max>] [--seed <seed>]
+//
+
+#include "BatchMoveGenerator.h"
+#include "Game.h"
+#include "MoveGenerator.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+//==============================================================================
+
+const int s_defaultPositionCount = 1000000;
+const int s_defaultPassCount = 5;
+
+// Random games are cut off after this many turns.
+const int s_maxGameTurns = 200;
+
+struct MoveGenBenchOptions
+{
+	MoveGenBenchOptions()
+		: m_positionCount(s_defaultPositionCount)
+		, m_passCount(s_defaultPassCount)
+		, m_maxThreadCount(static_cast<int>(std::thread::hardware_concurrency()))
+		, m_seed(1)
+	{
+		if (m_maxThreadCount < 1)
+			m_maxThreadCount = 1;
+	}
+
+	int m_positionCount;
+	int m_passCount;
+	int m_maxThreadCount;
+	uint64_t m_seed;
+};
+
+void PrintUsage()
+{
+	std::printf("usage: movegen-bench [--positions <count>] [--passes <count>] [--threads <max>] [--seed <seed>]\n"
+		"  --positions  positions to generate the turns of, defaults to %d\n"
+		"  --passes     times every position is generated, defaults to %d\n"
+		"  --threads    highest thread count measured, defaults to the hardware threads\n"
+		"  --seed       seed of the random games the positions come from\n",
+		s_defaultPositionCount, s_defaultPassCount);
+}
+
+bool ParseOptions(int argc, char** argv, MoveGenBenchOptions& optionsOut)
+{
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string argument(argv[i]);
+		std::string value(argv[i + 1]);
+
+		if (argument == "--positions")
+			optionsOut.m_positionCount = std::atoi(value.c_str());
+		else if (argument == "--passes")
+			optionsOut.m_passCount = std::atoi(value.c_str());
+		else if (argument == "--threads")
+			optionsOut.m_maxThreadCount = std::atoi(value.c_str());
+		else if (argument == "--seed")
+			optionsOut.m_seed = std::strtoull(value.c_str(), nullptr, 10);
+		else
+			return false;
+	}
+
+	return (argc % 2) == 1 && optionsOut.m_positionCount > 0 && optionsOut.m_passCount > 0
+		&& optionsOut.m_maxThreadCount > 0;
+}
+
+// Every position of random games played through Game, until there are enough.
+void CollectPositions(const MoveGenBenchOptions& options, std::vector<Position>& positionsOut)
+{
+	std::mt19937_64 random(options.m_seed);
+	MoveList turns;
+	while (static_cast<int>(positionsOut.size()) < options.m_positionCount)
+	{
+		Game game;
+		for (int turn = 0; turn < s_maxGameTurns && static_cast<int>(positionsOut.size()) < options.m_positionCount;
+			++turn)
+		{
+			positionsOut.push_back(game.GetPosition());
+
+			turns.Clear();
+			MoveGenerator::GenerateTurns(game.GetPosition(), turns);
+			if (turns.IsEmpty())
+				break;
+
+			game.PlayMove(turns[static_cast<int>(random() % turns.GetSize())]);
+		}
+	}
+}
+
+double GetSecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Whether the batch output holds the turns of every position, in generator order.
+bool IsOutputExact(const std::vector<Position>& positions, const std::vector<PackedMove>& turns,
+	const std::vector<TurnRange>& ranges)
+{
+	MoveList expectedTurns;
+	for (size_t i = 0; i < positions.size(); ++i)
+	{
+		expectedTurns.Clear();
+		MoveGenerator::GenerateTurns(positions[i], expectedTurns);
+		if (ranges[i].m_count != static_cast<uint32_t>(expectedTurns.GetSize()))
+			return false;
+
+		for (int j = 0; j < expectedTurns.GetSize(); ++j)
+		{
+			if (turns[ranges[i].m_offset + j] != expectedTurns[j])
+				return false;
+		}
+	}
+
+	return true;
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+	MoveGenBenchOptions options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	std::vector<Position> positions;
+	CollectPositions(options, positions);
+
+	// A plain loop over the positions, for comparison.
+	auto startTime = std::chrono::steady_clock::now();
+	uint64_t turnCount = 0;
+	MoveList turns;
+	for (int pass = 0; pass < options.m_passCount; ++pass)
+	{
+		turnCount = 0;
+		for (const Position& position : positions)
+		{
+			turns.Clear();
+			MoveGenerator::GenerateTurns(position, turns);
+			turnCount += turns.GetSize();
+		}
+	}
+
+	double seconds = GetSecondsSince(startTime);
+	double positionCount = static_cast<double>(positions.size()) * options.m_passCount;
+	std::printf("%d positions, %llu turns, %d passes\n", static_cast<int>(positions.size()),
+		static_cast<unsigned long long>(turnCount), options.m_passCount);
+	std::printf("threads   positions/sec  speedup\n");
+	std::printf("   loop  %14.0f    1.00x\n", seconds > 0.0 ? positionCount / seconds : 0.0);
+	double loopSeconds = seconds;
+
+	std::vector<PackedMove> batchTurns(turnCount);
+	std::vector<TurnRange> ranges(positions.size());
+	for (int threadCount = 1; threadCount <= options.m_maxThreadCount; threadCount *= 2)
+	{
+		BatchMoveGenerator generator(threadCount);
+
+		uint64_t batchTurnCount = 0;
+		startTime = std::chrono::steady_clock::now();
+		for (int pass = 0; pass < options.m_passCount; ++pass)
+		{
+			generator.Generate(positions.data(), positions.size(), batchTurns.data(), batchTurns.size(), ranges.data(),
+				batchTurnCount);
+		}
+
+		seconds = GetSecondsSince(startTime);
+		if (batchTurnCount != turnCount || !IsOutputExact(positions, batchTurns, ranges))
+		{
+			std::printf("%7d  the turns differ from MoveGenerator::GenerateTurns\n", threadCount);
+			return 1;
+		}
+
+		std::printf("%7d  %14.0f  %6.2fx\n", threadCount, seconds > 0.0 ? positionCount / seconds : 0.0,
+			seconds > 0.0 ? loopSeconds / seconds : 0.0);
+	}
+
+	return 0;
+}
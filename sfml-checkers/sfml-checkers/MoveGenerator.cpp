@@ -0,0 +1,304 @@
+//---------------------------------------------------------------
+//
+// MoveGenerator.cpp
+//
+
+#include "MoveGenerator.h"
+
+namespace {
+
+//==============================================================================
+
+// White player will move South
+const int s_south = 1;
+
+// Black player moves North.
+const int s_north = -1;
+
+// These are the same for both Black and White players.
+const int s_west = -1;
+const int s_east = 1;
+
+// Squares on rows 0, 2, 4, 6 (odd columns) and on rows 1, 3, 5, 7 (even columns).
+const Bitboard s_evenRows = 0x0F0F0F0F;
+const Bitboard s_oddRows = 0xF0F0F0F0;
+
+// The first and last playable square of every row.
+const Bitboard s_leftEdge = 0x11111111;
+const Bitboard s_rightEdge = 0x88888888;
+
+// Moving one step diagonally is a shift of the square number whose size depends only on the parity
+// of the source row, so every direction is two masked shifts. Squares that would leave the board
+// sideways are masked out beforehand, squares leaving through the top or bottom are shifted out.
+// Two steps in the same direction always add up to the same shift, which is what jumps use.
+template <int VerticalDirection, int HorizontalDirection>
+struct Direction
+{
+	static const int s_evenRowShift = VerticalDirection * s_squaresPerRow + (HorizontalDirection > 0 ? 1 : 0);
+	static const int s_oddRowShift = VerticalDirection * s_squaresPerRow - (HorizontalDirection < 0 ? 1 : 0);
+	static const int s_jumpShift = 2 * VerticalDirection * s_squaresPerRow + HorizontalDirection;
+
+	static const Bitboard s_evenRowSources = HorizontalDirection > 0 ? s_evenRows & ~s_rightEdge : s_evenRows;
+	static const Bitboard s_oddRowSources = HorizontalDirection < 0 ? s_oddRows & ~s_leftEdge : s_oddRows;
+};
+
+typedef Direction<s_south, s_east> SouthEast;
+typedef Direction<s_south, s_west> SouthWest;
+typedef Direction<s_north, s_east> NorthEast;
+typedef Direction<s_north, s_west> NorthWest;
+
+template <int Shift>
+inline Bitboard ShiftSquares(Bitboard squares)
+{
+	if constexpr (Shift > 0)
+		return squares << Shift;
+	else
+		return squares >> -Shift;
+}
+
+// Moves every square one step in the given direction.
+template <class Dir>
+inline Bitboard Step(Bitboard squares)
+{
+	return ShiftSquares<Dir::s_evenRowShift>(squares & Dir::s_evenRowSources)
+		| ShiftSquares<Dir::s_oddRowShift>(squares & Dir::s_oddRowSources);
+}
+
+// Emits a move for every destination, recovering each source by undoing the shift.
+inline void AddMoves(Bitboard destinations, int shift, MoveList& movesOut)
+{
+	for (; destinations; destinations &= destinations - 1)
+	{
+		int destination = GetLowestSquare(destinations);
+		movesOut.Add(PackedMove(destination - shift, destination, 0));
+	}
+}
+
+template <class Dir>
+inline void AddMovesForDirection(Bitboard movers, Bitboard empty, MoveList& movesOut)
+{
+	AddMoves(ShiftSquares<Dir::s_evenRowShift>(movers & Dir::s_evenRowSources) & empty,
+		Dir::s_evenRowShift, movesOut);
+	AddMoves(ShiftSquares<Dir::s_oddRowShift>(movers & Dir::s_oddRowSources) & empty,
+		Dir::s_oddRowShift, movesOut);
+}
+
+template <class Dir>
+inline void AddJumpsForDirection(Bitboard jumpers, Bitboard enemies, Bitboard empty, MoveList& jumpsOut)
+{
+	// Land on an empty square right behind an enemy piece. The captured piece is one step from the
+	// source.
+	for (Bitboard destinations = Step<Dir>(Step<Dir>(jumpers) & enemies) & empty; destinations;
+		destinations &= destinations - 1)
+	{
+		int destination = GetLowestSquare(destinations);
+		int source = destination - Dir::s_jumpShift;
+		jumpsOut.Add(PackedMove(source, destination, Step<Dir>(SquareMask(source))));
+	}
+}
+
+// Returns the squares of the jumpers that have a jump in the given direction.
+template <class Dir>
+inline Bitboard GetJumpersForDirection(Bitboard jumpers, Bitboard enemies, Bitboard empty)
+{
+	return ShiftSquares<-Dir::s_jumpShift>(Step<Dir>(Step<Dir>(jumpers) & enemies) & empty);
+}
+
+// The state of a capture sequence that does not change from hop to hop.
+struct CaptureChain
+{
+	int m_source;
+	Bitboard m_enemies;
+
+	// Empty squares, including the source the piece left.
+	Bitboard m_empty;
+
+	// Rows a man is crowned on, empty for a king. Crowning ends the turn.
+	Bitboard m_crownRow;
+
+	bool m_canMoveSouth;
+	bool m_canMoveNorth;
+};
+
+void AddCaptureSequences(const CaptureChain& chain, int square, Bitboard captured, MoveList& capturesOut);
+
+// Takes the jump in the given direction from the square if there is one, and follows the chain on
+// from its landing square. Returns whether there was a jump. Pieces are captured once each.
+template <class Dir>
+inline bool ContinueCapture(const CaptureChain& chain, int square, Bitboard captured, MoveList& capturesOut)
+{
+	Bitboard jumped = Step<Dir>(SquareMask(square)) & chain.m_enemies & ~captured;
+	Bitboard landing = Step<Dir>(jumped) & chain.m_empty;
+	if (!landing)
+		return false;
+
+	if (landing & chain.m_crownRow)
+		capturesOut.Add(PackedMove(chain.m_source, GetLowestSquare(landing), captured | jumped));
+	else
+		AddCaptureSequences(chain, GetLowestSquare(landing), captured | jumped, capturesOut);
+
+	return true;
+}
+
+void AddCaptureSequences(const CaptureChain& chain, int square, Bitboard captured, MoveList& capturesOut)
+{
+	bool hasJumped = false;
+	if (chain.m_canMoveSouth)
+	{
+		hasJumped |= ContinueCapture<SouthEast>(chain, square, captured, capturesOut);
+		hasJumped |= ContinueCapture<SouthWest>(chain, square, captured, capturesOut);
+	}
+
+	if (chain.m_canMoveNorth)
+	{
+		hasJumped |= ContinueCapture<NorthEast>(chain, square, captured, capturesOut);
+		hasJumped |= ContinueCapture<NorthWest>(chain, square, captured, capturesOut);
+	}
+
+	// The chain ends where no further jump is possible.
+	if (!hasJumped && captured)
+		capturesOut.Add(PackedMove(chain.m_source, square, captured));
+}
+
+// Walks the capture sequences of the turn looking for one that matches it, recording the squares.
+bool FindCapturePath(const Position& position, int square, const PackedMove& turn, Bitboard captured,
+	std::vector<int>& pathOut)
+{
+	pathOut.push_back(square);
+	if (square == turn.GetDestination() && captured == turn.GetCapturedPieces())
+		return true;
+
+	MoveList jumps;
+	MoveGenerator::GenerateJumps(position, SquareMask(square), jumps);
+	for (const PackedMove& jump : jumps)
+	{
+		if (!(jump.GetCapturedPieces() & turn.GetCapturedPieces()))
+			continue;
+
+		Position next = position;
+		UndoRecord undo;
+		next.MakeMove(jump.GetSource(), jump.GetDestination(), jump.GetCapturedPieces(), undo, false);
+		if (undo.m_isCrowned && (jump.GetDestination() != turn.GetDestination()
+			|| (captured | jump.GetCapturedPieces()) != turn.GetCapturedPieces()))
+		{
+			continue;
+		}
+
+		if (FindCapturePath(next, jump.GetDestination(), turn, captured | jump.GetCapturedPieces(), pathOut))
+			return true;
+	}
+
+	pathOut.pop_back();
+	return false;
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+void MoveGenerator::GenerateMoves(const Position& position, MoveList& movesOut)
+{
+	Bitboard pieces = position.GetPlayerPieces();
+	Bitboard kings = pieces & position.m_kings;
+	Bitboard empty = position.GetEmpty();
+
+	// Men only move forward, kings move both ways.
+	Bitboard southMovers = position.m_isWhitePlayerTurn ? pieces : kings;
+	Bitboard northMovers = position.m_isWhitePlayerTurn ? kings : pieces;
+
+	AddMovesForDirection<SouthEast>(southMovers, empty, movesOut);
+	AddMovesForDirection<SouthWest>(southMovers, empty, movesOut);
+	AddMovesForDirection<NorthEast>(northMovers, empty, movesOut);
+	AddMovesForDirection<NorthWest>(northMovers, empty, movesOut);
+}
+
+void MoveGenerator::GenerateJumps(const Position& position, Bitboard sources, MoveList& jumpsOut)
+{
+	Bitboard pieces = position.GetPlayerPieces() & sources;
+	Bitboard kings = pieces & position.m_kings;
+	Bitboard enemies = position.GetEnemyPieces();
+	Bitboard empty = position.GetEmpty();
+
+	Bitboard southJumpers = position.m_isWhitePlayerTurn ? pieces : kings;
+	Bitboard northJumpers = position.m_isWhitePlayerTurn ? kings : pieces;
+
+	AddJumpsForDirection<SouthEast>(southJumpers, enemies, empty, jumpsOut);
+	AddJumpsForDirection<SouthWest>(southJumpers, enemies, empty, jumpsOut);
+	AddJumpsForDirection<NorthEast>(northJumpers, enemies, empty, jumpsOut);
+	AddJumpsForDirection<NorthWest>(northJumpers, enemies, empty, jumpsOut);
+}
+
+Bitboard MoveGenerator::GetJumpers(const Position& position)
+{
+	Bitboard pieces = position.GetPlayerPieces();
+	Bitboard kings = pieces & position.m_kings;
+	Bitboard enemies = position.GetEnemyPieces();
+	Bitboard empty = position.GetEmpty();
+
+	Bitboard southJumpers = position.m_isWhitePlayerTurn ? pieces : kings;
+	Bitboard northJumpers = position.m_isWhitePlayerTurn ? kings : pieces;
+
+	return GetJumpersForDirection<SouthEast>(southJumpers, enemies, empty)
+		| GetJumpersForDirection<SouthWest>(southJumpers, enemies, empty)
+		| GetJumpersForDirection<NorthEast>(northJumpers, enemies, empty)
+		| GetJumpersForDirection<NorthWest>(northJumpers, enemies, empty);
+}
+
+void MoveGenerator::GenerateCaptures(const Position& position, MoveList& capturesOut)
+{
+	// Only pieces with a first jump can start a chain, find them all at once before walking any.
+	Bitboard enemies = position.GetEnemyPieces();
+	Bitboard empty = position.GetEmpty();
+	Bitboard jumpers = GetJumpers(position);
+
+	Bitboard crownRow = position.m_isWhitePlayerTurn ? s_bottomRow : s_topRow;
+	for (; jumpers; jumpers &= jumpers - 1)
+	{
+		int source = GetLowestSquare(jumpers);
+		bool isKing = (position.m_kings & SquareMask(source)) != 0;
+
+		CaptureChain chain;
+		chain.m_source = source;
+		chain.m_enemies = enemies;
+		chain.m_empty = empty | SquareMask(source);
+		chain.m_crownRow = isKing ? 0 : crownRow;
+		chain.m_canMoveSouth = isKing || position.m_isWhitePlayerTurn;
+		chain.m_canMoveNorth = isKing || !position.m_isWhitePlayerTurn;
+
+		AddCaptureSequences(chain, source, 0, capturesOut);
+	}
+}
+
+void MoveGenerator::GenerateTurns(const Position& position, MoveList& turnsOut)
+{
+	GenerateCaptures(position, turnsOut);
+	if (turnsOut.IsEmpty())
+		GenerateMoves(position, turnsOut);
+}
+
+std::vector<int> MoveGenerator::GetPath(const Position& position, const PackedMove& turn)
+{
+	std::vector<int> path;
+	if (!turn.IsCapture())
+	{
+		path.push_back(turn.GetSource());
+		path.push_back(turn.GetDestination());
+		return path;
+	}
+
+	FindCapturePath(position, turn.GetSource(), turn, 0, path);
+	return path;
+}
+
+std::string MoveGenerator::GetNotation(const Position& position, const PackedMove& turn)
+{
+	std::string notation;
+	for (int square : GetPath(position, turn))
+	{
+		if (!notation.empty())
+			notation += turn.IsCapture() ? "x" : "-";
+		notation += std::to_string(square + 1);
+	}
+
+	return notation;
+}
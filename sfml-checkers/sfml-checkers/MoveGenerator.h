@@ -0,0 +1,48 @@
+//---------------------------------------------------------------
+//
+// MoveGenerator.h
+//
+
+#pragma once
+
+#include "MoveList.h"
+#include "Position.h"
+
+#include <string>
+#include <vector>
+
+namespace MoveGenerator {
+
+//==============================================================================
+
+// Appends every quiet (non capturing) move available to the side to move.
+void GenerateMoves(const Position& position, MoveList& movesOut);
+
+// Appends every single jump available to the pieces of the side to move on the given squares.
+// Each one captures the piece it jumps over.
+void GenerateJumps(const Position& position, Bitboard sources, MoveList& jumpsOut);
+
+// Returns the squares of the pieces of the side to move that have a jump. Any of them makes
+// capturing mandatory.
+Bitboard GetJumpers(const Position& position);
+
+// Appends every complete capture sequence of the side to move as one move from the first source to
+// the last destination, with every piece captured on the way. A chain that can be taken along
+// different paths is emitted once per path.
+void GenerateCaptures(const Position& position, MoveList& capturesOut);
+
+// Appends every legal turn of the side to move: the complete captures if there are any, since
+// capturing is mandatory, and the quiet moves otherwise.
+void GenerateTurns(const Position& position, MoveList& turnsOut);
+
+// Returns the squares the piece visits during a turn generated for the position, starting with its
+// source. Used to show or write down a turn, not while searching.
+std::vector<int> GetPath(const Position& position, const PackedMove& turn);
+
+// Standard notation of a turn generated for the position, "11-15" for a move and "9x18x27" for a
+// capture.
+std::string GetNotation(const Position& position, const PackedMove& turn);
+
+//==============================================================================
+
+} // namespace MoveGenerator
@@ -0,0 +1,75 @@
+//---------------------------------------------------------------
+//
+// MoveList.h
+//
+
+#pragma once
+
+#include "Position.h"
+
+#include <assert.h>
+#include <cstdint>
+
+namespace {
+	// More moves than any position has: at most 12 pieces, none with more than 4 steps or jumps.
+	const int s_maxMoveCount = 64;
+}
+
+// A move or a single hop of a capture packed into one word. The source square is in bits 0-4, the
+// destination in bits 5-9 and the captured pieces in the upper 32 bits.
+struct PackedMove
+{
+	// Left uninitialized, so a move list costs nothing to create.
+	PackedMove()
+	{
+	}
+
+	PackedMove(int source, int destination, Bitboard capturedPieces)
+		: m_data(static_cast<uint64_t>(source) | static_cast<uint64_t>(destination) << 5
+			| static_cast<uint64_t>(capturedPieces) << 32)
+	{
+	}
+
+	int GetSource() const { return static_cast<int>(m_data & 0x1F); }
+	int GetDestination() const { return static_cast<int>((m_data >> 5) & 0x1F); }
+	Bitboard GetCapturedPieces() const { return static_cast<Bitboard>(m_data >> 32); }
+	bool IsCapture() const { return GetCapturedPieces() != 0; }
+
+	bool operator==(const PackedMove& other) const { return m_data == other.m_data; }
+	bool operator!=(const PackedMove& other) const { return m_data != other.m_data; }
+
+	uint64_t m_data;
+};
+
+//---------------------------------------------------------------
+
+// Fixed-capacity list of moves. It lives wherever its owner does, on the stack or inline in another
+// object, and never allocates.
+class MoveList
+{
+public:
+	MoveList()
+		: m_size(0)
+	{
+	}
+
+	void Add(const PackedMove& move)
+	{
+		assert(m_size < s_maxMoveCount);
+		m_moves[m_size++] = move;
+	}
+
+	void Clear() { m_size = 0; }
+
+	int GetSize() const { return m_size; }
+	bool IsEmpty() const { return m_size == 0; }
+
+	const PackedMove& operator[](int index) const { return m_moves[index]; }
+
+	const PackedMove* begin() const { return m_moves; }
+	const PackedMove* end() const { return m_moves + m_size; }
+
+private:
+	PackedMove m_moves[s_maxMoveCount];
+	int m_size;
+};
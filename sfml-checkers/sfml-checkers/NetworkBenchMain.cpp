@@ -0,0 +1,257 @@
+//---------------------------------------------------------------
+//
+// NetworkBenchMain.cpp
+//
+// Network evaluation benchmark. Plays random games, checks that accumulators updated move by move
+// equal ones summed from scratch and that every kernel scores exactly as the scalar code does, and
+// reports the positions per second of the hand written evaluation and of the network, refreshed for
+// every position and updated along the games as the search does.
+//
+// usage: network-bench [--network <file>] [--positions <count>] [--passes <count>] [--seed <seed>]
+//                      [--write <file>]
+//
+
+#include "Evaluation.h"
+#include "Game.h"
+#include "MoveGenerator.h"
+#include "NeuralNetwork.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+//==============================================================================
+
+const int s_defaultPositionCount = 1000000;
+const int s_defaultPassCount = 5;
+
+// Random games are cut off after this many turns.
+const int s_maxGameTurns = 200;
+
+struct NetworkBenchOptions
+{
+	NetworkBenchOptions()
+		: m_positionCount(s_defaultPositionCount)
+		, m_passCount(s_defaultPassCount)
+		, m_seed(1)
+	{
+	}
+
+	std::string m_networkPath;
+	std::string m_writePath;
+	int m_positionCount;
+	int m_passCount;
+	uint64_t m_seed;
+};
+
+void PrintUsage()
+{
+	std::printf("usage: network-bench [--network <file>] [--positions <count>] [--passes <count>] [--seed <seed>]\n"
+		"                     [--write <file>]\n"
+		"  --network    weights to evaluate with, random weights from the seed without one\n"
+		"  --positions  positions to evaluate, defaults to %d\n"
+		"  --passes     times every position is evaluated, defaults to %d\n"
+		"  --seed       seed of the random games and of random weights\n"
+		"  --write      writes the weights used to the file\n",
+		s_defaultPositionCount, s_defaultPassCount);
+}
+
+bool ParseOptions(int argc, char** argv, NetworkBenchOptions& optionsOut)
+{
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string argument(argv[i]);
+		std::string value(argv[i + 1]);
+
+		if (argument == "--network")
+			optionsOut.m_networkPath = value;
+		else if (argument == "--positions")
+			optionsOut.m_positionCount = std::atoi(value.c_str());
+		else if (argument == "--passes")
+			optionsOut.m_passCount = std::atoi(value.c_str());
+		else if (argument == "--seed")
+			optionsOut.m_seed = std::strtoull(value.c_str(), nullptr, 10);
+		else if (argument == "--write")
+			optionsOut.m_writePath = value;
+		else
+			return false;
+	}
+
+	return (argc % 2) == 1 && optionsOut.m_positionCount > 0 && optionsOut.m_passCount > 0;
+}
+
+// Every position of random games played through Game, until there are enough. Each position
+// follows the one before it by a turn, unless it starts a game.
+void CollectPositions(const NetworkBenchOptions& options, std::vector<Position>& positionsOut,
+	std::vector<bool>& isGameStartOut)
+{
+	std::mt19937_64 random(options.m_seed);
+	MoveList turns;
+	while (static_cast<int>(positionsOut.size()) < options.m_positionCount)
+	{
+		Game game;
+		for (int turn = 0; turn < s_maxGameTurns && static_cast<int>(positionsOut.size()) < options.m_positionCount;
+			++turn)
+		{
+			positionsOut.push_back(game.GetPosition());
+			isGameStartOut.push_back(turn == 0);
+
+			turns.Clear();
+			MoveGenerator::GenerateTurns(game.GetPosition(), turns);
+			if (turns.IsEmpty())
+				break;
+
+			game.PlayMove(turns[static_cast<int>(random() % turns.GetSize())]);
+		}
+	}
+}
+
+double GetSecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void PrintRate(const char* name, uint64_t evaluationCount, double seconds, double baseRate, int64_t checksum)
+{
+	double rate = seconds > 0.0 ? evaluationCount / seconds : 0.0;
+	std::printf("%-18s %12.0f positions/sec  %5.2fx  (checksum %lld)\n", name, rate,
+		baseRate > 0.0 ? rate / baseRate : 1.0, static_cast<long long>(checksum));
+}
+
+// Walks the games with the network's kernel, updating the accumulator turn by turn, and counts the
+// positions whose accumulator or score differs from the scalar reference.
+size_t CountMismatches(const NeuralNetwork& network, const NeuralNetwork& reference,
+	const std::vector<Position>& positions, const std::vector<bool>& isGameStart)
+{
+	size_t mismatchCount = 0;
+	NetworkAccumulator accumulators[2];
+	NetworkAccumulator expectedAccumulator;
+	for (size_t i = 0; i < positions.size(); ++i)
+	{
+		NetworkAccumulator& accumulator = accumulators[i % 2];
+		if (isGameStart[i])
+			network.RefreshAccumulator(positions[i], accumulator);
+		else
+			network.UpdateAccumulator(accumulators[(i + 1) % 2], positions[i - 1], positions[i], accumulator);
+
+		reference.RefreshAccumulator(positions[i], expectedAccumulator);
+		if (std::memcmp(accumulator.m_values, expectedAccumulator.m_values, sizeof(accumulator.m_values)) != 0
+			|| network.Evaluate(accumulator, positions[i].m_isWhitePlayerTurn) != reference.Evaluate(positions[i]))
+		{
+			++mismatchCount;
+		}
+	}
+
+	return mismatchCount;
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+	NetworkBenchOptions options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	// Too large for the stack.
+	std::unique_ptr<NeuralNetwork> network(new NeuralNetwork());
+	if (options.m_networkPath.empty())
+		network->Randomize(options.m_seed);
+	else if (!network->Load(options.m_networkPath))
+		return 1;
+
+	if (!options.m_writePath.empty() && !network->Write(options.m_writePath))
+		return 1;
+
+	std::unique_ptr<NeuralNetwork> reference(new NeuralNetwork(*network));
+	reference->SetKernel(KERNEL_SCALAR);
+
+	std::vector<Position> positions;
+	std::vector<bool> isGameStart;
+	CollectPositions(options, positions, isGameStart);
+
+	std::printf("%d positions, %d passes\n", static_cast<int>(positions.size()), options.m_passCount);
+	uint64_t evaluationCount = static_cast<uint64_t>(positions.size()) * options.m_passCount;
+
+	auto startTime = std::chrono::steady_clock::now();
+	int64_t checksum = 0;
+	for (int pass = 0; pass < options.m_passCount; ++pass)
+	{
+		for (const Position& position : positions)
+		{
+			checksum += Evaluation::Evaluate(position);
+		}
+	}
+
+	double handWrittenSeconds = GetSecondsSince(startTime);
+	double handWrittenRate = handWrittenSeconds > 0.0 ? evaluationCount / handWrittenSeconds : 0.0;
+	PrintRate("hand written", evaluationCount, handWrittenSeconds, 0.0, checksum);
+
+	bool isEveryKernelExact = true;
+	const EvaluationKernel kernels[] = { KERNEL_SCALAR, KERNEL_AVX2 };
+	for (EvaluationKernel kernel : kernels)
+	{
+		std::string name = std::string(Evaluation::GetKernelName(kernel));
+		if (!network->SetKernel(kernel))
+		{
+			std::printf("%-18s not supported\n", name.c_str());
+			continue;
+		}
+
+		size_t mismatchCount = CountMismatches(*network, *reference, positions, isGameStart);
+		if (mismatchCount != 0)
+		{
+			std::printf("%-18s %llu positions differ from the scalar accumulator or score\n", name.c_str(),
+				static_cast<unsigned long long>(mismatchCount));
+			isEveryKernelExact = false;
+			continue;
+		}
+
+		startTime = std::chrono::steady_clock::now();
+		checksum = 0;
+		for (int pass = 0; pass < options.m_passCount; ++pass)
+		{
+			for (const Position& position : positions)
+			{
+				checksum += network->Evaluate(position);
+			}
+		}
+
+		PrintRate((name + " refreshed").c_str(), evaluationCount, GetSecondsSince(startTime), handWrittenRate,
+			checksum);
+
+		startTime = std::chrono::steady_clock::now();
+		checksum = 0;
+		NetworkAccumulator accumulators[2];
+		for (int pass = 0; pass < options.m_passCount; ++pass)
+		{
+			for (size_t i = 0; i < positions.size(); ++i)
+			{
+				NetworkAccumulator& accumulator = accumulators[i % 2];
+				if (isGameStart[i])
+					network->RefreshAccumulator(positions[i], accumulator);
+				else
+					network->UpdateAccumulator(accumulators[(i + 1) % 2], positions[i - 1], positions[i], accumulator);
+
+				checksum += network->Evaluate(accumulator, positions[i].m_isWhitePlayerTurn);
+			}
+		}
+
+		PrintRate((name + " updated").c_str(), evaluationCount, GetSecondsSince(startTime), handWrittenRate,
+			checksum);
+	}
+
+	return isEveryKernelExact ? 0 : 1;
+}
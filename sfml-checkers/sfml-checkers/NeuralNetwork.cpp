@@ -0,0 +1,297 @@
+//---------------------------------------------------------------
+//
+// NeuralNetwork.cpp
+//
+
+#include "NeuralNetwork.h"
+#include "Log.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+namespace {
+
+//==============================================================================
+
+const char s_magic[4] = { 'C', 'K', 'N', 'N' };
+const uint8_t s_version = 1;
+
+// Magic, version, three reserved bytes, the feature count and the hidden size.
+const size_t s_headerSize = 16;
+
+const size_t s_weightsSize = sizeof(int16_t) * s_networkFeatureCount * s_networkHiddenSize
+	+ sizeof(int16_t) * s_networkHiddenSize + sizeof(int8_t) * 2 * s_networkHiddenSize + sizeof(int32_t);
+
+// Accumulator values the scalar code sums at a time.
+const int s_scalarBlockSize = 16;
+
+// Scores stay well below the tablebase and win scores of the search, whatever the weights.
+const int s_maxScore = 10000;
+
+// Kinds of piece as white sees the board. Black sees the same pieces with the colors swapped.
+enum PieceKind
+{
+	KIND_WHITE_MAN,
+	KIND_WHITE_KING,
+	KIND_BLACK_MAN,
+	KIND_BLACK_KING,
+
+	KIND_COUNT,
+};
+
+void GetKindSquares(const Position& position, Bitboard squaresOut[KIND_COUNT])
+{
+	squaresOut[KIND_WHITE_MAN] = position.m_whitePieces & ~position.m_kings;
+	squaresOut[KIND_WHITE_KING] = position.m_whitePieces & position.m_kings;
+	squaresOut[KIND_BLACK_MAN] = position.m_blackPieces & ~position.m_kings;
+	squaresOut[KIND_BLACK_KING] = position.m_blackPieces & position.m_kings;
+}
+
+// Feature of a piece for one of the players, 0 for white and 1 for black. Black sees its own
+// pieces as the first two kinds and the board turned around.
+int GetFeature(int player, int kind, int square)
+{
+	if (player == 0)
+		return kind * s_squareCount + square;
+
+	return (kind ^ KIND_BLACK_MAN) * s_squareCount + (s_squareCount - 1 - square);
+}
+
+int32_t PropagateScalar(const int16_t* playerValues, const int16_t* opponentValues, const int8_t* outputWeights)
+{
+	int32_t sum = 0;
+	for (int i = 0; i < s_networkHiddenSize; ++i)
+	{
+		int playerValue = std::min(std::max<int>(playerValues[i], 0), s_networkActivationLimit);
+		int opponentValue = std::min(std::max<int>(opponentValues[i], 0), s_networkActivationLimit);
+		sum += playerValue * outputWeights[i] + opponentValue * outputWeights[s_networkHiddenSize + i];
+	}
+
+	return sum;
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+NeuralNetwork::NeuralNetwork()
+	: m_outputBias(0)
+	, m_kernel(Evaluation::IsKernelSupported(KERNEL_AVX2) ? KERNEL_AVX2 : KERNEL_SCALAR)
+{
+	std::memset(m_featureWeights, 0, sizeof(m_featureWeights));
+	std::memset(m_featureBiases, 0, sizeof(m_featureBiases));
+	std::memset(m_outputWeights, 0, sizeof(m_outputWeights));
+}
+
+bool NeuralNetwork::Load(const std::string& filePath)
+{
+	MappedFile file;
+	if (!file.Open(filePath, FILE_ACCESS_SEQUENTIAL))
+	{
+		LOG_ERROR(Logger::CATEGORY_SEARCH, "Cannot read the network " + filePath);
+		return false;
+	}
+
+	const uint8_t* data = file.GetData();
+	uint32_t featureCount = 0;
+	uint32_t hiddenSize = 0;
+	if (file.GetSize() >= s_headerSize)
+	{
+		std::memcpy(&featureCount, data + 8, sizeof(featureCount));
+		std::memcpy(&hiddenSize, data + 12, sizeof(hiddenSize));
+	}
+
+	if (file.GetSize() != s_headerSize + s_weightsSize || std::memcmp(data, s_magic, sizeof(s_magic)) != 0
+		|| data[4] != s_version || featureCount != s_networkFeatureCount || hiddenSize != s_networkHiddenSize)
+	{
+		LOG_ERROR(Logger::CATEGORY_SEARCH, "Not a network of this size: " + filePath);
+		return false;
+	}
+
+	data += s_headerSize;
+	std::memcpy(m_featureWeights, data, sizeof(m_featureWeights));
+	data += sizeof(m_featureWeights);
+	std::memcpy(m_featureBiases, data, sizeof(m_featureBiases));
+	data += sizeof(m_featureBiases);
+	std::memcpy(m_outputWeights, data, sizeof(m_outputWeights));
+	data += sizeof(m_outputWeights);
+	std::memcpy(&m_outputBias, data, sizeof(m_outputBias));
+	return true;
+}
+
+bool NeuralNetwork::Write(const std::string& filePath) const
+{
+	AtomicFileWriter file;
+	if (!file.Open(filePath))
+	{
+		LOG_ERROR(Logger::CATEGORY_SEARCH, "Cannot write the network " + filePath);
+		return false;
+	}
+
+	uint8_t header[s_headerSize] = {};
+	std::memcpy(header, s_magic, sizeof(s_magic));
+	header[4] = s_version;
+	uint32_t featureCount = s_networkFeatureCount;
+	uint32_t hiddenSize = s_networkHiddenSize;
+	std::memcpy(header + 8, &featureCount, sizeof(featureCount));
+	std::memcpy(header + 12, &hiddenSize, sizeof(hiddenSize));
+
+	file.Write(header, s_headerSize);
+	file.Write(m_featureWeights, sizeof(m_featureWeights));
+	file.Write(m_featureBiases, sizeof(m_featureBiases));
+	file.Write(m_outputWeights, sizeof(m_outputWeights));
+	file.Write(&m_outputBias, sizeof(m_outputBias));
+	if (!file.Commit())
+	{
+		LOG_ERROR(Logger::CATEGORY_SEARCH, "Cannot write the network " + filePath);
+		return false;
+	}
+
+	return true;
+}
+
+void NeuralNetwork::Randomize(uint64_t seed)
+{
+	std::mt19937_64 random(seed);
+	std::uniform_int_distribution<int> featureWeight(-16, 16);
+	std::uniform_int_distribution<int> featureBias(0, 32);
+	std::uniform_int_distribution<int> outputWeight(-32, 32);
+
+	for (int16_t(&row)[s_networkHiddenSize] : m_featureWeights)
+	{
+		for (int16_t& weight : row)
+			weight = static_cast<int16_t>(featureWeight(random));
+	}
+
+	for (int16_t& bias : m_featureBiases)
+		bias = static_cast<int16_t>(featureBias(random));
+
+	for (int8_t& weight : m_outputWeights)
+		weight = static_cast<int8_t>(outputWeight(random));
+
+	m_outputBias = 0;
+}
+
+bool NeuralNetwork::SetKernel(EvaluationKernel kernel)
+{
+	if ((kernel != KERNEL_SCALAR && kernel != KERNEL_AVX2) || !Evaluation::IsKernelSupported(kernel)
+		|| (kernel == KERNEL_AVX2 && !NeuralNetworkKernels::HasAvx2()))
+	{
+		return false;
+	}
+
+	m_kernel = kernel;
+	return true;
+}
+
+void NeuralNetwork::RefreshAccumulator(const Position& position, NetworkAccumulator& accumulatorOut) const
+{
+	Bitboard kindSquares[KIND_COUNT];
+	GetKindSquares(position, kindSquares);
+
+	for (int player = 0; player < 2; ++player)
+	{
+		const int16_t* rows[s_squareCount];
+		int rowCount = 0;
+		for (int kind = 0; kind < KIND_COUNT; ++kind)
+		{
+			for (Bitboard squares = kindSquares[kind]; squares; squares &= squares - 1)
+			{
+				rows[rowCount++] = m_featureWeights[GetFeature(player, kind, GetLowestSquare(squares))];
+			}
+		}
+
+		ApplyRows(m_featureBiases, rows, rowCount, nullptr, 0, accumulatorOut.m_values[player]);
+	}
+}
+
+void NeuralNetwork::UpdateAccumulator(const NetworkAccumulator& parent, const Position& parentPosition,
+	const Position& position, NetworkAccumulator& accumulatorOut) const
+{
+	// The source square and the captured pieces lose their piece, the destination gains one, and a
+	// crowned man is a man gone and a king arrived on the same square.
+	Bitboard parentSquares[KIND_COUNT];
+	Bitboard squares[KIND_COUNT];
+	GetKindSquares(parentPosition, parentSquares);
+	GetKindSquares(position, squares);
+
+	for (int player = 0; player < 2; ++player)
+	{
+		const int16_t* addedRows[s_squareCount];
+		const int16_t* removedRows[s_squareCount];
+		int addedCount = 0;
+		int removedCount = 0;
+		for (int kind = 0; kind < KIND_COUNT; ++kind)
+		{
+			for (Bitboard added = squares[kind] & ~parentSquares[kind]; added; added &= added - 1)
+			{
+				addedRows[addedCount++] = m_featureWeights[GetFeature(player, kind, GetLowestSquare(added))];
+			}
+
+			for (Bitboard removed = parentSquares[kind] & ~squares[kind]; removed; removed &= removed - 1)
+			{
+				removedRows[removedCount++] = m_featureWeights[GetFeature(player, kind, GetLowestSquare(removed))];
+			}
+		}
+
+		ApplyRows(parent.m_values[player], addedRows, addedCount, removedRows, removedCount,
+			accumulatorOut.m_values[player]);
+	}
+}
+
+int NeuralNetwork::Evaluate(const NetworkAccumulator& accumulator, bool isWhitePlayerTurn) const
+{
+	const int16_t* playerValues = accumulator.m_values[isWhitePlayerTurn ? 0 : 1];
+	const int16_t* opponentValues = accumulator.m_values[isWhitePlayerTurn ? 1 : 0];
+
+	int32_t output = m_kernel == KERNEL_AVX2
+		? NeuralNetworkKernels::PropagateAvx2(playerValues, opponentValues, m_outputWeights)
+		: PropagateScalar(playerValues, opponentValues, m_outputWeights);
+
+	int score = (output + m_outputBias) / s_networkOutputScale;
+	return std::min(std::max(score, -s_maxScore), s_maxScore);
+}
+
+int NeuralNetwork::Evaluate(const Position& position) const
+{
+	NetworkAccumulator accumulator;
+	RefreshAccumulator(position, accumulator);
+	return Evaluate(accumulator, position.m_isWhitePlayerTurn);
+}
+
+void NeuralNetwork::ApplyRows(const int16_t* parent, const int16_t* const* addedRows, int addedCount,
+	const int16_t* const* removedRows, int removedCount, int16_t* accumulatorOut) const
+{
+	if (m_kernel == KERNEL_AVX2)
+	{
+		NeuralNetworkKernels::UpdateAccumulatorAvx2(parent, addedRows, addedCount, removedRows, removedCount,
+			accumulatorOut);
+		return;
+	}
+
+	// A block at a time through every row, so the block stays in registers. Sums wrap around in 16
+	// bits exactly like the SIMD additions do.
+	for (int i = 0; i < s_networkHiddenSize; i += s_scalarBlockSize)
+	{
+		uint16_t values[s_scalarBlockSize];
+		for (int j = 0; j < s_scalarBlockSize; ++j)
+			values[j] = static_cast<uint16_t>(parent[i + j]);
+
+		for (int row = 0; row < addedCount; ++row)
+		{
+			for (int j = 0; j < s_scalarBlockSize; ++j)
+				values[j] = static_cast<uint16_t>(values[j] + static_cast<uint16_t>(addedRows[row][i + j]));
+		}
+
+		for (int row = 0; row < removedCount; ++row)
+		{
+			for (int j = 0; j < s_scalarBlockSize; ++j)
+				values[j] = static_cast<uint16_t>(values[j] - static_cast<uint16_t>(removedRows[row][i + j]));
+		}
+
+		for (int j = 0; j < s_scalarBlockSize; ++j)
+			accumulatorOut[i + j] = static_cast<int16_t>(values[j]);
+	}
+}
@@ -0,0 +1,87 @@
+//---------------------------------------------------------------
+//
+// NeuralNetwork.h
+//
+
+#pragma once
+
+#include "Evaluation.h"
+#include "NeuralNetworkKernels.h"
+#include "Position.h"
+
+#include <cstdint>
+#include <string>
+
+namespace {
+	// The output of the network divided by this is the score.
+	const int s_networkOutputScale = 64;
+}
+
+// First layer values of a position, one half as white sees the board and one as black does. Kept
+// per ply by the search and carried from parent to child by UpdateAccumulator.
+struct NetworkAccumulator
+{
+	alignas(32) int16_t m_values[2][s_networkHiddenSize];
+};
+
+// A small quantized network in the style of NNUE. Each player sees the board from its own side:
+// its men and kings, the opponent's men and kings, the squares turned around for black. A feature
+// is a piece kind on a square, and the first layer sums the 16 bit weight rows of the features
+// present, plus the biases, into the player's half of the accumulator. The output layer clips
+// both halves to [0, 127], the side to move's first, and dots them with 8 bit weights.
+//
+// A move changes at most a handful of features, so the search updates the accumulator from the
+// parent's with only the rows of the squares that changed instead of summing it again. Everything
+// is integer arithmetic, the AVX2 kernel and the scalar code give exactly the same scores.
+//
+// The weights come from a file written by a trainer: a 16 byte header ("CKNN", a version byte,
+// three reserved bytes, the feature count and the hidden size as 32 bit values), then, little
+// endian, the feature weights row by row, the feature biases, the output weights and the output
+// bias. The score is the output divided by s_networkOutputScale.
+class NeuralNetwork
+{
+public:
+	NeuralNetwork();
+
+	// Reads the weights. Returns false and keeps the current ones if the file is missing or is not
+	// a network of this size.
+	bool Load(const std::string& filePath);
+
+	// Writes the weights in the format Load reads, to a temporary file renamed once complete.
+	bool Write(const std::string& filePath) const;
+
+	// Small random weights, for benchmarks and as a starting point for training.
+	void Randomize(uint64_t seed);
+
+	// Picks the kernel for accumulator updates and the output layer, the fastest supported one
+	// unless set. Only the scalar and AVX2 kernels exist here, returns false for any other or one
+	// the processor does not support.
+	bool SetKernel(EvaluationKernel kernel);
+	EvaluationKernel GetKernel() const { return m_kernel; }
+
+	// Sums the accumulator of the position from scratch.
+	void RefreshAccumulator(const Position& position, NetworkAccumulator& accumulatorOut) const;
+
+	// The accumulator of a position one move after the parent's, from the squares that changed.
+	void UpdateAccumulator(const NetworkAccumulator& parent, const Position& parentPosition,
+		const Position& position, NetworkAccumulator& accumulatorOut) const;
+
+	// Score from the point of view of the side to move, in the units of Evaluation::Evaluate.
+	int Evaluate(const NetworkAccumulator& accumulator, bool isWhitePlayerTurn) const;
+
+	// Refreshes an accumulator and evaluates it.
+	int Evaluate(const Position& position) const;
+
+private:
+	void ApplyRows(const int16_t* parent, const int16_t* const* addedRows, int addedCount,
+		const int16_t* const* removedRows, int removedCount, int16_t* accumulatorOut) const;
+
+	alignas(32) int16_t m_featureWeights[s_networkFeatureCount][s_networkHiddenSize];
+	alignas(32) int16_t m_featureBiases[s_networkHiddenSize];
+
+	// The side to move's half of the accumulator is dotted with the first half.
+	alignas(32) int8_t m_outputWeights[2 * s_networkHiddenSize];
+	int32_t m_outputBias;
+
+	EvaluationKernel m_kernel;
+};
@@ -0,0 +1,122 @@
+//---------------------------------------------------------------
+//
+// NeuralNetworkAvx2.cpp
+//
+// Accumulator updates sixteen values and the output layer thirty-two values at a time. Built with
+// AVX2 enabled, only called once the processor is known to have it.
+//
+
+#include "NeuralNetworkKernels.h"
+
+#if defined(__AVX2__)
+#define CHECKERS_HAS_AVX2_KERNEL
+#include <immintrin.h>
+#endif
+
+#if defined(CHECKERS_HAS_AVX2_KERNEL)
+
+namespace {
+
+//==============================================================================
+
+const int s_valuesPerRegister = 16;
+const int s_registerCount = s_networkHiddenSize / s_valuesPerRegister;
+
+static_assert(s_networkHiddenSize % (2 * s_valuesPerRegister) == 0, "The output layer takes two registers at a time");
+
+// Clips thirty-two accumulator values to [0, 127], dots them with their output weights and adds
+// the products to the 32 bit sums. The products of two neighbouring values fit 16 bits: at most
+// 2 * 127 * 128.
+__m256i AddClippedDotProduct(__m256i sums, const int16_t* values, const int8_t* weights)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i limit = _mm256_set1_epi16(s_networkActivationLimit);
+
+	__m256i low = _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(values)), zero), limit);
+	__m256i high = _mm256_min_epi16(_mm256_max_epi16(
+		_mm256_load_si256(reinterpret_cast<const __m256i*>(values + s_valuesPerRegister)), zero), limit);
+
+	// Packing works within each 128 bit half, the permute puts the bytes back in order.
+	__m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xD8);
+
+	__m256i pairSums = _mm256_maddubs_epi16(bytes, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights)));
+	return _mm256_add_epi32(sums, _mm256_madd_epi16(pairSums, _mm256_set1_epi16(1)));
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+void NeuralNetworkKernels::UpdateAccumulatorAvx2(const int16_t* parent, const int16_t* const* addedRows,
+	int addedCount, const int16_t* const* removedRows, int removedCount, int16_t* accumulatorOut)
+{
+	// The whole accumulator stays in registers while the rows are added in.
+	__m256i values[s_registerCount];
+	for (int i = 0; i < s_registerCount; ++i)
+	{
+		values[i] = _mm256_load_si256(reinterpret_cast<const __m256i*>(parent + i * s_valuesPerRegister));
+	}
+
+	for (int row = 0; row < addedCount; ++row)
+	{
+		for (int i = 0; i < s_registerCount; ++i)
+		{
+			values[i] = _mm256_add_epi16(values[i],
+				_mm256_load_si256(reinterpret_cast<const __m256i*>(addedRows[row] + i * s_valuesPerRegister)));
+		}
+	}
+
+	for (int row = 0; row < removedCount; ++row)
+	{
+		for (int i = 0; i < s_registerCount; ++i)
+		{
+			values[i] = _mm256_sub_epi16(values[i],
+				_mm256_load_si256(reinterpret_cast<const __m256i*>(removedRows[row] + i * s_valuesPerRegister)));
+		}
+	}
+
+	for (int i = 0; i < s_registerCount; ++i)
+	{
+		_mm256_store_si256(reinterpret_cast<__m256i*>(accumulatorOut + i * s_valuesPerRegister), values[i]);
+	}
+}
+
+int32_t NeuralNetworkKernels::PropagateAvx2(const int16_t* playerValues, const int16_t* opponentValues,
+	const int8_t* outputWeights)
+{
+	__m256i sums = _mm256_setzero_si256();
+	for (int i = 0; i < s_networkHiddenSize; i += 2 * s_valuesPerRegister)
+	{
+		sums = AddClippedDotProduct(sums, playerValues + i, outputWeights + i);
+		sums = AddClippedDotProduct(sums, opponentValues + i, outputWeights + s_networkHiddenSize + i);
+	}
+
+	__m128i halves = _mm_add_epi32(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+	halves = _mm_add_epi32(halves, _mm_shuffle_epi32(halves, 0x4E));
+	halves = _mm_add_epi32(halves, _mm_shuffle_epi32(halves, 0xB1));
+	return _mm_cvtsi128_si32(halves);
+}
+
+bool NeuralNetworkKernels::HasAvx2()
+{
+	return true;
+}
+
+#else
+
+void NeuralNetworkKernels::UpdateAccumulatorAvx2(const int16_t*, const int16_t* const*, int, const int16_t* const*,
+	int, int16_t*)
+{
+}
+
+int32_t NeuralNetworkKernels::PropagateAvx2(const int16_t*, const int16_t*, const int8_t*)
+{
+	return 0;
+}
+
+bool NeuralNetworkKernels::HasAvx2()
+{
+	return false;
+}
+
+#endif
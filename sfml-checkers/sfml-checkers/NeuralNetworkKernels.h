@@ -0,0 +1,44 @@
+//---------------------------------------------------------------
+//
+// NeuralNetworkKernels.h
+//
+// The SIMD halves of the network, each in a translation unit built for its own instruction set.
+// Like EvaluationTerms.h this includes nothing else of the engine, so no inline function compiled
+// for one instruction set can be picked by the linker for another.
+//
+
+#pragma once
+
+#include <cstdint>
+
+namespace {
+	// Inputs of the network: a man and a king of either side on each of the 32 squares, as seen by
+	// one of the players.
+	const int s_networkFeatureCount = 128;
+
+	// Accumulator values per player, a multiple of what one AVX2 register holds.
+	const int s_networkHiddenSize = 128;
+
+	// Accumulator values are clipped to this before the output layer, so they fit a byte.
+	const int s_networkActivationLimit = 127;
+}
+
+namespace NeuralNetworkKernels {
+
+//==============================================================================
+
+// Writes parent plus the added rows minus the removed rows to accumulatorOut, one row of
+// s_networkHiddenSize values per changed feature. Wraps on overflow, like the scalar code does.
+void UpdateAccumulatorAvx2(const int16_t* parent, const int16_t* const* addedRows, int addedCount,
+	const int16_t* const* removedRows, int removedCount, int16_t* accumulatorOut);
+
+// The output layer without its bias: the clipped values of the side to move and of its opponent
+// dotted with the two halves of the output weights.
+int32_t PropagateAvx2(const int16_t* playerValues, const int16_t* opponentValues, const int8_t* outputWeights);
+
+// Whether the kernel was built in.
+bool HasAvx2();
+
+//==============================================================================
+
+} // namespace NeuralNetworkKernels
@@ -0,0 +1,339 @@
+//---------------------------------------------------------------
+//
+// OpeningBook.cpp
+//
+
+#include "OpeningBook.h"
+#include "Game.h"
+#include "Log.h"
+#include "Pdn.h"
+#include "Zobrist.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+namespace {
+
+//==============================================================================
+
+const char s_magic[4] = { 'C', 'K', 'O', 'B' };
+const uint8_t s_version = 1;
+
+// Magic, version, three reserved bytes and the number of entries.
+const size_t s_headerSize = 16;
+const size_t s_entrySize = 16;
+
+static_assert(sizeof(OpeningBookEntry) == s_entrySize, "Book entries are written as they are laid out");
+
+// Interpolation steps before the lookup falls back to bisecting, in case the keys are not as even
+// as they should be.
+const int s_maxInterpolationSteps = 8;
+
+const uint32_t s_maxStoredGameCount = 0xFFFF;
+
+// Half points the side to move scores with the result.
+uint32_t GetWeight(GameResult result, bool isWhitePlayerTurn)
+{
+	if (result == RESULT_DRAW)
+		return 1;
+
+	return (result == RESULT_WHITE_WIN) == isWhitePlayerTurn ? 2 : 0;
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+OpeningBookBuilder::OpeningBookBuilder(int maxPlies)
+	: m_maxPlies(maxPlies)
+{
+}
+
+void OpeningBookBuilder::AddGame(const Position& startPosition, const std::vector<int>& turnIndices,
+	GameResult result)
+{
+	if (result == RESULT_UNFINISHED)
+		return;
+
+	Position position = startPosition;
+	UndoRecord undo;
+	int plyCount = std::min(static_cast<int>(turnIndices.size()), m_maxPlies);
+	for (int ply = 0; ply < plyCount; ++ply)
+	{
+		PackedMove turn;
+		if (!GameRecord::GetTurn(position, turnIndices[ply], turn))
+			return;
+
+		std::vector<TurnStats>& turns = m_positions[Zobrist::ComputeKey(position)];
+		auto found = std::find_if(turns.begin(), turns.end(),
+			[&](const TurnStats& stats) { return stats.m_turnIndex == turnIndices[ply]; });
+		if (found == turns.end())
+			found = turns.insert(turns.end(), TurnStats{ turnIndices[ply], 0, 0 });
+
+		++found->m_gameCount;
+		found->m_weight += GetWeight(result, position.m_isWhitePlayerTurn);
+
+		position.MakeMove(turn.GetSource(), turn.GetDestination(), turn.GetCapturedPieces(), undo);
+	}
+}
+
+bool OpeningBookBuilder::AddRecordFile(const std::string& filePath, uint64_t& gameCountOut)
+{
+	GameRecordReader reader;
+	if (!reader.Open(filePath))
+		return false;
+
+	Position startPosition = Position::CreateStartPosition();
+	std::vector<int> turnIndices;
+	while (reader.NextGame())
+	{
+		turnIndices.clear();
+		int turnIndex;
+		while (reader.NextTurn(turnIndex))
+		{
+			turnIndices.push_back(turnIndex);
+		}
+
+		AddGame(startPosition, turnIndices, reader.GetResult());
+		++gameCountOut;
+	}
+
+	return true;
+}
+
+bool OpeningBookBuilder::AddPdnFile(const std::string& filePath, uint64_t& gameCountOut)
+{
+	MappedFile file;
+	if (!file.Open(filePath, FILE_ACCESS_SEQUENTIAL))
+	{
+		LOG_ERROR(Logger::CATEGORY_GAME, "Cannot read the PDN file " + filePath);
+		return false;
+	}
+
+	std::string_view text(reinterpret_cast<const char*>(file.GetData()), static_cast<size_t>(file.GetSize()));
+	PdnParser parser(text);
+	PdnGame pdnGame;
+	Game game;
+	std::vector<PackedMove> turns;
+	std::vector<int> turnIndices;
+	while (parser.NextGame(pdnGame))
+	{
+		// A game with a malformed FEN tag leaves the game empty instead of holding the last one.
+		game.SetPosition(Position::CreateStartPosition());
+		Pdn::PlayGame(pdnGame, game);
+
+		turns.clear();
+		game.GetTurns(turns);
+
+		// Only the plies that go into the book are converted.
+		Position position = game.GetStartPosition();
+		UndoRecord undo;
+		turnIndices.clear();
+		for (size_t i = 0; i < turns.size() && static_cast<int>(i) < m_maxPlies; ++i)
+		{
+			turnIndices.push_back(GameRecord::GetTurnIndex(position, turns[i]));
+			position.MakeMove(turns[i].GetSource(), turns[i].GetDestination(), turns[i].GetCapturedPieces(), undo);
+		}
+
+		AddGame(game.GetStartPosition(), turnIndices, Pdn::GetResult(pdnGame));
+		++gameCountOut;
+	}
+
+	return true;
+}
+
+bool OpeningBookBuilder::Write(const std::string& filePath, int minGameCount, uint64_t& entryCountOut) const
+{
+	std::vector<OpeningBookEntry> entries;
+	for (const auto& position : m_positions)
+	{
+		for (const TurnStats& stats : position.second)
+		{
+			if (stats.m_gameCount < static_cast<uint32_t>(minGameCount))
+				continue;
+
+			OpeningBookEntry entry = {};
+			entry.m_key = position.first;
+			entry.m_weight = stats.m_weight;
+			entry.m_gameCount = static_cast<uint16_t>(std::min(stats.m_gameCount, s_maxStoredGameCount));
+			entry.m_turnIndex = static_cast<uint8_t>(stats.m_turnIndex);
+			entries.push_back(entry);
+		}
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const OpeningBookEntry& left, const OpeningBookEntry& right)
+	{
+		return left.m_key != right.m_key ? left.m_key < right.m_key : left.m_turnIndex < right.m_turnIndex;
+	});
+
+	AtomicFileWriter file;
+	if (!file.Open(filePath))
+	{
+		LOG_ERROR(Logger::CATEGORY_GAME, "Cannot write the opening book " + filePath);
+		return false;
+	}
+
+	uint8_t header[s_headerSize] = {};
+	std::memcpy(header, s_magic, sizeof(s_magic));
+	header[4] = s_version;
+	uint64_t entryCount = entries.size();
+	std::memcpy(header + 8, &entryCount, sizeof(entryCount));
+
+	file.Write(header, s_headerSize);
+	file.Write(entries.data(), s_entrySize * entries.size());
+	if (!file.Commit())
+	{
+		LOG_ERROR(Logger::CATEGORY_GAME, "Cannot write the opening book " + filePath);
+		return false;
+	}
+
+	entryCountOut = entryCount;
+	return true;
+}
+
+//---------------------------------------------------------------
+
+OpeningBook::OpeningBook()
+	: m_entries(nullptr)
+	, m_entryCount(0)
+{
+}
+
+bool OpeningBook::Open(const std::string& filePath)
+{
+	Close();
+
+	if (!m_file.Open(filePath, FILE_ACCESS_RANDOM))
+		return false;
+
+	const uint8_t* data = m_file.GetData();
+	uint64_t size = m_file.GetSize();
+	uint64_t entryCount = 0;
+	if (size >= s_headerSize)
+		std::memcpy(&entryCount, data + 8, sizeof(entryCount));
+
+	if (size < s_headerSize || std::memcmp(data, s_magic, sizeof(s_magic)) != 0 || data[4] != s_version
+		|| size != s_headerSize + entryCount * s_entrySize)
+	{
+		LOG_ERROR(Logger::CATEGORY_GAME, "Not an opening book: " + filePath);
+		m_file.Close();
+		return false;
+	}
+
+	m_entries = data + s_headerSize;
+	m_entryCount = entryCount;
+	return true;
+}
+
+void OpeningBook::Close()
+{
+	m_file.Close();
+	m_entries = nullptr;
+	m_entryCount = 0;
+}
+
+int OpeningBook::Find(const Position& position, OpeningBookEntry entriesOut[s_maxMoveCount]) const
+{
+	uint64_t key = Zobrist::ComputeKey(position);
+
+	int count = 0;
+	for (uint64_t index = FindFirst(key); index < m_entryCount && count < s_maxMoveCount; ++index)
+	{
+		OpeningBookEntry entry = GetEntry(index);
+		if (entry.m_key != key)
+			break;
+
+		entriesOut[count++] = entry;
+	}
+
+	return count;
+}
+
+bool OpeningBook::ChooseTurn(const Position& position, uint64_t randomValue, PackedMove& turnOut) const
+{
+	OpeningBookEntry entries[s_maxMoveCount];
+	int count = Find(position, entries);
+
+	uint64_t totalWeight = 0;
+	for (int i = 0; i < count; ++i)
+	{
+		totalWeight += entries[i].m_weight;
+	}
+
+	if (totalWeight == 0)
+		return false;
+
+	uint64_t choice = randomValue % totalWeight;
+	for (int i = 0; i < count; ++i)
+	{
+		if (choice < entries[i].m_weight)
+			return GameRecord::GetTurn(position, entries[i].m_turnIndex, turnOut);
+
+		choice -= entries[i].m_weight;
+	}
+
+	return false;
+}
+
+uint64_t OpeningBook::FindFirst(uint64_t key) const
+{
+	if (m_entryCount == 0)
+		return m_entryCount;
+
+	uint64_t low = 0;
+	uint64_t high = m_entryCount - 1;
+	for (int step = 0; low <= high; ++step)
+	{
+		uint64_t lowKey = GetKey(low);
+		uint64_t highKey = GetKey(high);
+		if (key < lowKey || key > highKey)
+			return m_entryCount;
+
+		// Guess where the key lies between the keys at both ends.
+		uint64_t probe = low + (high - low) / 2;
+		if (step < s_maxInterpolationSteps && highKey != lowKey)
+		{
+			double fraction = static_cast<double>(key - lowKey) / static_cast<double>(highKey - lowKey);
+			probe = low + std::min(static_cast<uint64_t>(fraction * (high - low)), high - low);
+		}
+
+		uint64_t probeKey = GetKey(probe);
+		if (probeKey == key)
+		{
+			// A position has an entry per turn, the first one is at most a few entries back.
+			while (probe > 0 && GetKey(probe - 1) == key)
+				--probe;
+
+			return probe;
+		}
+
+		if (probeKey < key)
+		{
+			low = probe + 1;
+		}
+		else
+		{
+			if (probe == 0)
+				break;
+
+			high = probe - 1;
+		}
+	}
+
+	return m_entryCount;
+}
+
+OpeningBookEntry OpeningBook::GetEntry(uint64_t index) const
+{
+	OpeningBookEntry entry;
+	std::memcpy(&entry, m_entries + index * s_entrySize, s_entrySize);
+	return entry;
+}
+
+uint64_t OpeningBook::GetKey(uint64_t index) const
+{
+	uint64_t key;
+	std::memcpy(&key, m_entries + index * s_entrySize, sizeof(key));
+	return key;
+}
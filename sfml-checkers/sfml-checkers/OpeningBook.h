@@ -0,0 +1,110 @@
+//---------------------------------------------------------------
+//
+// OpeningBook.h
+//
+// Opening book files. A file starts with a 16 byte header, the magic "CKOB", a version byte, three
+// reserved bytes and the number of entries. Then come the entries, 16 bytes each and sorted by the
+// Zobrist key of their position, one per turn the book knows: the key, the weight of the turn, the
+// games it was played in and the index of the turn among the turns MoveGenerator::GenerateTurns
+// lists for the position.
+//
+
+#pragma once
+
+#include "GameRecord.h"
+#include "MappedFile.h"
+#include "MoveList.h"
+#include "Position.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct OpeningBookEntry
+{
+	uint64_t m_key;
+
+	// Half points the side to move scored with the turn, two for a win and one for a draw.
+	uint32_t m_weight;
+
+	// Capped at 65535.
+	uint16_t m_gameCount;
+
+	uint8_t m_turnIndex;
+	uint8_t m_reserved;
+};
+
+// Counts the turns played in the first plies of many games, from self-play records and PDN
+// archives, and writes them out as a book.
+class OpeningBookBuilder
+{
+public:
+	explicit OpeningBookBuilder(int maxPlies);
+
+	// Adds the first plies of a game played from the position, as indices of its turns. Games without
+	// a result are left out.
+	void AddGame(const Position& startPosition, const std::vector<int>& turnIndices, GameResult result);
+
+	// Adds every game of a record file. Returns false if it cannot be read.
+	bool AddRecordFile(const std::string& filePath, uint64_t& gameCountOut);
+
+	// Adds every game of a PDN archive, up to its first illegal move. Returns false if it cannot be
+	// read.
+	bool AddPdnFile(const std::string& filePath, uint64_t& gameCountOut);
+
+	// Writes the turns played in at least the given number of games. The file is written under a
+	// temporary name and renamed once complete. Returns false if it cannot be written.
+	bool Write(const std::string& filePath, int minGameCount, uint64_t& entryCountOut) const;
+
+	uint64_t GetPositionCount() const { return m_positions.size(); }
+
+private:
+	struct TurnStats
+	{
+		int m_turnIndex;
+		uint32_t m_gameCount;
+		uint32_t m_weight;
+	};
+
+	int m_maxPlies;
+	std::unordered_map<uint64_t, std::vector<TurnStats>> m_positions;
+};
+
+//---------------------------------------------------------------
+
+// A book read through a memory mapping. A lookup is an interpolation search over the sorted keys,
+// which are spread evenly, so it touches a handful of entries however large the book is.
+class OpeningBook
+{
+public:
+	OpeningBook();
+
+	// Maps the file. Returns false if it cannot be mapped or is not a book.
+	bool Open(const std::string& filePath);
+
+	void Close();
+
+	bool IsOpen() const { return m_entries != nullptr; }
+
+	uint64_t GetEntryCount() const { return m_entryCount; }
+
+	// Copies the entries of the position, in the order of their turns, and returns how many there
+	// are.
+	int Find(const Position& position, OpeningBookEntry entriesOut[s_maxMoveCount]) const;
+
+	// Chooses one of the turns of the position at random, each as likely as its weight. Returns false
+	// if the book has no turn for it that ever scored.
+	bool ChooseTurn(const Position& position, uint64_t randomValue, PackedMove& turnOut) const;
+
+private:
+	// Index of the first entry with the key, or the entry count if there is none.
+	uint64_t FindFirst(uint64_t key) const;
+
+	OpeningBookEntry GetEntry(uint64_t index) const;
+	uint64_t GetKey(uint64_t index) const;
+
+	MappedFile m_file;
+	const uint8_t* m_entries;
+	uint64_t m_entryCount;
+};
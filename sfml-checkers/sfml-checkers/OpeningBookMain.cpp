@@ -0,0 +1,246 @@
+//---------------------------------------------------------------
+//
+// OpeningBookMain.cpp
+//
+// Opening book tool. Builds a book from self-play records and PDN archives, and looks positions up
+// in one: the turns it knows after a line of moves from the start position, and how long a lookup
+// takes.
+//
+// usage: opening-book --build <book> [--record <file> ...] [--pdn <file> ...] [--plies <count>]
+//   [--min-games <count>]
+//        opening-book <book> [--moves "<move> <move> ..."] [--lookups <count>]
+//
+
+#include "MoveGenerator.h"
+#include "OpeningBook.h"
+#include "Pdn.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+//==============================================================================
+
+const int s_defaultPlies = 16;
+const int s_defaultMinGames = 2;
+const int s_defaultLookups = 1000000;
+
+struct OpeningBookOptions
+{
+	OpeningBookOptions()
+		: m_shouldBuild(false)
+		, m_plies(s_defaultPlies)
+		, m_minGames(s_defaultMinGames)
+		, m_lookups(s_defaultLookups)
+	{
+	}
+
+	std::string m_bookPath;
+
+	// Whether to build the book instead of reading it.
+	bool m_shouldBuild;
+	std::vector<std::string> m_recordPaths;
+	std::vector<std::string> m_pdnPaths;
+	int m_plies;
+	int m_minGames;
+
+	// Moves from the start position to the position to look up.
+	std::string m_moves;
+	int m_lookups;
+};
+
+void PrintUsage()
+{
+	std::printf("usage: opening-book --build <book> [--record <file> ...] [--pdn <file> ...] [--plies <count>]\n"
+		"  [--min-games <count>]\n"
+		"       opening-book <book> [--moves \"<move> <move> ...\"] [--lookups <count>]\n"
+		"  --build      build the book from the games instead of reading it\n"
+		"  --record     game record file to add, as written by self-play\n"
+		"  --pdn        PDN archive to add\n"
+		"  --plies      plies of every game that go into the book, defaults to %d\n"
+		"  --min-games  games a turn must be played in to be kept, defaults to %d\n"
+		"  --moves      moves from the start position to the position to look up\n"
+		"  --lookups    lookups to time, defaults to %d\n",
+		s_defaultPlies, s_defaultMinGames, s_defaultLookups);
+}
+
+bool ParseOptions(int argc, char** argv, OpeningBookOptions& optionsOut)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument(argv[i]);
+		if (argument == "--build" && i + 1 < argc)
+		{
+			optionsOut.m_shouldBuild = true;
+			optionsOut.m_bookPath = argv[++i];
+		}
+		else if (argument == "--record" && i + 1 < argc)
+		{
+			optionsOut.m_recordPaths.push_back(argv[++i]);
+		}
+		else if (argument == "--pdn" && i + 1 < argc)
+		{
+			optionsOut.m_pdnPaths.push_back(argv[++i]);
+		}
+		else if (argument == "--plies" && i + 1 < argc)
+		{
+			optionsOut.m_plies = std::atoi(argv[++i]);
+		}
+		else if (argument == "--min-games" && i + 1 < argc)
+		{
+			optionsOut.m_minGames = std::atoi(argv[++i]);
+		}
+		else if (argument == "--moves" && i + 1 < argc)
+		{
+			optionsOut.m_moves = argv[++i];
+		}
+		else if (argument == "--lookups" && i + 1 < argc)
+		{
+			optionsOut.m_lookups = std::atoi(argv[++i]);
+		}
+		else if (!argument.empty() && argument[0] != '-')
+		{
+			optionsOut.m_bookPath = argument;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return !optionsOut.m_bookPath.empty() && optionsOut.m_plies > 0 && optionsOut.m_minGames > 0
+		&& optionsOut.m_lookups >= 0;
+}
+
+double GetSecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool BuildBook(const OpeningBookOptions& options)
+{
+	auto startTime = std::chrono::steady_clock::now();
+
+	OpeningBookBuilder builder(options.m_plies);
+	uint64_t gameCount = 0;
+	for (const std::string& recordPath : options.m_recordPaths)
+	{
+		if (!builder.AddRecordFile(recordPath, gameCount))
+		{
+			std::fprintf(stderr, "Error: cannot read %s\n", recordPath.c_str());
+			return false;
+		}
+	}
+
+	for (const std::string& pdnPath : options.m_pdnPaths)
+	{
+		if (!builder.AddPdnFile(pdnPath, gameCount))
+		{
+			std::fprintf(stderr, "Error: cannot read %s\n", pdnPath.c_str());
+			return false;
+		}
+	}
+
+	uint64_t entryCount = 0;
+	if (!builder.Write(options.m_bookPath, options.m_minGames, entryCount))
+	{
+		std::fprintf(stderr, "Error: cannot write %s\n", options.m_bookPath.c_str());
+		return false;
+	}
+
+	std::printf("%llu games, %llu positions, %llu turns kept, written to %s in %.3f seconds\n",
+		static_cast<unsigned long long>(gameCount), static_cast<unsigned long long>(builder.GetPositionCount()),
+		static_cast<unsigned long long>(entryCount), options.m_bookPath.c_str(), GetSecondsSince(startTime));
+	return true;
+}
+
+bool LookUp(const OpeningBookOptions& options)
+{
+	OpeningBook book;
+	if (!book.Open(options.m_bookPath))
+	{
+		std::fprintf(stderr, "Error: cannot read %s\n", options.m_bookPath.c_str());
+		return false;
+	}
+
+	// Move numbers and anything else that is not a move are skipped.
+	Position position = Position::CreateStartPosition();
+	std::string_view moves(options.m_moves);
+	while (!moves.empty())
+	{
+		size_t end = moves.find(' ');
+		std::string_view move = moves.substr(0, end);
+		moves = end == std::string_view::npos ? std::string_view() : moves.substr(end + 1);
+		if (move.empty() || move.back() == '.')
+			continue;
+
+		PackedMove turn;
+		if (!Pdn::FindTurn(position, move, turn))
+		{
+			std::fprintf(stderr, "Error: %.*s is not a legal move\n", static_cast<int>(move.size()), move.data());
+			return false;
+		}
+
+		UndoRecord undo;
+		position.MakeMove(turn.GetSource(), turn.GetDestination(), turn.GetCapturedPieces(), undo);
+	}
+
+	std::printf("%llu entries in %s\n", static_cast<unsigned long long>(book.GetEntryCount()),
+		options.m_bookPath.c_str());
+
+	OpeningBookEntry entries[s_maxMoveCount];
+	int count = book.Find(position, entries);
+	if (count == 0)
+		std::printf("the position is not in the book\n");
+
+	for (int i = 0; i < count; ++i)
+	{
+		PackedMove turn;
+		if (!GameRecord::GetTurn(position, entries[i].m_turnIndex, turn))
+			continue;
+
+		std::printf("%-10s weight %u, %u games, %.1f%%\n", MoveGenerator::GetNotation(position, turn).c_str(),
+			entries[i].m_weight, entries[i].m_gameCount, 50.0 * entries[i].m_weight / entries[i].m_gameCount);
+	}
+
+	if (options.m_lookups > 0)
+	{
+		auto startTime = std::chrono::steady_clock::now();
+
+		int foundCount = 0;
+		for (int i = 0; i < options.m_lookups; ++i)
+		{
+			foundCount += book.Find(position, entries);
+		}
+
+		double seconds = GetSecondsSince(startTime);
+		std::printf("%d lookups in %.3f seconds, %.3f microseconds each (%d found)\n", options.m_lookups, seconds,
+			1e6 * seconds / options.m_lookups, foundCount / options.m_lookups);
+	}
+
+	return true;
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+	OpeningBookOptions options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	if (options.m_shouldBuild)
+		return BuildBook(options) ? 0 : 1;
+
+	return LookUp(options) ? 0 : 1;
+}
@@ -0,0 +1,468 @@
+//---------------------------------------------------------------
+//
+// Pdn.cpp
+//
+
+#include "Pdn.h"
+#include "Game.h"
+#include "Log.h"
+#include "MoveGenerator.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+
+namespace {
+
+//==============================================================================
+
+// More squares than a capture chain can visit.
+const int s_maxPathLength = 16;
+
+// Turns written on one line before the next one starts.
+const size_t s_maxLineLength = 80;
+
+// PDN game type of English draughts.
+const char* s_gameType = "21";
+
+enum CharacterClass : uint8_t
+{
+	CHARACTER_TOKEN,
+	CHARACTER_SPACE,
+
+	// Ends a token without being whitespace: brackets, braces, parentheses and semicolons.
+	CHARACTER_DELIMITER,
+};
+
+constexpr std::array<uint8_t, 256> CreateCharacterClasses()
+{
+	std::array<uint8_t, 256> classes = {};
+	for (unsigned char c : { ' ', '\n', '\r', '\t' })
+		classes[c] = CHARACTER_SPACE;
+	for (unsigned char c : { '[', ']', '{', '}', '(', ')', ';' })
+		classes[c] = CHARACTER_DELIMITER;
+
+	return classes;
+}
+
+// Looked up once per character, the parser spends most of its time classifying them.
+constexpr std::array<uint8_t, 256> s_characterClasses = CreateCharacterClasses();
+
+bool IsSpace(char c)
+{
+	return s_characterClasses[static_cast<unsigned char>(c)] == CHARACTER_SPACE;
+}
+
+bool IsDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+// Characters that end a token.
+bool IsDelimiter(char c)
+{
+	return s_characterClasses[static_cast<unsigned char>(c)] != CHARACTER_TOKEN;
+}
+
+bool IsResult(std::string_view token)
+{
+	// Most tokens are moves, which rule themselves out on their length or first character.
+	if ((token.size() != 1 && token.size() != 3 && token.size() != 7) || token[0] > '2')
+		return false;
+
+	return token == "*" || token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "2-0"
+		|| token == "0-2" || token == "1-1" || token == "0-0";
+}
+
+// Index just past the first c at or after offset, or the end of the text.
+size_t SkipPast(std::string_view text, size_t offset, char c)
+{
+	size_t found = text.find(c, offset);
+	return found == std::string_view::npos ? text.size() : found + 1;
+}
+
+// Parses "11-15", "9x18x27" and the like into zero based squares. Returns false if it is not a
+// move.
+bool ParseSquares(std::string_view move, int* squaresOut, int& countOut)
+{
+	countOut = 0;
+	size_t i = 0;
+	while (i < move.size())
+	{
+		if (countOut != 0)
+		{
+			if (move[i] != '-' && move[i] != 'x' && move[i] != 'X')
+				return false;
+			++i;
+		}
+
+		int square = 0;
+		size_t digits = i;
+		while (i < move.size() && IsDigit(move[i]))
+			square = square * 10 + (move[i++] - '0');
+
+		if (i == digits || i - digits > 2 || square < 1 || square > s_squareCount || countOut == s_maxPathLength)
+			return false;
+
+		squaresOut[countOut++] = square - 1;
+	}
+
+	return countOut >= 2;
+}
+
+// Pieces jumped over along the squares. Returns false if a step is not a jump.
+bool GetJumpedPieces(const int* squares, int count, Bitboard& jumpedOut)
+{
+	jumpedOut = 0;
+	for (int i = 0; i + 1 < count; ++i)
+	{
+		BoardIndex from = BoardIndexFromSquare(squares[i]);
+		BoardIndex to = BoardIndexFromSquare(squares[i + 1]);
+		if (std::abs(to.first - from.first) != 2 || std::abs(to.second - from.second) != 2)
+			return false;
+
+		jumpedOut |= SquareMask(SquareFromBoardIndex(
+			BoardIndex((from.first + to.first) / 2, (from.second + to.second) / 2)));
+	}
+
+	return true;
+}
+
+// PDN and this game disagree on which color moves first, on the same squares.
+Position SwapColors(const Position& position)
+{
+	Position swapped = position;
+	std::swap(swapped.m_whitePieces, swapped.m_blackPieces);
+	swapped.m_isWhitePlayerTurn = !position.m_isWhitePlayerTurn;
+	return swapped;
+}
+
+const char* GetResultText(GameResult result)
+{
+	switch (result)
+	{
+	case RESULT_WHITE_WIN:
+		return "1-0";
+	case RESULT_BLACK_WIN:
+		return "0-1";
+	case RESULT_DRAW:
+		return "1/2-1/2";
+	default:
+		return "*";
+	}
+}
+
+void AppendTag(const char* name, const std::string& value, std::string& pdnOut)
+{
+	pdnOut += '[';
+	pdnOut += name;
+	pdnOut += " \"";
+	pdnOut += value;
+	pdnOut += "\"]\n";
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+void PdnGame::Clear()
+{
+	m_tags.clear();
+	m_moves.clear();
+	m_result = std::string_view();
+}
+
+std::string_view PdnGame::GetTag(std::string_view name) const
+{
+	for (const std::pair<std::string_view, std::string_view>& tag : m_tags)
+	{
+		if (tag.first == name)
+			return tag.second;
+	}
+
+	return std::string_view();
+}
+
+//---------------------------------------------------------------
+
+PdnParser::PdnParser(std::string_view text)
+	: m_text(text)
+	, m_offset(0)
+{
+}
+
+bool PdnParser::NextGame(PdnGame& gameOut)
+{
+	gameOut.Clear();
+
+	bool hasContent = false;
+	for (;;)
+	{
+		SkipSeparators();
+		if (m_offset >= m_text.size())
+			return hasContent;
+
+		// Tags after the moves belong to the next game.
+		if (m_text[m_offset] == '[')
+		{
+			if (!gameOut.m_moves.empty())
+				return true;
+
+			ParseTag(gameOut);
+			hasContent = true;
+			continue;
+		}
+
+		// Move numbers, "12." or "12...", are dropped, along with a move run into them.
+		const char* text = m_text.data();
+		size_t start = m_offset;
+		size_t moveStart = m_offset;
+		while (m_offset < m_text.size() && !IsDelimiter(text[m_offset]))
+		{
+			if (text[m_offset++] == '.')
+				moveStart = m_offset;
+		}
+
+		// A stray closing bracket.
+		if (m_offset == start)
+		{
+			++m_offset;
+			continue;
+		}
+
+		hasContent = true;
+		std::string_view token(text + moveStart, m_offset - moveStart);
+
+		if (moveStart == start && IsResult(token))
+		{
+			gameOut.m_result = token;
+			return true;
+		}
+
+		while (!token.empty() && (token.back() == '!' || token.back() == '?'))
+			token.remove_suffix(1);
+
+		// Anything else, such as $ annotations, is skipped.
+		if (!token.empty() && IsDigit(token[0]))
+			gameOut.m_moves.push_back(token);
+	}
+}
+
+void PdnParser::SkipSeparators()
+{
+	while (m_offset < m_text.size())
+	{
+		char c = m_text[m_offset];
+		if (IsSpace(c))
+		{
+			++m_offset;
+		}
+		else if (c == '{')
+		{
+			m_offset = SkipPast(m_text, m_offset, '}');
+		}
+		else if (c == ';' || (c == '%' && (m_offset == 0 || m_text[m_offset - 1] == '\n')))
+		{
+			// Comments and escaped lines run to the end of the line.
+			m_offset = SkipPast(m_text, m_offset, '\n');
+		}
+		else if (c == '(')
+		{
+			// Variations nest, and may hold comments with parentheses of their own.
+			int depth = 0;
+			while (m_offset < m_text.size())
+			{
+				c = m_text[m_offset];
+				if (c == '{')
+				{
+					m_offset = SkipPast(m_text, m_offset, '}');
+					continue;
+				}
+
+				++m_offset;
+				if (c == '(')
+					++depth;
+				else if (c == ')' && --depth == 0)
+					break;
+			}
+		}
+		else
+		{
+			break;
+		}
+	}
+}
+
+void PdnParser::ParseTag(PdnGame& gameOut)
+{
+	size_t end = m_text.size();
+
+	// Past the bracket.
+	++m_offset;
+	while (m_offset < end && IsSpace(m_text[m_offset]))
+		++m_offset;
+
+	size_t nameStart = m_offset;
+	while (m_offset < end && !IsSpace(m_text[m_offset]) && m_text[m_offset] != '"' && m_text[m_offset] != ']')
+		++m_offset;
+	std::string_view name = m_text.substr(nameStart, m_offset - nameStart);
+
+	std::string_view value;
+	while (m_offset < end && m_text[m_offset] != '"' && m_text[m_offset] != ']')
+		++m_offset;
+
+	if (m_offset < end && m_text[m_offset] == '"')
+	{
+		size_t valueStart = ++m_offset;
+		while (m_offset < end && m_text[m_offset] != '"')
+			m_offset += m_text[m_offset] == '\\' ? 2 : 1;
+
+		m_offset = std::min(m_offset, end);
+		value = m_text.substr(valueStart, m_offset - valueStart);
+	}
+
+	m_offset = SkipPast(m_text, m_offset, ']');
+	gameOut.m_tags.push_back(std::make_pair(name, value));
+}
+
+//---------------------------------------------------------------
+
+bool Pdn::FindTurn(const Position& position, std::string_view move, PackedMove& turnOut)
+{
+	int squares[s_maxPathLength];
+	int count;
+	if (!ParseSquares(move, squares, count))
+		return false;
+
+	// With the squares in between given, they tell which pieces were captured.
+	Bitboard jumpedPieces = 0;
+	bool isPathGiven = count > 2;
+	if (isPathGiven && !GetJumpedPieces(squares, count, jumpedPieces))
+		return false;
+
+	MoveList turns;
+	MoveGenerator::GenerateTurns(position, turns);
+	for (const PackedMove& turn : turns)
+	{
+		if (turn.GetSource() == squares[0] && turn.GetDestination() == squares[count - 1]
+			&& (!isPathGiven || turn.GetCapturedPieces() == jumpedPieces))
+		{
+			turnOut = turn;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool Pdn::PlayGame(const PdnGame& pdnGame, Game& game)
+{
+	Position start = Position::CreateStartPosition();
+
+	std::string_view fen = pdnGame.GetTag("FEN");
+	if (!fen.empty())
+	{
+		Position pdnStart;
+		if (!Position::FromFen(std::string(fen), pdnStart))
+		{
+			LOG_WARNING(Logger::CATEGORY_GAME, "Malformed FEN tag: " + std::string(fen));
+			return false;
+		}
+
+		start = SwapColors(pdnStart);
+	}
+
+	game.SetPosition(start);
+
+	for (std::string_view move : pdnGame.m_moves)
+	{
+		PackedMove turn;
+		if (!FindTurn(game.GetPosition(), move, turn))
+		{
+			LOG_WARNING(Logger::CATEGORY_GAME, "Illegal move in PDN game: " + std::string(move));
+			return false;
+		}
+
+		std::vector<int> path = MoveGenerator::GetPath(game.GetPosition(), turn);
+		for (size_t i = 0; i + 1 < path.size(); ++i)
+		{
+			if (!game.PlayHop(path[i], path[i + 1]))
+			{
+				LOG_WARNING(Logger::CATEGORY_GAME, "Game refused the PDN move " + std::string(move));
+
+				// Leave no capture chain half played.
+				if (i > 0)
+					game.TakeBack();
+
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+GameResult Pdn::GetResult(const PdnGame& pdnGame)
+{
+	std::string_view result = !pdnGame.m_result.empty() ? pdnGame.m_result : pdnGame.GetTag("Result");
+
+	if (result == "1-0" || result == "2-0")
+		return RESULT_WHITE_WIN;
+	if (result == "0-1" || result == "0-2")
+		return RESULT_BLACK_WIN;
+	if (result == "1/2-1/2" || result == "1-1")
+		return RESULT_DRAW;
+
+	return RESULT_UNFINISHED;
+}
+
+void Pdn::WriteGame(const Game& game, GameResult result, std::string& pdnOut)
+{
+	Position position = game.GetStartPosition();
+
+	AppendTag("GameType", s_gameType, pdnOut);
+	if (position != Position::CreateStartPosition())
+		AppendTag("FEN", SwapColors(position).ToFen(), pdnOut);
+	AppendTag("Result", GetResultText(result), pdnOut);
+
+	std::vector<PackedMove> turns;
+	game.GetTurns(turns);
+
+	// A game started by the second mover numbers its first turn on its own.
+	int ply = position.m_isWhitePlayerTurn ? 0 : 1;
+
+	std::string line;
+	std::string text;
+	for (const PackedMove& turn : turns)
+	{
+		text.clear();
+		if (ply % 2 == 0)
+			text = std::to_string(ply / 2 + 1) + ". ";
+		else if (line.empty())
+			text = std::to_string(ply / 2 + 1) + "... ";
+		text += MoveGenerator::GetNotation(position, turn);
+
+		if (!line.empty() && line.size() + 1 + text.size() > s_maxLineLength)
+		{
+			pdnOut += line;
+			pdnOut += '\n';
+			line.clear();
+		}
+
+		if (!line.empty())
+			line += ' ';
+		line += text;
+
+		UndoRecord undo;
+		position.MakeMove(turn.GetSource(), turn.GetDestination(), turn.GetCapturedPieces(), undo);
+		++ply;
+	}
+
+	if (!line.empty())
+		line += ' ';
+	line += GetResultText(result);
+
+	pdnOut += line;
+	pdnOut += "\n\n";
+}
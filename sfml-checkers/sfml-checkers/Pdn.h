@@ -0,0 +1,90 @@
+//---------------------------------------------------------------
+//
+// Pdn.h
+//
+// Portable Draughts Notation, the text format other checkers programs exchange games in. Squares
+// are numbered 1-32 as in this game. PDN calls the side that moves first Black where this game
+// calls it white, so colors are swapped in FEN tags, and results are written first mover first:
+// "1-0" is a win for the side that moved first.
+//
+
+#pragma once
+
+#include "GameRecord.h"
+#include "MoveList.h"
+#include "Position.h"
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+class Game;
+
+// One game of a PDN text. The views point into the parsed text, which must outlive them. The
+// vectors keep their capacity from game to game, so parsing a game allocates nothing once they
+// have grown.
+struct PdnGame
+{
+	void Clear();
+
+	// Value of the tag, empty if the game does not have it.
+	std::string_view GetTag(std::string_view name) const;
+
+	// Tag names and values, without the brackets and quotes.
+	std::vector<std::pair<std::string_view, std::string_view>> m_tags;
+
+	// Move tokens as written, e.g. "11-15", "9x18x27" or "9x27", without move numbers and comments.
+	std::vector<std::string_view> m_moves;
+
+	// The game termination marker, empty if the text ended without one.
+	std::string_view m_result;
+};
+
+// Splits a PDN text into games without copying it. Comments, variations, move numbers and move
+// annotations are skipped.
+class PdnParser
+{
+public:
+	explicit PdnParser(std::string_view text);
+
+	// Parses the next game. Returns false once the text holds no more games.
+	bool NextGame(PdnGame& gameOut);
+
+	// Bytes parsed so far.
+	size_t GetOffset() const { return m_offset; }
+
+private:
+	// Skips whitespace, comments, variations and escaped lines.
+	void SkipSeparators();
+
+	void ParseTag(PdnGame& gameOut);
+
+	std::string_view m_text;
+	size_t m_offset;
+};
+
+namespace Pdn {
+
+//==============================================================================
+
+// Finds the turn a PDN move token stands for in the position. The token may list every square the
+// piece visits or, for a capture, only the first and the last. Returns false if no legal turn
+// matches.
+bool FindTurn(const Position& position, std::string_view move, PackedMove& turnOut);
+
+// Plays the parsed game on the game from its FEN tag, or the start position without one. Every hop
+// goes through the same legality checks as a player's selection. Returns false at the first move
+// that is not legal, the game then holds the turns before it.
+bool PlayGame(const PdnGame& pdnGame, Game& game);
+
+// Result of the parsed game, RESULT_UNFINISHED if it is not known.
+GameResult GetResult(const PdnGame& pdnGame);
+
+// Appends the game as PDN: its tags, its turns numbered in pairs and wrapped into lines, and the
+// result.
+void WriteGame(const Game& game, GameResult result, std::string& pdnOut);
+
+//==============================================================================
+
+} // namespace Pdn
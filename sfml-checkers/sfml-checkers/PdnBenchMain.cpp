@@ -0,0 +1,224 @@
+//---------------------------------------------------------------
+//
+// PdnBenchMain.cpp
+//
+// PDN benchmark. Parses a PDN archive through a memory mapping and reports the parse rate, and can
+// replay every game through Game to check it. Writes random archives of any size to measure with.
+//
+// usage: pdn-bench <file> [--passes <count>] [--replay]
+//        pdn-bench --generate <file> [--games <count>] [--seed <seed>]
+//
+
+#include "Game.h"
+#include "MappedFile.h"
+#include "MoveGenerator.h"
+#include "Pdn.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace {
+
+//==============================================================================
+
+const int s_defaultGameCount = 10000;
+
+// Random games still going after this many turns are scored a draw.
+const int s_maxGeneratedTurns = 200;
+
+struct PdnBenchOptions
+{
+	PdnBenchOptions()
+		: m_passCount(1)
+		, m_shouldReplay(false)
+		, m_shouldGenerate(false)
+		, m_gameCount(s_defaultGameCount)
+		, m_seed(1)
+	{
+	}
+
+	std::string m_filePath;
+	int m_passCount;
+	bool m_shouldReplay;
+
+	// Whether to write a random archive instead of reading one.
+	bool m_shouldGenerate;
+	int m_gameCount;
+	uint64_t m_seed;
+};
+
+void PrintUsage()
+{
+	std::printf("usage: pdn-bench <file> [--passes <count>] [--replay]\n"
+		"       pdn-bench --generate <file> [--games <count>] [--seed <seed>]\n"
+		"  --passes    times to parse the file, defaults to 1\n"
+		"  --replay    also play every game through Game and count the illegal ones\n"
+		"  --generate  write random games to the file instead\n"
+		"  --games     games to write, defaults to %d\n"
+		"  --seed      seed of the random games\n", s_defaultGameCount);
+}
+
+bool ParseOptions(int argc, char** argv, PdnBenchOptions& optionsOut)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument(argv[i]);
+		if (argument == "--passes" && i + 1 < argc)
+		{
+			optionsOut.m_passCount = std::atoi(argv[++i]);
+		}
+		else if (argument == "--replay")
+		{
+			optionsOut.m_shouldReplay = true;
+		}
+		else if (argument == "--generate" && i + 1 < argc)
+		{
+			optionsOut.m_shouldGenerate = true;
+			optionsOut.m_filePath = argv[++i];
+		}
+		else if (argument == "--games" && i + 1 < argc)
+		{
+			optionsOut.m_gameCount = std::atoi(argv[++i]);
+		}
+		else if (argument == "--seed" && i + 1 < argc)
+		{
+			optionsOut.m_seed = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (!argument.empty() && argument[0] != '-')
+		{
+			optionsOut.m_filePath = argument;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return !optionsOut.m_filePath.empty() && optionsOut.m_passCount > 0 && optionsOut.m_gameCount > 0;
+}
+
+double GetSecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Writes random games, played through Game, as PDN.
+bool GenerateArchive(const PdnBenchOptions& options)
+{
+	std::FILE* file = std::fopen(options.m_filePath.c_str(), "wb");
+	if (!file)
+	{
+		std::fprintf(stderr, "Error: cannot write %s\n", options.m_filePath.c_str());
+		return false;
+	}
+
+	std::mt19937_64 random(options.m_seed);
+	std::string pdn;
+	uint64_t byteCount = 0;
+
+	MoveList turns;
+	for (int i = 0; i < options.m_gameCount; ++i)
+	{
+		Game game;
+
+		int turn = 0;
+		for (; turn < s_maxGeneratedTurns; ++turn)
+		{
+			turns.Clear();
+			MoveGenerator::GenerateTurns(game.GetPosition(), turns);
+			if (turns.IsEmpty())
+				break;
+
+			game.PlayMove(turns[static_cast<int>(random() % turns.GetSize())]);
+		}
+
+		GameResult result = RESULT_DRAW;
+		if (turn < s_maxGeneratedTurns)
+			result = game.GetPosition().m_isWhitePlayerTurn ? RESULT_BLACK_WIN : RESULT_WHITE_WIN;
+
+		pdn.clear();
+		Pdn::WriteGame(game, result, pdn);
+		std::fwrite(pdn.data(), 1, pdn.size(), file);
+		byteCount += pdn.size();
+	}
+
+	std::fclose(file);
+	std::printf("wrote %d games, %.1f MB to %s\n", options.m_gameCount, byteCount / 1e6,
+		options.m_filePath.c_str());
+	return true;
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+	PdnBenchOptions options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	if (options.m_shouldGenerate)
+		return GenerateArchive(options) ? 0 : 1;
+
+	MappedFile file;
+	if (!file.Open(options.m_filePath, FILE_ACCESS_SEQUENTIAL))
+	{
+		std::fprintf(stderr, "Error: cannot read %s\n", options.m_filePath.c_str());
+		return 1;
+	}
+
+	std::string_view text(reinterpret_cast<const char*>(file.GetData()), static_cast<size_t>(file.GetSize()));
+	double megabytes = text.size() / 1e6;
+
+	PdnGame pdnGame;
+	uint64_t gameCount = 0;
+	uint64_t moveCount = 0;
+	for (int pass = 0; pass < options.m_passCount; ++pass)
+	{
+		gameCount = 0;
+		moveCount = 0;
+
+		auto startTime = std::chrono::steady_clock::now();
+
+		PdnParser parser(text);
+		while (parser.NextGame(pdnGame))
+		{
+			++gameCount;
+			moveCount += pdnGame.m_moves.size();
+		}
+
+		double seconds = GetSecondsSince(startTime);
+		std::printf("parse  %llu games, %llu moves, %.1f MB in %.3f seconds, %.1f MB/sec\n",
+			static_cast<unsigned long long>(gameCount), static_cast<unsigned long long>(moveCount), megabytes,
+			seconds, seconds > 0.0 ? megabytes / seconds : 0.0);
+	}
+
+	if (options.m_shouldReplay)
+	{
+		auto startTime = std::chrono::steady_clock::now();
+
+		Game game;
+		uint64_t illegalCount = 0;
+		PdnParser parser(text);
+		while (parser.NextGame(pdnGame))
+		{
+			if (!Pdn::PlayGame(pdnGame, game))
+				++illegalCount;
+		}
+
+		double seconds = GetSecondsSince(startTime);
+		std::printf("replay %llu games, %llu illegal, in %.3f seconds, %.1f games/sec\n",
+			static_cast<unsigned long long>(gameCount), static_cast<unsigned long long>(illegalCount), seconds,
+			seconds > 0.0 ? gameCount / seconds : 0.0);
+	}
+
+	return 0;
+}
@@ -0,0 +1,117 @@
+//---------------------------------------------------------------
+//
+// Perft.cpp
+//
+
+#include "Perft.h"
+#include "MoveGenerator.h"
+
+namespace {
+
+//==============================================================================
+
+// Published perft results for the English draughts start position, indexed by depth.
+const uint64_t s_startPositionNodeCounts[] =
+{
+	1,
+	7,
+	49,
+	302,
+	1469,
+	7361,
+	36768,
+	179740,
+	845931,
+	3963680,
+	18391564,
+	85242128,
+	388623673,
+};
+
+const int s_maxKnownDepth = sizeof(s_startPositionNodeCounts) / sizeof(s_startPositionNodeCounts[0]) - 1;
+
+//==============================================================================
+
+} // anonymous namespace
+
+Perft::Perft()
+{
+}
+
+Perft::~Perft()
+{
+}
+
+uint64_t Perft::CountNodes(const Position& position, int depth)
+{
+	if (depth <= 0)
+		return 1;
+
+	Position root = position;
+	return CountNodesAtLevel(root, depth, 0);
+}
+
+std::vector<std::pair<std::string, uint64_t>> Perft::Divide(const Position& position, int depth)
+{
+	std::vector<std::pair<std::string, uint64_t>> result;
+	if (depth <= 0)
+		return result;
+
+	MoveList turns;
+	MoveGenerator::GenerateTurns(position, turns);
+
+	for (const PackedMove& turn : turns)
+	{
+		Position child = position;
+		UndoRecord undo;
+		child.MakeMove(turn.GetSource(), turn.GetDestination(), turn.GetCapturedPieces(), undo);
+		result.push_back(std::make_pair(MoveGenerator::GetNotation(position, turn), CountNodes(child, depth - 1)));
+	}
+
+	return result;
+}
+
+uint64_t Perft::GetStartPositionNodeCount(int depth)
+{
+	if (depth < 0 || depth > s_maxKnownDepth)
+		return 0;
+
+	return s_startPositionNodeCounts[depth];
+}
+
+int Perft::GetMaxKnownDepth()
+{
+	return s_maxKnownDepth;
+}
+
+uint64_t Perft::CountNodesAtLevel(Position& position, int depth, int level)
+{
+	MoveList& turns = GetMoveList(level);
+	turns.Clear();
+	MoveGenerator::GenerateTurns(position, turns);
+
+	// Bulk count the last ply, the turns themselves are all we need.
+	if (depth == 1)
+		return turns.GetSize();
+
+	uint64_t nodes = 0;
+	for (const PackedMove& turn : turns)
+	{
+		UndoRecord undo;
+		position.MakeMove(turn.GetSource(), turn.GetDestination(), turn.GetCapturedPieces(), undo);
+		nodes += CountNodesAtLevel(position, depth - 1, level + 1);
+		position.UnmakeMove(undo);
+	}
+
+	return nodes;
+}
+
+MoveList& Perft::GetMoveList(int level)
+{
+	while (static_cast<int>(m_moveLists.size()) <= level)
+	{
+		m_moveLists.push_back(MoveList());
+	}
+
+	return m_moveLists[level];
+}
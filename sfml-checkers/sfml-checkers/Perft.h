@@ -0,0 +1,47 @@
+//---------------------------------------------------------------
+//
+// Perft.h
+//
+
+#pragma once
+
+#include "MoveList.h"
+#include "Position.h"
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Walks the full move tree below a position and counts the leaf nodes. A complete multi-jump is
+// one move, like it is one turn in the game.
+class Perft
+{
+public:
+	Perft();
+	~Perft();
+
+	// Returns the number of leaf nodes depth moves below the position.
+	uint64_t CountNodes(const Position& position, int depth);
+
+	// Returns the leaf node count below every legal move of the position, keyed by the move in
+	// standard notation ("11-15" for a move, "9x18x27" for a multi-jump).
+	std::vector<std::pair<std::string, uint64_t>> Divide(const Position& position, int depth);
+
+	// Returns the published node count for the start position, or 0 if none is known for the depth.
+	static uint64_t GetStartPositionNodeCount(int depth);
+
+	// Deepest depth GetStartPositionNodeCount knows about.
+	static int GetMaxKnownDepth();
+
+private:
+	// Turns are made on the position and unmade again after counting below them.
+	uint64_t CountNodesAtLevel(Position& position, int depth, int level);
+
+	// Move list storage, one per recursion level so nothing is allocated while counting.
+	MoveList& GetMoveList(int level);
+
+	// A deque, so growing it keeps the lists of the levels above valid.
+	std::deque<MoveList> m_moveLists;
+};
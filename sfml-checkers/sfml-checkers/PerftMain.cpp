@@ -0,0 +1,261 @@
+//---------------------------------------------------------------
+//
+// PerftMain.cpp
+//
+// Headless perft driver. Counts the move tree from the start position or a FEN to measure
+// move generator throughput, and verifies the counts against published results. Other board
+// variants are counted from their start position with the generic VariantPerft.
+//
+// usage: perft [depth] [--fen <fen>] [--divide] [--verify] [--variant <name>]
+//
+
+#include "Perft.h"
+#include "VariantPerft.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+//==============================================================================
+
+const int s_defaultDepth = 8;
+
+// Published perft results for the international draughts start position, indexed by depth.
+const uint64_t s_internationalNodeCounts[] =
+{
+	1,
+	9,
+	81,
+	658,
+	4265,
+	27117,
+	167140,
+	1049442,
+	6483961,
+	41022423,
+	258895763,
+};
+
+const int s_maxKnownInternationalDepth =
+	sizeof(s_internationalNodeCounts) / sizeof(s_internationalNodeCounts[0]) - 1;
+
+struct PerftOptions
+{
+	PerftOptions()
+		: m_depth(s_defaultDepth)
+		, m_position(Position::CreateStartPosition())
+		, m_isStartPosition(true)
+		, m_shouldDivide(false)
+		, m_shouldVerify(false)
+	{
+	}
+
+	int m_depth;
+	Position m_position;
+	bool m_isStartPosition;
+	bool m_shouldDivide;
+	bool m_shouldVerify;
+
+	// Rule set counted through VariantPerft, empty for the 8x8 Position.
+	std::string m_variant;
+};
+
+void PrintUsage()
+{
+	std::printf("usage: perft [depth] [--fen <fen>] [--divide] [--verify] [--variant <name>]\n"
+		"  depth      depth to count to, defaults to %d\n"
+		"  --fen      count from this position instead of the start position\n"
+		"  --divide   print the node count below every root move at the final depth\n"
+		"  --verify   compare start position counts against published results\n"
+		"  --variant  count the start position of english (8x8), international (10x10) or\n"
+		"             canadian (12x12) draughts with the generic variant generator\n", s_defaultDepth);
+}
+
+bool ParseOptions(int argc, char** argv, PerftOptions& optionsOut)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument(argv[i]);
+		if (argument == "--fen" && i + 1 < argc)
+		{
+			if (!Position::FromFen(argv[++i], optionsOut.m_position))
+			{
+				std::fprintf(stderr, "Error: malformed FEN \"%s\"\n", argv[i]);
+				return false;
+			}
+
+			optionsOut.m_isStartPosition = false;
+		}
+		else if (argument == "--divide")
+		{
+			optionsOut.m_shouldDivide = true;
+		}
+		else if (argument == "--verify")
+		{
+			optionsOut.m_shouldVerify = true;
+		}
+		else if (argument == "--variant" && i + 1 < argc)
+		{
+			optionsOut.m_variant = argv[++i];
+		}
+		else if (!argument.empty() && argument[0] != '-')
+		{
+			optionsOut.m_depth = std::atoi(argument.c_str());
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return optionsOut.m_depth > 0;
+}
+
+double GetSecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+uint64_t GetInternationalNodeCount(int depth)
+{
+	if (depth < 0 || depth > s_maxKnownInternationalDepth)
+		return 0;
+
+	return s_internationalNodeCounts[depth];
+}
+
+uint64_t GetUnknownNodeCount(int /*depth*/)
+{
+	return 0;
+}
+
+// Counts every depth up to the requested one, printing a line per depth. Returns false if a count
+// differs from its published result.
+template <class CountFunction>
+bool PrintNodeCounts(const PerftOptions& options, CountFunction countNodes, uint64_t (*getExpectedCount)(int))
+{
+	std::printf("%5s %16s %10s %14s\n", "depth", "nodes", "seconds", "nodes/sec");
+
+	bool hasMismatch = false;
+	for (int depth = 1; depth <= options.m_depth; ++depth)
+	{
+		auto start = std::chrono::steady_clock::now();
+		uint64_t nodes = countNodes(depth);
+		double seconds = GetSecondsSince(start);
+
+		std::printf("%5d %16llu %10.3f %14.0f", depth, static_cast<unsigned long long>(nodes), seconds,
+			seconds > 0.0 ? nodes / seconds : 0.0);
+
+		if (options.m_shouldVerify)
+		{
+			uint64_t expected = getExpectedCount(depth);
+			if (expected == 0)
+			{
+				std::printf("  (no published count)");
+			}
+			else if (expected == nodes)
+			{
+				std::printf("  ok");
+			}
+			else
+			{
+				std::printf("  MISMATCH, expected %llu", static_cast<unsigned long long>(expected));
+				hasMismatch = true;
+			}
+		}
+
+		std::printf("\n");
+		std::fflush(stdout);
+	}
+
+	return !hasMismatch;
+}
+
+template <class Rules>
+bool PrintVariantNodeCounts(const PerftOptions& options, uint64_t (*getExpectedCount)(int))
+{
+	std::printf("%s draughts, %dx%d start position\n\n", options.m_variant.c_str(), Rules::s_boardSize,
+		Rules::s_boardSize);
+
+	VariantPerft<Rules> perft;
+	VariantPosition<Rules> position = VariantPosition<Rules>::CreateStartPosition();
+	return PrintNodeCounts(options, [&](int depth) { return perft.CountNodes(position, depth); },
+		getExpectedCount);
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+	PerftOptions options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	if (!options.m_variant.empty())
+	{
+		if (!options.m_isStartPosition || options.m_shouldDivide)
+		{
+			std::fprintf(stderr, "Error: --variant only counts the start position, without --divide\n");
+			return 1;
+		}
+
+		bool isMatch = false;
+		if (options.m_variant == "english")
+		{
+			isMatch = PrintVariantNodeCounts<EnglishRules>(options, Perft::GetStartPositionNodeCount);
+		}
+		else if (options.m_variant == "international")
+		{
+			isMatch = PrintVariantNodeCounts<InternationalRules>(options, GetInternationalNodeCount);
+		}
+		else if (options.m_variant == "canadian")
+		{
+			isMatch = PrintVariantNodeCounts<CanadianRules>(options, GetUnknownNodeCount);
+		}
+		else
+		{
+			std::fprintf(stderr, "Error: unknown variant \"%s\"\n", options.m_variant.c_str());
+			return 1;
+		}
+
+		return isMatch ? 0 : 2;
+	}
+
+	if (options.m_shouldVerify && !options.m_isStartPosition)
+	{
+		std::fprintf(stderr, "Error: --verify only knows the start position\n");
+		return 1;
+	}
+
+	std::printf("%s%s\n\n", options.m_position.ToString().c_str(), options.m_position.ToFen().c_str());
+
+	Perft perft;
+	bool isMatch = PrintNodeCounts(options,
+		[&](int depth) { return perft.CountNodes(options.m_position, depth); }, Perft::GetStartPositionNodeCount);
+
+	if (options.m_shouldDivide)
+	{
+		std::printf("\ndivide at depth %d\n", options.m_depth);
+
+		uint64_t total = 0;
+		auto divide = perft.Divide(options.m_position, options.m_depth);
+		for (const auto& entry : divide)
+		{
+			std::printf("%-24s %16llu\n", entry.first.c_str(), static_cast<unsigned long long>(entry.second));
+			total += entry.second;
+		}
+
+		std::printf("%d moves, %llu nodes\n", static_cast<int>(divide.size()),
+			static_cast<unsigned long long>(total));
+	}
+
+	return isMatch ? 0 : 2;
+}
@@ -0,0 +1,188 @@
+//---------------------------------------------------------------
+//
+// Position.cpp
+//
+
+#include "Position.h"
+
+#include <cctype>
+
+Position::Position()
+	: m_whitePieces(0)
+	, m_blackPieces(0)
+	, m_kings(0)
+	, m_isWhitePlayerTurn(true)
+{
+}
+
+Position Position::CreateStartPosition()
+{
+	// White fills the top three rows and black the bottom three, white moves first.
+	Position position;
+	position.m_whitePieces = 0x00000FFF;
+	position.m_blackPieces = 0xFFF00000;
+	return position;
+}
+
+void Position::SetPiece(int square, PieceDisplayType piece)
+{
+	Bitboard mask = SquareMask(square);
+	m_whitePieces &= ~mask;
+	m_blackPieces &= ~mask;
+	m_kings &= ~mask;
+
+	switch (piece)
+	{
+	case WHITE_KING:
+		m_kings |= mask;
+		// Fall through.
+	case WHITE:
+		m_whitePieces |= mask;
+		break;
+	case BLACK_KING:
+		m_kings |= mask;
+		// Fall through.
+	case BLACK:
+		m_blackPieces |= mask;
+		break;
+	case EMPTY:
+	default:
+		break;
+	}
+}
+
+std::string Position::ToString() const
+{
+	std::string result;
+	for (int row = 0; row < s_boardSize; ++row)
+	{
+		for (int col = 0; col < s_boardSize; ++col)
+		{
+			int square = SquareFromBoardIndex(BoardIndex(row, col));
+			if (square < 0)
+			{
+				result += ' ';
+				continue;
+			}
+
+			switch (GetPiece(square))
+			{
+			case WHITE: result += 'w'; break;
+			case WHITE_KING: result += 'W'; break;
+			case BLACK: result += 'b'; break;
+			case BLACK_KING: result += 'B'; break;
+			default: result += '.'; break;
+			}
+		}
+		result += '\n';
+	}
+
+	result += m_isWhitePlayerTurn ? "White to move\n" : "Black to move\n";
+	return result;
+}
+
+std::string Position::ToFen() const
+{
+	std::string fen(m_isWhitePlayerTurn ? "W" : "B");
+
+	Bitboard sides[] = { m_whitePieces, m_blackPieces };
+	const char* sideNames[] = { ":W", ":B" };
+	for (int side = 0; side < 2; ++side)
+	{
+		fen += sideNames[side];
+
+		bool isFirst = true;
+		for (Bitboard pieces = sides[side]; pieces; pieces &= pieces - 1)
+		{
+			int square = GetLowestSquare(pieces);
+			if (!isFirst)
+				fen += ',';
+
+			if (m_kings & SquareMask(square))
+				fen += 'K';
+
+			fen += std::to_string(square + 1);
+			isFirst = false;
+		}
+	}
+
+	return fen;
+}
+
+bool Position::FromFen(const std::string& fen, Position& positionOut)
+{
+	// Ignore whitespace and quotes so a FEN tag value can be passed through as is.
+	std::string text;
+	for (char c : fen)
+	{
+		if (!std::isspace(static_cast<unsigned char>(c)) && c != '"' && c != '.')
+			text += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+	}
+
+	if (text.size() < 1 || (text[0] != 'W' && text[0] != 'B'))
+		return false;
+
+	Position position;
+	position.m_isWhitePlayerTurn = text[0] == 'W';
+
+	size_t cursor = 1;
+	while (cursor < text.size())
+	{
+		if (text[cursor] != ':' || cursor + 1 >= text.size())
+			return false;
+
+		char side = text[cursor + 1];
+		if (side != 'W' && side != 'B')
+			return false;
+
+		cursor += 2;
+		while (cursor < text.size() && text[cursor] != ':')
+		{
+			if (text[cursor] == ',')
+			{
+				++cursor;
+				continue;
+			}
+
+			bool isKing = text[cursor] == 'K';
+			if (isKing)
+				++cursor;
+
+			// A single square or a range such as 1-12.
+			int first = 0;
+			int last = 0;
+			size_t digits = cursor;
+			while (cursor < text.size() && std::isdigit(static_cast<unsigned char>(text[cursor])))
+				first = first * 10 + (text[cursor++] - '0');
+
+			if (cursor == digits)
+				return false;
+
+			last = first;
+			if (cursor < text.size() && text[cursor] == '-')
+			{
+				digits = ++cursor;
+				last = 0;
+				while (cursor < text.size() && std::isdigit(static_cast<unsigned char>(text[cursor])))
+					last = last * 10 + (text[cursor++] - '0');
+
+				if (cursor == digits)
+					return false;
+			}
+
+			if (first < 1 || last > s_squareCount || first > last)
+				return false;
+
+			for (int square = first - 1; square < last; ++square)
+			{
+				if (side == 'W')
+					position.SetPiece(square, isKing ? WHITE_KING : WHITE);
+				else
+					position.SetPiece(square, isKing ? BLACK_KING : BLACK);
+			}
+		}
+	}
+
+	positionOut = position;
+	return true;
+}
@@ -0,0 +1,263 @@
+//---------------------------------------------------------------
+//
+// Position.h
+//
+
+#pragma once
+
+#include "CheckersTypes.h"
+
+#include <cstdint>
+#include <string>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// One bit per playable square.
+typedef uint32_t Bitboard;
+
+namespace {
+	const int s_squareCount = 32;
+	const int s_squaresPerRow = s_boardSize / 2;
+
+	// Crowning rows.
+	const Bitboard s_topRow = 0x0000000F;
+	const Bitboard s_bottomRow = 0xF0000000;
+}
+
+// Playable squares are numbered 0-31 row by row, starting at the top left of the board.
+// Even rows have their playable squares on the odd columns, odd rows on the even columns.
+inline int SquareFromBoardIndex(const BoardIndex& boardIndex)
+{
+	int row = boardIndex.first;
+	int col = boardIndex.second;
+	if (row < 0 || row >= s_boardSize || col < 0 || col >= s_boardSize || !((row + col) & 1))
+		return -1;
+
+	return row * s_squaresPerRow + col / 2;
+}
+
+inline BoardIndex BoardIndexFromSquare(int square)
+{
+	int row = square / s_squaresPerRow;
+	return BoardIndex(row, 2 * (square % s_squaresPerRow) + ((row & 1) ^ 1));
+}
+
+inline Bitboard SquareMask(int square)
+{
+	return Bitboard(1) << square;
+}
+
+// Returns the lowest set square. The bitboard must not be empty.
+inline int GetLowestSquare(Bitboard bitboard)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, bitboard);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctz(bitboard);
+#endif
+}
+
+inline int GetSquareCount(Bitboard bitboard)
+{
+#if defined(_MSC_VER)
+	return static_cast<int>(__popcnt(bitboard));
+#else
+	return __builtin_popcount(bitboard);
+#endif
+}
+
+//---------------------------------------------------------------
+
+// Everything a move changes besides the moving piece, so UnmakeMove can restore the position
+// exactly. Fixed size, a search keeps one per ply on its stack.
+struct UndoRecord
+{
+	// Captured pieces, and the kings among them. They belong to the opponent of the mover.
+	Bitboard m_capturedPieces;
+	Bitboard m_capturedKings;
+
+	int8_t m_source;
+	int8_t m_destination;
+
+	bool m_isCrowned;
+
+	// Whether the move ended the turn, false for a hop in the middle of a capture chain.
+	bool m_isTurnEnd;
+};
+
+//---------------------------------------------------------------
+
+// A complete checkers position packed into three bitboards and the side to move. It is trivially
+// copyable, so snapshotting, comparing and hashing a position are a handful of register operations.
+struct Position
+{
+	Position();
+
+	// Returns the position Game::Setup starts every game from.
+	static Position CreateStartPosition();
+
+	PieceDisplayType GetPiece(int square) const;
+	void SetPiece(int square, PieceDisplayType piece);
+
+	// Moves the piece on source to destination, crowning a man that reaches the far row.
+	// Returns true if the piece was crowned by this move.
+	bool MovePiece(int source, int destination);
+
+	// Clears the square, used for captured pieces.
+	void RemovePiece(int square);
+
+	// Moves the piece on source to destination and removes the captured pieces, crowning a man
+	// that reaches the far row. The turn passes to the opponent unless isTurnEnd is false. What
+	// changed is written to the undo record.
+	void MakeMove(int source, int destination, Bitboard capturedPieces, UndoRecord& undoOut,
+		bool isTurnEnd = true);
+
+	// Takes back the move the undo record was made for. Moves must be taken back in reverse order.
+	void UnmakeMove(const UndoRecord& undo);
+
+	Bitboard GetOccupied() const { return m_whitePieces | m_blackPieces; }
+	Bitboard GetEmpty() const { return ~GetOccupied(); }
+
+	// Pieces belonging to the side to move and to its opponent.
+	Bitboard GetPlayerPieces() const { return m_isWhitePlayerTurn ? m_whitePieces : m_blackPieces; }
+	Bitboard GetEnemyPieces() const { return m_isWhitePlayerTurn ? m_blackPieces : m_whitePieces; }
+
+	// Mixes the three bitboards and the side to move into a 64-bit key.
+	uint64_t GetHash() const;
+
+	bool operator==(const Position& other) const;
+	bool operator!=(const Position& other) const { return !(*this == other); }
+
+	// Debug representation, one text row per board row.
+	std::string ToString() const;
+
+	// FEN as used by PDN, e.g. "W:W1-12:B21-32" for the start position. Squares are numbered 1-32
+	// from the top left, and colors are the ones of this game: white starts on top and moves first.
+	std::string ToFen() const;
+
+	// Parses a FEN string, returning false and leaving the output untouched if it is malformed.
+	static bool FromFen(const std::string& fen, Position& positionOut);
+
+	// Every white piece, including kings.
+	Bitboard m_whitePieces;
+
+	// Every black piece, including kings.
+	Bitboard m_blackPieces;
+
+	// Kings of either color.
+	Bitboard m_kings;
+
+	bool m_isWhitePlayerTurn;
+};
+
+//---------------------------------------------------------------
+
+inline PieceDisplayType Position::GetPiece(int square) const
+{
+	Bitboard mask = SquareMask(square);
+	bool isKing = (m_kings & mask) != 0;
+	if (m_whitePieces & mask)
+		return isKing ? WHITE_KING : WHITE;
+	if (m_blackPieces & mask)
+		return isKing ? BLACK_KING : BLACK;
+	return EMPTY;
+}
+
+inline bool Position::MovePiece(int source, int destination)
+{
+	Bitboard sourceMask = SquareMask(source);
+	Bitboard destinationMask = SquareMask(destination);
+	Bitboard moveMask = sourceMask | destinationMask;
+
+	bool isWhite = (m_whitePieces & sourceMask) != 0;
+	if (isWhite)
+		m_whitePieces ^= moveMask;
+	else
+		m_blackPieces ^= moveMask;
+
+	if (m_kings & sourceMask)
+	{
+		m_kings ^= moveMask;
+		return false;
+	}
+
+	// White men crown on the bottom row, black men on the top row.
+	Bitboard crownSquares = isWhite ? s_bottomRow : s_topRow;
+	m_kings |= destinationMask & crownSquares;
+	return (destinationMask & crownSquares) != 0;
+}
+
+inline void Position::RemovePiece(int square)
+{
+	Bitboard mask = ~SquareMask(square);
+	m_whitePieces &= mask;
+	m_blackPieces &= mask;
+	m_kings &= mask;
+}
+
+inline void Position::MakeMove(int source, int destination, Bitboard capturedPieces, UndoRecord& undoOut,
+	bool isTurnEnd)
+{
+	undoOut.m_capturedPieces = capturedPieces;
+	undoOut.m_capturedKings = capturedPieces & m_kings;
+	undoOut.m_source = static_cast<int8_t>(source);
+	undoOut.m_destination = static_cast<int8_t>(destination);
+	undoOut.m_isTurnEnd = isTurnEnd;
+
+	m_whitePieces &= ~capturedPieces;
+	m_blackPieces &= ~capturedPieces;
+	m_kings &= ~capturedPieces;
+
+	// A king's capture chain may end where it started.
+	undoOut.m_isCrowned = source != destination && MovePiece(source, destination);
+
+	if (isTurnEnd)
+		m_isWhitePlayerTurn = !m_isWhitePlayerTurn;
+}
+
+inline void Position::UnmakeMove(const UndoRecord& undo)
+{
+	if (undo.m_isTurnEnd)
+		m_isWhitePlayerTurn = !m_isWhitePlayerTurn;
+
+	Bitboard destinationMask = SquareMask(undo.m_destination);
+	Bitboard moveMask = undo.m_source != undo.m_destination ? SquareMask(undo.m_source) | destinationMask : 0;
+
+	if (undo.m_isCrowned)
+		m_kings ^= destinationMask;
+	else if (m_kings & destinationMask)
+		m_kings ^= moveMask;
+
+	// The mover is the side to move again, the captured pieces go back to its opponent.
+	if (m_isWhitePlayerTurn)
+	{
+		m_whitePieces ^= moveMask;
+		m_blackPieces |= undo.m_capturedPieces;
+	}
+	else
+	{
+		m_blackPieces ^= moveMask;
+		m_whitePieces |= undo.m_capturedPieces;
+	}
+
+	m_kings |= undo.m_capturedKings;
+}
+
+inline uint64_t Position::GetHash() const
+{
+	uint64_t key = (uint64_t(m_whitePieces) << 32 | m_blackPieces) ^ (uint64_t(m_kings) * 0x9E3779B97F4A7C15ull);
+	key ^= m_isWhitePlayerTurn ? 0xD6E8FEB86659FD93ull : 0;
+	key ^= key >> 32;
+	key *= 0xD6E8FEB86659FD93ull;
+	return key ^ (key >> 32);
+}
+
+inline bool Position::operator==(const Position& other) const
+{
+	return m_whitePieces == other.m_whitePieces && m_blackPieces == other.m_blackPieces
+		&& m_kings == other.m_kings && m_isWhitePlayerTurn == other.m_isWhitePlayerTurn;
+}
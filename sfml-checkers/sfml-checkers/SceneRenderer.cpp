@@ -8,10 +8,27 @@
 #include "Log.h"
 
 #include <assert.h>
+#include <cmath>
+
+namespace {
+	// Triangles approximating the outline of a piece, as many as sf::CircleShape uses by default.
+	const int s_pieceSegmentCount = 30;
+
+	void AppendTriangle(sf::VertexArray& vertices, const sf::Vector2f& a, const sf::Vector2f& b,
+		const sf::Vector2f& c, const sf::Color& color)
+	{
+		vertices.append(sf::Vertex(a, color));
+		vertices.append(sf::Vertex(b, color));
+		vertices.append(sf::Vertex(c, color));
+	}
+}
 
 SceneRenderer::SceneRenderer(sf::RenderTarget& target, Game* game)
 	: m_renderTarget(&target)
 	, m_game(game)
+	, m_boardVertices(sf::Triangles)
+	, m_pieceVertices(sf::Triangles)
+	, m_arePiecesBuilt(false)
 {
 	BuildBoardBackground();
 }
@@ -28,31 +45,6 @@ void SceneRenderer::Draw()
 	DrawBoardPieces();
 }
 
-void SceneRenderer::OnMouseClick(sf::Vector2i localPosition)
-{
-	// TODO:  SceneRenderer should not be handling input.
-
-	float localX = static_cast<float>(localPosition.x);
-	float localY = static_cast<float>(localPosition.y);
-	LOG_DEBUG_OUTPUT_WINDOW("Mouse button Clicked: (" + std::to_string(localX) + " , "
-		+ std::to_string(localY) + ") ");
-
-	// Find the square that I clicked
-	auto it = std::find_if(m_checkersSquares.begin(), m_checkersSquares.end(),
-		[this, &localX, &localY](const CheckersSquare& currentSquare)
-	{
-		return currentSquare.m_square.getGlobalBounds().contains(localX, localY);
-	});
-
-	// Notify game of a move selection event
-	m_game->OnMoveSelectionEvent(it->m_boardIndex);
-
-	if (it == m_checkersSquares.end())
-	{
-		LOG_DEBUG_OUTPUT_WINDOW("Failed to find a valid location.");
-	}
-}
-
 void SceneRenderer::BuildBoardBackground()
 {
 	std::vector<sf::Color> colorPalette(s_boardSize);
@@ -71,12 +63,12 @@ void SceneRenderer::BuildBoardBackground()
 	{
 		for (int col = 0; col < s_boardSize; ++col)
 		{
-			sf::RectangleShape currentSquare = sf::RectangleShape(sf::Vector2f(s_squareSize, s_squareSize));
-			currentSquare.setPosition(row * s_squareSize, col * s_squareSize);
-			currentSquare.setFillColor(colorPalette[col]);
-
-			CheckersSquare square(currentSquare, m_game->GetBoardIndexFromRowCol(row, col));
-			m_checkersSquares.push_back(square);
+			sf::Vector2f topLeft(row * s_squareSize, col * s_squareSize);
+			sf::Vector2f topRight(topLeft.x + s_squareSize, topLeft.y);
+			sf::Vector2f bottomLeft(topLeft.x, topLeft.y + s_squareSize);
+			sf::Vector2f bottomRight(topLeft.x + s_squareSize, topLeft.y + s_squareSize);
+			AppendTriangle(m_boardVertices, topLeft, topRight, bottomRight, colorPalette[col]);
+			AppendTriangle(m_boardVertices, topLeft, bottomRight, bottomLeft, colorPalette[col]);
 		}
 
 		// Reverse the color palette to make the checker effect.
@@ -84,75 +76,64 @@ void SceneRenderer::BuildBoardBackground()
 	}
 }
 
-void SceneRenderer::DrawBoardBackground()
+void SceneRenderer::BuildBoardPieces(const Position& position)
 {
-	for (auto it = m_checkersSquares.begin(); it != m_checkersSquares.end(); ++it)
+	m_pieceVertices.clear();
+
+	// Only occupied squares are visited, empty squares are never drawn.
+	for (Bitboard pieces = position.GetOccupied(); pieces; pieces &= pieces - 1)
 	{
-		m_renderTarget->draw(it->m_square);
-	}
-}
+		int square = GetLowestSquare(pieces);
+		BoardIndex boardIndex = BoardIndexFromSquare(square);
 
-void SceneRenderer::DrawBoardPieces()
-{
-	const BoardData& boardData = m_game->GetBoardData();
-	float yPieceSpacing = 75;
-	float xPieceSpacing = 75;
-	float xBorderPadding = 25;
-	float yBorderPadding = 25;
+		sf::Vector2f center((boardIndex.second + 0.5f) * s_squareSize, (boardIndex.first + 0.5f) * s_squareSize);
+		sf::Color color = GetPieceColor(position.GetPiece(square));
 
-	for (auto row = boardData.begin(); row != boardData.end(); ++row)
-	{
-		int rowNumber = std::distance(boardData.begin(), row);
-		for (auto col = row->begin(); col != row->end(); ++col)
+		sf::Vector2f previousPoint(center.x, center.y - s_pieceSize);
+		for (int i = 1; i <= s_pieceSegmentCount; ++i)
 		{
-			// This is a super lightweight object containing only data needed for OpenGL calls.
-			// Its fine to construct and destroy in this loop. I'm also okay with creating one for
-			// empty spaces, as it simplifies this code quite a bit.
-			sf::CircleShape piece(s_pieceSize);
+			float angle = i * 2.0f * 3.14159265f / s_pieceSegmentCount;
+			sf::Vector2f point(center.x + s_pieceSize * std::sin(angle), center.y - s_pieceSize * std::cos(angle));
+			AppendTriangle(m_pieceVertices, center, previousPoint, point, color);
+			previousPoint = point;
+		}
+	}
 
-			int columnNumber = std::distance(row->begin(), col);
-			piece.setPosition(xBorderPadding + ((s_pieceSize + xPieceSpacing) * columnNumber),
-				yBorderPadding + ((s_pieceSize + yPieceSpacing) * rowNumber));
+	m_piecesPosition = position;
+	m_arePiecesBuilt = true;
+}
 
-			ApplyPieceColor(*col, piece);
+void SceneRenderer::DrawBoardBackground()
+{
+	m_renderTarget->draw(m_boardVertices);
+}
 
-			m_renderTarget->draw(piece);
-		}
-	}
+void SceneRenderer::DrawBoardPieces()
+{
+	const Position& position = m_game->GetPosition();
+	if (!m_arePiecesBuilt || position != m_piecesPosition)
+		BuildBoardPieces(position);
+
+	m_renderTarget->draw(m_pieceVertices);
 }
 
-void SceneRenderer::ApplyPieceColor(PieceDisplayType pieceDisplayType, sf::CircleShape& piece)
+sf::Color SceneRenderer::GetPieceColor(PieceDisplayType pieceDisplayType) const
 {
 	switch (pieceDisplayType)
 	{
 	case BLACK:
-		piece.setFillColor(sf::Color(117, 69, 57, 255));
-		break;
+		return sf::Color(117, 69, 57, 255);
 	case WHITE:
-		piece.setFillColor(sf::Color(246, 221, 190, 255));
-		break;
+		return sf::Color(246, 221, 190, 255);
 	case BLACK_KING:
-		piece.setFillColor(sf::Color(51, 33, 28, 255));
-		break;
+		return sf::Color(51, 33, 28, 255);
 	case WHITE_KING:
-		piece.setFillColor(sf::Color(230, 230, 230, 255));
 		// TODO
-		break;
-	case EMPTY:
-		// Do not draw blank spaces.
-		piece.setFillColor(sf::Color(0, 0, 0, 0));
-		break;
+		return sf::Color(230, 230, 230, 255);
 	default:
 		// This should never be the case. If we do have an unknown piece type, I am enforcing that
 		// it is added to this switch.
 		assert(0);
+		return sf::Color(0, 0, 0, 0);
 	}
 }
-
-//--------------------------------------------------------------------------------------------------------
-
-CheckersSquare::CheckersSquare(const sf::RectangleShape square, const BoardIndex& boardIndex)
-	: m_square(square)
-	, m_boardIndex(boardIndex)
-{
-}
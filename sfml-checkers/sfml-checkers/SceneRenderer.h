@@ -6,12 +6,16 @@
 #pragma once
 
 #include "CheckersTypes.h"
+#include "Position.h"
 
 #include <SFML/Graphics.hpp>
 
+#include <vector>
+
 class Game;
-struct CheckersSquare;
 
+// Draws the board and the pieces in two draw calls. The board is baked into one vertex array up
+// front, the pieces into another that is only rebuilt when the position changes.
 class SceneRenderer
 {
 public:
@@ -19,27 +23,23 @@ public:
 	~SceneRenderer();
 
 	void Draw();
-	void OnMouseClick(sf::Vector2i localPosition);
 
 private:
 	void BuildBoardBackground();
+	void BuildBoardPieces(const Position& position);
 	void DrawBoardBackground();
 	void DrawBoardPieces();
 
-	void ApplyPieceColor(PieceDisplayType pieceDisplayType, sf::CircleShape& piece);
+	sf::Color GetPieceColor(PieceDisplayType pieceDisplayType) const;
 
 	sf::RenderTarget* m_renderTarget;
-	std::vector<CheckersSquare> m_checkersSquares;
 	Game* m_game;
-};
-
-struct CheckersSquare
-{
-	CheckersSquare(const sf::RectangleShape square, const BoardIndex& boardIndex);
 
-	// The drawable representation of the CheckersSquare.
-	sf::RectangleShape m_square;
+	// Two triangles per square.
+	sf::VertexArray m_boardVertices;
 
-	// Where on the board is this square in row, col.
-	BoardIndex m_boardIndex;
+	// A fan of triangles per piece, for the position in m_piecesPosition.
+	sf::VertexArray m_pieceVertices;
+	Position m_piecesPosition;
+	bool m_arePiecesBuilt;
 };
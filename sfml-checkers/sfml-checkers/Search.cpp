@@ -0,0 +1,857 @@
+//---------------------------------------------------------------
+//
+// Search.cpp
+//
+
+#include "Search.h"
+#include "Evaluation.h"
+#include "MoveGenerator.h"
+#include "NeuralNetwork.h"
+#include "OpeningBook.h"
+#include "Tablebase.h"
+#include "Zobrist.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+//==============================================================================
+
+const int s_infinity = 1000000;
+const int s_winScore = 100000;
+
+// Tablebase wins the win scores cannot express are scored this much plus the evaluation, so the
+// winning side still heads for better positions.
+const int s_tablebaseWinScore = s_winScore / 2;
+
+// Half width of the window around the previous iteration's score.
+const int s_aspirationWindow = 50;
+
+// Limits are checked every this many nodes.
+const uint64_t s_stopCheckInterval = 2048;
+
+// Move ordering buckets. The best move stored for the position goes first, then captures, then
+// killers, then quiet moves by history.
+const int s_hashMoveOrderingScore = 1 << 30;
+const int s_captureOrderingScore = 1 << 28;
+const int s_killerOrderingScore = 1 << 26;
+
+int EncodeMove(const PackedMove& move)
+{
+	return move.GetSource() * s_squareCount + move.GetDestination();
+}
+
+int EncodeMove(const SearchMove& move)
+{
+	return EncodeMove(move.m_move);
+}
+
+void SetBestMove(const Position& position, const SearchMove& move, SearchResult& resultOut)
+{
+	resultOut.m_bestTurn = move.m_move;
+	resultOut.m_bestMove.clear();
+	for (int square : MoveGenerator::GetPath(position, move.m_move))
+	{
+		resultOut.m_bestMove.push_back(BoardIndexFromSquare(square));
+	}
+}
+
+// Win scores are stored relative to the node instead of the root, so they stay correct when the
+// position is reached at another ply.
+int ScoreToTable(int score, int ply)
+{
+	if (score >= s_winScore - s_maxSearchPly)
+		return score + ply;
+	if (score <= -s_winScore + s_maxSearchPly)
+		return score - ply;
+	return score;
+}
+
+int ScoreFromTable(int score, int ply)
+{
+	if (score >= s_winScore - s_maxSearchPly)
+		return score - ply;
+	if (score <= -s_winScore + s_maxSearchPly)
+		return score + ply;
+	return score;
+}
+
+// Score of a tablebase result for the side to move. A win with a known distance that fits within
+// the search plies scores as if the search had found it.
+int GetTablebaseScore(const Position& position, TablebaseResult result, int distance, bool hasDistances, int ply)
+{
+	if (result == TABLEBASE_DRAW)
+		return 0;
+
+	int sign = result == TABLEBASE_WIN ? 1 : -1;
+	if (hasDistances && ply + distance < s_maxSearchPly)
+		return sign * (s_winScore - ply - distance);
+
+	return sign * s_tablebaseWinScore + Evaluation::Evaluate(position);
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+SearchLimits::SearchLimits()
+	: m_maxDepth(0)
+	, m_moveTimeMs(1000)
+	, m_maxNodes(0)
+	, m_stopFlag(nullptr)
+{
+}
+
+SearchResult::SearchResult()
+	: m_bestTurn(0, 0, 0)
+	, m_score(0)
+	, m_depth(0)
+	, m_nodes(0)
+	, m_seconds(0.0)
+	, m_nodesPerSecond(0.0)
+	, m_effectiveBranchingFactor(0.0)
+	, m_hashHitRate(0.0)
+	, m_hashCollisionRate(0.0)
+	, m_tablebaseHits(0)
+	, m_isBookMove(false)
+	, m_ponderTurn(0, 0, 0)
+	, m_hasPonderTurn(false)
+{
+}
+
+//---------------------------------------------------------------
+
+// Everything one thread needs to search on its own: move lists, ordering tables and statistics.
+// The transposition table and the stop flag are the only state threads share.
+class SearchThread
+{
+public:
+	SearchThread(TranspositionTable& transpositionTable, std::atomic<bool>& isSearchStopped);
+
+	// Clears the ordering tables and counters for a new search. A node budget of zero is no limit,
+	// the partition is the part of the transposition table this thread works in.
+	void Start(const SearchLimits& limits, std::chrono::steady_clock::time_point startTime,
+		uint64_t nodeBudget, int partition);
+
+	// Positions with at most this many pieces are probed in the tablebase, none without one.
+	void SetTablebase(const Tablebase* tablebase, int maxPieces);
+
+	// Scores positions with the network, or with Evaluation::Evaluate if null.
+	void SetNetwork(const NeuralNetwork* network);
+
+	// Iterative deepening over m_rootMoves, until the last depth is done or the search stops.
+	void SearchIteratively(int firstDepth, int lastDepth);
+
+	int SearchRoot(int depth, int alpha, int beta);
+
+	// Fills the move list of the ply with every legal turn. Child keys are updated incrementally
+	// from the key of the position.
+	std::vector<SearchMove>& GenerateTurns(const Position& position, uint64_t key, int ply);
+
+	// The position searched from, made and unmade in place while searching, and the root moves
+	// this thread searches. After an iteration the best one is m_rootBestIndex.
+	Position m_rootPosition;
+	std::vector<SearchMove> m_rootMoves;
+	int m_rootBestIndex;
+
+	// Deepest iteration SearchIteratively completed and its score.
+	int m_completedDepth;
+	int m_completedScore;
+
+	uint64_t m_nodes;
+	uint64_t m_hashProbes;
+	uint64_t m_hashHits;
+	uint64_t m_hashCollisions;
+	uint64_t m_tablebaseHits;
+	bool m_isStopped;
+
+private:
+	int Negamax(Position& position, uint64_t key, int depth, int ply, int alpha, int beta);
+
+	// Makes the turn of the position at the ply. With a network the accumulator of the next ply is
+	// updated from this one's, taking the turn back needs nothing as this one is left as it was.
+	void MakeSearchMove(Position& position, const SearchMove& move, int ply, UndoRecord& undoOut);
+
+	int Evaluate(const Position& position, int ply) const;
+
+	void ScoreMoves(std::vector<SearchMove>& moves, int ply, int hashMove);
+	void PickNextMove(std::vector<SearchMove>& moves, size_t index);
+	void RecordCutoff(const SearchMove& move, int depth, int ply);
+
+	// Checks the stop flag and the time and node limits every few thousand nodes.
+	bool ShouldStop();
+
+	TranspositionTable& m_transpositionTable;
+	std::atomic<bool>& m_isSearchStopped;
+
+	const Tablebase* m_tablebase;
+	int m_tablebasePieces;
+
+	// Accumulators of the positions on the current path, one per ply, used with a network only.
+	const NeuralNetwork* m_network;
+	std::vector<NetworkAccumulator> m_accumulators;
+
+	SearchLimits m_limits;
+	std::chrono::steady_clock::time_point m_startTime;
+	uint64_t m_nodeBudget;
+	int m_partition;
+
+	// Quiet moves that caused a cutoff, two per ply, encoded as source * 32 + destination.
+	int m_killerMoves[s_maxSearchPly][2];
+
+	// Cutoff counts indexed by source and destination square.
+	int m_history[s_squareCount][s_squareCount];
+
+	// Move list storage, one per ply so nothing is allocated while searching.
+	std::vector<std::vector<SearchMove>> m_moveLists;
+
+	// MoveGenerator output, turned into the move list of the ply right away.
+	MoveList m_generatorList;
+};
+
+SearchThread::SearchThread(TranspositionTable& transpositionTable, std::atomic<bool>& isSearchStopped)
+	: m_rootBestIndex(0)
+	, m_completedDepth(0)
+	, m_completedScore(0)
+	, m_nodes(0)
+	, m_hashProbes(0)
+	, m_hashHits(0)
+	, m_hashCollisions(0)
+	, m_tablebaseHits(0)
+	, m_isStopped(false)
+	, m_transpositionTable(transpositionTable)
+	, m_isSearchStopped(isSearchStopped)
+	, m_tablebase(nullptr)
+	, m_tablebasePieces(0)
+	, m_network(nullptr)
+	, m_accumulators(s_maxSearchPly + 1)
+	, m_nodeBudget(0)
+	, m_partition(0)
+	, m_moveLists(s_maxSearchPly + 1)
+{
+	for (std::vector<SearchMove>& moves : m_moveLists)
+	{
+		moves.reserve(32);
+	}
+}
+
+void SearchThread::Start(const SearchLimits& limits, std::chrono::steady_clock::time_point startTime,
+	uint64_t nodeBudget, int partition)
+{
+	m_limits = limits;
+	m_startTime = startTime;
+	m_nodeBudget = nodeBudget;
+	m_partition = partition;
+	m_nodes = 0;
+	m_hashProbes = 0;
+	m_hashHits = 0;
+	m_hashCollisions = 0;
+	m_tablebaseHits = 0;
+	m_isStopped = false;
+	m_rootBestIndex = 0;
+	m_completedDepth = 0;
+	m_completedScore = 0;
+
+	std::fill(&m_killerMoves[0][0], &m_killerMoves[0][0] + s_maxSearchPly * 2, -1);
+	std::fill(&m_history[0][0], &m_history[0][0] + s_squareCount * s_squareCount, 0);
+}
+
+void SearchThread::SetTablebase(const Tablebase* tablebase, int maxPieces)
+{
+	m_tablebase = tablebase;
+	m_tablebasePieces = tablebase ? maxPieces : 0;
+}
+
+void SearchThread::SetNetwork(const NeuralNetwork* network)
+{
+	m_network = network;
+}
+
+void SearchThread::SearchIteratively(int firstDepth, int lastDepth)
+{
+	for (int depth = firstDepth; depth <= lastDepth; ++depth)
+	{
+		// Search a narrow window around the last score first, it cuts off far more. If the score
+		// falls outside, the window is opened fully and the iteration is searched again.
+		int alpha = -s_infinity;
+		int beta = s_infinity;
+		if (m_completedDepth >= 2)
+		{
+			alpha = m_completedScore - s_aspirationWindow;
+			beta = m_completedScore + s_aspirationWindow;
+		}
+
+		int score = SearchRoot(depth, alpha, beta);
+		if (!m_isStopped && (score <= alpha || score >= beta))
+			score = SearchRoot(depth, -s_infinity, s_infinity);
+
+		if (m_isStopped)
+			break;
+
+		// The best move goes first in the next iteration.
+		std::swap(m_rootMoves[0], m_rootMoves[m_rootBestIndex]);
+		m_rootBestIndex = 0;
+
+		m_completedScore = score;
+		m_completedDepth = depth;
+
+		// A single legal move or a found win needs no deeper search.
+		if (m_rootMoves.size() == 1 || std::abs(score) >= s_winScore - s_maxSearchPly)
+			break;
+	}
+}
+
+//---------------------------------------------------------------
+
+SearchEngine::SearchEngine(size_t hashMegabytes, int threadCount)
+	: m_transpositionTable(hashMegabytes)
+	, m_openingBook(nullptr)
+	, m_isStopped(false)
+	, m_resultPartition(0)
+{
+	for (int i = 0; i < std::max(threadCount, 1); ++i)
+	{
+		m_threads.emplace_back(new SearchThread(m_transpositionTable, m_isStopped));
+	}
+}
+
+SearchEngine::~SearchEngine()
+{
+}
+
+int SearchEngine::GetThreadCount() const
+{
+	return static_cast<int>(m_threads.size());
+}
+
+void SearchEngine::ClearHash()
+{
+	m_transpositionTable.Clear();
+}
+
+void SearchEngine::SetTablebase(const Tablebase* tablebase)
+{
+	int maxPieces = tablebase ? tablebase->GetMaxPieces() : 0;
+	for (const std::unique_ptr<SearchThread>& thread : m_threads)
+	{
+		thread->SetTablebase(tablebase, maxPieces);
+	}
+}
+
+void SearchEngine::SetNetwork(const NeuralNetwork* network)
+{
+	for (const std::unique_ptr<SearchThread>& thread : m_threads)
+	{
+		thread->SetNetwork(network);
+	}
+}
+
+void SearchEngine::SetOpeningBook(const OpeningBook* openingBook, uint64_t seed)
+{
+	m_openingBook = openingBook;
+	m_bookRandom.seed(seed);
+}
+
+int SearchEngine::GetWinScore()
+{
+	return s_winScore;
+}
+
+SearchResult SearchEngine::Search(const Position& position, const SearchLimits& limits)
+{
+	m_limits = limits;
+	m_startTime = std::chrono::steady_clock::now();
+	m_isStopped = false;
+	m_rootPosition = position;
+	m_resultPartition = 0;
+
+	SearchThread& mainThread = *m_threads[0];
+	mainThread.Start(limits, m_startTime, 0, 0);
+	m_rootMoves = mainThread.GenerateTurns(position, Zobrist::ComputeKey(position), 0);
+
+	SearchResult result;
+	if (m_rootMoves.empty())
+		return result;
+
+	// Positions the book knows are answered from it, with no search at all.
+	SearchMove bookMove;
+	if (m_openingBook && m_openingBook->ChooseTurn(position, m_bookRandom(), bookMove.m_move))
+	{
+		SetBestMove(position, bookMove, result);
+		result.m_isBookMove = true;
+		return result;
+	}
+
+	for (const std::unique_ptr<SearchThread>& thread : m_threads)
+	{
+		thread->m_rootPosition = position;
+	}
+
+	if (m_limits.m_maxNodes > 0)
+		SearchPartitioned(result);
+	else
+		SearchShared(result);
+
+	SetPonderTurn(result);
+
+	uint64_t hashProbes = 0;
+	uint64_t hashHits = 0;
+	uint64_t hashCollisions = 0;
+	for (const std::unique_ptr<SearchThread>& thread : m_threads)
+	{
+		result.m_nodes += thread->m_nodes;
+		result.m_tablebaseHits += thread->m_tablebaseHits;
+		hashProbes += thread->m_hashProbes;
+		hashHits += thread->m_hashHits;
+		hashCollisions += thread->m_hashCollisions;
+	}
+
+	result.m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+	result.m_nodesPerSecond = result.m_seconds > 0.0 ? result.m_nodes / result.m_seconds : 0.0;
+	result.m_effectiveBranchingFactor = result.m_depth > 0 ? std::pow(static_cast<double>(result.m_nodes), 1.0 / result.m_depth) : 0.0;
+	result.m_hashHitRate = hashProbes > 0 ? static_cast<double>(hashHits) / hashProbes : 0.0;
+	result.m_hashCollisionRate = hashProbes > 0 ? static_cast<double>(hashCollisions) / hashProbes : 0.0;
+	return result;
+}
+
+void SearchEngine::SearchShared(SearchResult& resultOut)
+{
+	m_transpositionTable.SetPartitionCount(1);
+	m_transpositionTable.NewSearch();
+
+	int lastDepth = m_limits.m_maxDepth > 0 ? std::min(m_limits.m_maxDepth, s_maxSearchPly - 1) : s_maxSearchPly - 1;
+
+	// Helpers search every other iteration a ply deeper and start on a different root move, so they
+	// explore ahead of the main thread instead of repeating its work.
+	std::vector<std::thread> helpers;
+	for (size_t i = 1; i < m_threads.size(); ++i)
+	{
+		SearchThread& helper = *m_threads[i];
+		helper.Start(m_limits, m_startTime, 0, 0);
+		helper.m_rootMoves = m_rootMoves;
+		std::rotate(helper.m_rootMoves.begin(), helper.m_rootMoves.begin() + i % m_rootMoves.size(),
+			helper.m_rootMoves.end());
+
+		int firstDepth = std::min(1 + static_cast<int>(i % 2), lastDepth);
+		helpers.emplace_back([&helper, firstDepth, lastDepth]()
+		{
+			helper.SearchIteratively(firstDepth, lastDepth);
+		});
+	}
+
+	SearchThread& mainThread = *m_threads[0];
+	mainThread.m_rootMoves = m_rootMoves;
+	mainThread.SearchIteratively(1, lastDepth);
+
+	m_isStopped = true;
+	for (std::thread& helper : helpers)
+	{
+		helper.join();
+	}
+
+	// Prefer the main thread unless a helper got deeper.
+	const SearchThread* bestThread = &mainThread;
+	for (const std::unique_ptr<SearchThread>& thread : m_threads)
+	{
+		if (thread->m_completedDepth > bestThread->m_completedDepth)
+			bestThread = thread.get();
+	}
+
+	SetBestMove(m_rootPosition, bestThread->m_rootMoves[0], resultOut);
+
+	resultOut.m_score = bestThread->m_completedScore;
+	resultOut.m_depth = bestThread->m_completedDepth;
+}
+
+void SearchEngine::SearchPartitioned(SearchResult& resultOut)
+{
+	int threadCount = GetThreadCount();
+
+	// Nothing from earlier searches may leak in, and no thread may see another one's results.
+	m_transpositionTable.Clear();
+	m_transpositionTable.SetPartitionCount(threadCount);
+
+	SearchLimits threadLimits = m_limits;
+	threadLimits.m_moveTimeMs = 0;
+	uint64_t nodeBudget = std::max<uint64_t>(m_limits.m_maxNodes / threadCount, 1);
+	for (int i = 0; i < threadCount; ++i)
+	{
+		m_threads[i]->Start(threadLimits, m_startTime, nodeBudget, i);
+	}
+
+	// Play the first move if not even the first iteration completes.
+	SetBestMove(m_rootPosition, m_rootMoves[0], resultOut);
+
+	int lastDepth = m_limits.m_maxDepth > 0 ? std::min(m_limits.m_maxDepth, s_maxSearchPly - 1) : s_maxSearchPly - 1;
+	for (int depth = 1; depth <= lastDepth; ++depth)
+	{
+		// Thread i gets root moves i, i + threadCount, ... so the best ones spread over the threads.
+		for (int i = 0; i < threadCount; ++i)
+		{
+			SearchThread& thread = *m_threads[i];
+			thread.m_rootMoves.clear();
+			for (size_t move = i; move < m_rootMoves.size(); move += threadCount)
+			{
+				thread.m_rootMoves.push_back(m_rootMoves[move]);
+			}
+		}
+
+		auto searchShare = [depth](SearchThread& thread)
+		{
+			if (!thread.m_rootMoves.empty())
+				thread.m_completedScore = thread.SearchRoot(depth, -s_infinity, s_infinity);
+		};
+
+		std::vector<std::thread> helpers;
+		for (int i = 1; i < threadCount; ++i)
+		{
+			helpers.emplace_back(searchShare, std::ref(*m_threads[i]));
+		}
+
+		searchShare(*m_threads[0]);
+		for (std::thread& helper : helpers)
+		{
+			helper.join();
+		}
+
+		// An iteration only counts if every share of it was searched.
+		int bestIndex = -1;
+		int bestScore = -s_infinity;
+		for (int i = 0; i < threadCount; ++i)
+		{
+			const SearchThread& thread = *m_threads[i];
+			if (thread.m_isStopped)
+				return;
+
+			if (thread.m_rootMoves.empty())
+				continue;
+
+			int index = i + thread.m_rootBestIndex * threadCount;
+			if (thread.m_completedScore > bestScore || (thread.m_completedScore == bestScore && index < bestIndex))
+			{
+				bestIndex = index;
+				bestScore = thread.m_completedScore;
+			}
+		}
+
+		// The best move goes first in the next iteration, the others keep their order.
+		std::rotate(m_rootMoves.begin(), m_rootMoves.begin() + bestIndex, m_rootMoves.begin() + bestIndex + 1);
+
+		SetBestMove(m_rootPosition, m_rootMoves[0], resultOut);
+
+		resultOut.m_score = bestScore;
+		resultOut.m_depth = depth;
+		m_resultPartition = bestIndex % threadCount;
+
+		if (m_rootMoves.size() == 1 || std::abs(bestScore) >= s_winScore - s_maxSearchPly)
+			break;
+	}
+}
+
+void SearchEngine::SetPonderTurn(SearchResult& resultOut) const
+{
+	if (resultOut.m_depth == 0)
+		return;
+
+	Position position = m_rootPosition;
+	UndoRecord undo;
+	position.MakeMove(resultOut.m_bestTurn.GetSource(), resultOut.m_bestTurn.GetDestination(),
+		resultOut.m_bestTurn.GetCapturedPieces(), undo);
+
+	TranspositionEntry entry;
+	if (m_transpositionTable.Probe(Zobrist::ComputeKey(position), entry, m_resultPartition) != PROBE_HIT
+		|| entry.m_move < 0)
+	{
+		return;
+	}
+
+	// The table keeps source and destination only, the first turn between them stands for all.
+	MoveList turns;
+	MoveGenerator::GenerateTurns(position, turns);
+	for (const PackedMove& turn : turns)
+	{
+		if (EncodeMove(turn) == entry.m_move)
+		{
+			resultOut.m_ponderTurn = turn;
+			resultOut.m_hasPonderTurn = true;
+			return;
+		}
+	}
+}
+
+int SearchThread::SearchRoot(int depth, int alpha, int beta)
+{
+	++m_nodes;
+
+	if (m_network)
+		m_network->RefreshAccumulator(m_rootPosition, m_accumulators[0]);
+
+	int bestScore = -s_infinity;
+	for (size_t i = 0; i < m_rootMoves.size(); ++i)
+	{
+		const SearchMove& move = m_rootMoves[i];
+
+		UndoRecord undo;
+		MakeSearchMove(m_rootPosition, move, 0, undo);
+		int score = -Negamax(m_rootPosition, move.m_hashKey, depth - 1, 1, -beta, -alpha);
+		m_rootPosition.UnmakeMove(undo);
+
+		if (m_isStopped)
+			break;
+
+		if (score > bestScore)
+		{
+			bestScore = score;
+
+			// Only a move that beats alpha is known to be better than the one we had.
+			if (score > alpha || i == 0)
+				m_rootBestIndex = static_cast<int>(i);
+		}
+
+		if (score > alpha)
+			alpha = score;
+
+		if (alpha >= beta)
+			break;
+	}
+
+	return bestScore;
+}
+
+int SearchThread::Negamax(Position& position, uint64_t key, int depth, int ply, int alpha, int beta)
+{
+	++m_nodes;
+	if ((m_nodes % s_stopCheckInterval) == 0 && ShouldStop())
+		m_isStopped = true;
+
+	if (m_isStopped)
+		return 0;
+
+	// Endgames in the tablebase are known exactly, below the root there is nothing left to search.
+	if (ply > 0 && GetSquareCount(position.GetOccupied()) <= m_tablebasePieces)
+	{
+		TablebaseResult result;
+		int distance;
+		if (m_tablebase->Probe(position, result, distance))
+		{
+			++m_tablebaseHits;
+			return GetTablebaseScore(position, result, distance, m_tablebase->HasDistances(), ply);
+		}
+	}
+
+	// A stored result that is deep enough and bounds the score the right way ends the node, any
+	// other one still tells us which move to try first.
+	int originalAlpha = alpha;
+	int hashMove = -1;
+	if (depth > 0)
+	{
+		TranspositionEntry entry;
+		TranspositionProbeResult probeResult = m_transpositionTable.Probe(key, entry, m_partition);
+		++m_hashProbes;
+
+		if (probeResult == PROBE_HIT)
+		{
+			++m_hashHits;
+			hashMove = entry.m_move;
+
+			int score = ScoreFromTable(entry.m_score, ply);
+			if (entry.m_depth >= depth && (entry.m_bound == BOUND_EXACT
+				|| (entry.m_bound == BOUND_LOWER && score >= beta)
+				|| (entry.m_bound == BOUND_UPPER && score <= alpha)))
+			{
+				return score;
+			}
+		}
+		else if (probeResult == PROBE_COLLISION)
+		{
+			++m_hashCollisions;
+		}
+	}
+
+	std::vector<SearchMove>& moves = GenerateTurns(position, key, ply);
+
+	// Without a legal move the side to move has lost. Prefer the quickest win and slowest loss.
+	if (moves.empty())
+		return -s_winScore + ply;
+
+	// Captures are forced, so they are resolved past the horizon instead of evaluated mid exchange.
+	bool isCapture = moves[0].m_move.IsCapture();
+	if ((depth <= 0 && !isCapture) || ply >= s_maxSearchPly)
+		return Evaluate(position, ply);
+
+	ScoreMoves(moves, ply, hashMove);
+
+	int bestScore = -s_infinity;
+	int bestMove = -1;
+	for (size_t i = 0; i < moves.size(); ++i)
+	{
+		PickNextMove(moves, i);
+		const SearchMove& move = moves[i];
+
+		UndoRecord undo;
+		MakeSearchMove(position, move, ply, undo);
+		int score = -Negamax(position, move.m_hashKey, depth - 1, ply + 1, -beta, -alpha);
+		position.UnmakeMove(undo);
+
+		if (m_isStopped)
+			return 0;
+
+		if (score > bestScore)
+		{
+			bestScore = score;
+			bestMove = EncodeMove(move);
+		}
+
+		if (score > alpha)
+			alpha = score;
+
+		if (alpha >= beta)
+		{
+			RecordCutoff(move, depth, ply);
+			break;
+		}
+	}
+
+	if (depth > 0)
+	{
+		TranspositionBound bound = BOUND_EXACT;
+		if (bestScore <= originalAlpha)
+		{
+			// Every move failed low, none of them is known to be best.
+			bound = BOUND_UPPER;
+			bestMove = -1;
+		}
+		else if (bestScore >= beta)
+		{
+			bound = BOUND_LOWER;
+		}
+
+		m_transpositionTable.Store(key, ScoreToTable(bestScore, ply), depth, bound, bestMove, m_partition);
+	}
+
+	return bestScore;
+}
+
+void SearchThread::MakeSearchMove(Position& position, const SearchMove& move, int ply, UndoRecord& undoOut)
+{
+	if (!m_network)
+	{
+		position.MakeMove(move.m_move.GetSource(), move.m_move.GetDestination(), move.m_move.GetCapturedPieces(),
+			undoOut);
+		return;
+	}
+
+	Position parentPosition = position;
+	position.MakeMove(move.m_move.GetSource(), move.m_move.GetDestination(), move.m_move.GetCapturedPieces(), undoOut);
+	m_network->UpdateAccumulator(m_accumulators[ply], parentPosition, position, m_accumulators[ply + 1]);
+}
+
+int SearchThread::Evaluate(const Position& position, int ply) const
+{
+	if (m_network)
+		return m_network->Evaluate(m_accumulators[ply], position.m_isWhitePlayerTurn);
+
+	return Evaluation::Evaluate(position);
+}
+
+std::vector<SearchMove>& SearchThread::GenerateTurns(const Position& position, uint64_t key, int ply)
+{
+	std::vector<SearchMove>& turns = m_moveLists[ply];
+	turns.clear();
+
+	m_generatorList.Clear();
+	MoveGenerator::GenerateTurns(position, m_generatorList);
+
+	for (const PackedMove& move : m_generatorList)
+	{
+		SearchMove turn;
+		turn.m_move = move;
+		turn.m_hashKey = Zobrist::GetKeyAfterTurn(position, key, move);
+		turn.m_orderingScore = 0;
+		turns.push_back(turn);
+	}
+
+	return turns;
+}
+
+void SearchThread::ScoreMoves(std::vector<SearchMove>& moves, int ply, int hashMove)
+{
+	for (SearchMove& move : moves)
+	{
+		int encodedMove = EncodeMove(move);
+		if (encodedMove == hashMove)
+			move.m_orderingScore = s_hashMoveOrderingScore;
+		else if (move.m_move.IsCapture())
+			move.m_orderingScore = s_captureOrderingScore + GetSquareCount(move.m_move.GetCapturedPieces());
+		else if (encodedMove == m_killerMoves[ply][0] || encodedMove == m_killerMoves[ply][1])
+			move.m_orderingScore = s_killerOrderingScore;
+		else
+			move.m_orderingScore = m_history[move.m_move.GetSource()][move.m_move.GetDestination()];
+	}
+}
+
+void SearchThread::PickNextMove(std::vector<SearchMove>& moves, size_t index)
+{
+	// Selection sort one step at a time, most nodes cut off after the first few moves.
+	size_t bestIndex = index;
+	for (size_t i = index + 1; i < moves.size(); ++i)
+	{
+		if (moves[i].m_orderingScore > moves[bestIndex].m_orderingScore)
+			bestIndex = i;
+	}
+
+	if (bestIndex != index)
+		std::swap(moves[index], moves[bestIndex]);
+}
+
+void SearchThread::RecordCutoff(const SearchMove& move, int depth, int ply)
+{
+	if (move.m_move.IsCapture())
+		return;
+
+	int encodedMove = EncodeMove(move);
+	if (m_killerMoves[ply][0] != encodedMove)
+	{
+		m_killerMoves[ply][1] = m_killerMoves[ply][0];
+		m_killerMoves[ply][0] = encodedMove;
+	}
+
+	int& history = m_history[move.m_move.GetSource()][move.m_move.GetDestination()];
+	history += depth * depth;
+
+	// Keep history below the killer bucket.
+	if (history >= s_killerOrderingScore)
+	{
+		for (int(&row)[s_squareCount] : m_history)
+		{
+			for (int& value : row)
+				value /= 2;
+		}
+	}
+}
+
+bool SearchThread::ShouldStop()
+{
+	if (m_isSearchStopped.load(std::memory_order_relaxed))
+		return true;
+
+	if (m_limits.m_stopFlag && m_limits.m_stopFlag->load(std::memory_order_relaxed))
+		return true;
+
+	if (m_nodeBudget > 0 && m_nodes >= m_nodeBudget)
+		return true;
+
+	if (m_limits.m_moveTimeMs > 0)
+	{
+		auto elapsed = std::chrono::steady_clock::now() - m_startTime;
+		if (std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() >= m_limits.m_moveTimeMs)
+		{
+			m_isSearchStopped.store(true, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,168 @@
+//---------------------------------------------------------------
+//
+// Search.h
+//
+
+#pragma once
+
+#include "MoveList.h"
+#include "Position.h"
+#include "TranspositionTable.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+	// Deepest ply the search will ever reach, including capture sequences past the horizon.
+	const int s_maxSearchPly = 128;
+
+	const size_t s_defaultHashMegabytes = 64;
+}
+
+// Budget for a single search. Whichever limit is hit first ends the search, zero means no limit.
+struct SearchLimits
+{
+	SearchLimits();
+
+	int m_maxDepth;
+	int m_moveTimeMs;
+
+	// Total nodes of all threads. A node limit makes the search reproducible for a thread count,
+	// see SearchEngine, but not across thread counts.
+	uint64_t m_maxNodes;
+
+	// Set from another thread to end the search early, none if null. Every search thread checks it
+	// along with the other limits, so the search ends within a few thousand nodes.
+	const std::atomic<bool>* m_stopFlag;
+};
+
+struct SearchResult
+{
+	SearchResult();
+
+	// The squares the moving piece visits, starting with its source. Empty without a legal move.
+	std::vector<BoardIndex> m_bestMove;
+
+	// The same turn as one move, to be played with Game::PlayMove.
+	PackedMove m_bestTurn;
+
+	// Score of the best move from the point of view of the side to move.
+	int m_score;
+
+	// Deepest completed iteration.
+	int m_depth;
+
+	uint64_t m_nodes;
+	double m_seconds;
+	double m_nodesPerSecond;
+
+	// The branching factor of a uniform tree of the completed depth with as many nodes as were searched.
+	double m_effectiveBranchingFactor;
+
+	// Share of transposition table probes that found their position, and that found the bucket
+	// taken by other positions instead.
+	double m_hashHitRate;
+	double m_hashCollisionRate;
+
+	// Positions scored by the endgame tablebase instead of searched.
+	uint64_t m_tablebaseHits;
+
+	// Whether the move was taken from the opening book without a search.
+	bool m_isBookMove;
+
+	// The reply the search expects to the best turn, the best move the table holds for the position
+	// it leads to. Pondering searches the position after it while the opponent thinks.
+	PackedMove m_ponderTurn;
+	bool m_hasPonderTurn;
+};
+
+// A complete turn as seen by the search.
+struct SearchMove
+{
+	PackedMove m_move;
+
+	// Zobrist key of the position the turn leads to.
+	uint64_t m_hashKey;
+
+	int m_orderingScore;
+};
+
+class NeuralNetwork;
+class OpeningBook;
+class SearchThread;
+class Tablebase;
+
+// Iterative deepening negamax with alpha-beta pruning. Speed comes from move ordering (hash move,
+// killers, history), aspiration windows around the previous score, early cutoffs and a
+// transposition table that stops transpositions from being searched twice.
+//
+// With more than one thread the search runs Lazy SMP style: every thread searches the whole tree
+// from the root over the one shared table, helpers a ply ahead and with the root moves rotated, so
+// they fill the table with results the main thread then finds. The main thread decides when to
+// stop, the deepest completed iteration of any thread is the result.
+//
+// Results a shared table hands between threads depend on timing, so a search with a node limit
+// runs differently to stay reproducible. Each iteration the root moves are dealt out to the threads
+// in order, every thread searches its own share in its own partition of the table and with its own
+// node budget, and the iteration only counts once all of them finished it. The time limit is
+// ignored then, the same position, node count and thread count always give the same result. Another
+// thread count deals the root moves out differently and splits the nodes differently, so it may
+// well give another one.
+class SearchEngine
+{
+public:
+	// The transposition table is allocated once here, from the memory budget.
+	explicit SearchEngine(size_t hashMegabytes = s_defaultHashMegabytes, int threadCount = 1);
+	~SearchEngine();
+
+	// Searches the position within the limits and returns the best move found.
+	SearchResult Search(const Position& position, const SearchLimits& limits);
+
+	int GetThreadCount() const;
+
+	// Forgets every result earlier searches stored, so the next search plays as a new engine's would.
+	void ClearHash();
+
+	// Scores positions in the tablebase by probing it instead of searching them. The tablebase must
+	// outlive the searches, null turns it off.
+	void SetTablebase(const Tablebase* tablebase);
+
+	// Plays the turns of the opening book where it has any, chosen by their weights with a generator
+	// seeded here, instead of searching. The book must outlive the searches, null turns it off.
+	void SetOpeningBook(const OpeningBook* openingBook, uint64_t seed = 1);
+
+	// Scores positions with the network instead of Evaluation::Evaluate. The network must outlive
+	// the searches, null goes back to the hand written evaluation.
+	void SetNetwork(const NeuralNetwork* network);
+
+	// Score of a position with the side to move lost, before subtracting the distance to it.
+	static int GetWinScore();
+
+private:
+	void SearchShared(SearchResult& resultOut);
+	void SearchPartitioned(SearchResult& resultOut);
+
+	// Looks up the expected reply to the best turn in the table.
+	void SetPonderTurn(SearchResult& resultOut) const;
+
+	TranspositionTable m_transpositionTable;
+	std::vector<std::unique_ptr<SearchThread>> m_threads;
+
+	const OpeningBook* m_openingBook;
+	std::mt19937_64 m_bookRandom;
+
+	// Set by whichever thread first hits a limit, the others notice at their next check.
+	std::atomic<bool> m_isStopped;
+
+	SearchLimits m_limits;
+	std::chrono::steady_clock::time_point m_startTime;
+	Position m_rootPosition;
+	std::vector<SearchMove> m_rootMoves;
+
+	// Partition of the table the search of the best turn stored its results in.
+	int m_resultPartition;
+};
@@ -0,0 +1,155 @@
+//---------------------------------------------------------------
+//
+// SearchBenchMain.cpp
+//
+// Headless search scaling benchmark. Searches a fixed set of positions to a fixed depth with 1, 2,
+// 4, ... threads and reports the time to depth of each thread count and its speedup over one.
+//
+// With a node limit instead every position is searched twice at each thread count, and the
+// benchmark fails unless both searches give the same turn, score, depth and node count.
+//
+// usage: search-bench [--depth <plies>] [--nodes <count>] [--threads <max>] [--hash <MB>]
+//
+
+#include "Search.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+namespace {
+
+//==============================================================================
+
+const int s_defaultDepth = 14;
+
+// The start position and positions from the opening and middle game.
+const char* const s_benchmarkFens[] =
+{
+	"W:W1-12:B21-32",
+	"W:W1,2,3,4,5,6,7,8,11,12,14:B19,20,21,22,25,26,27,29,30,31,32",
+	"W:W1,2,3,4,6,7,8,11,12:B10,19,20,21,25,27,29,30,31,32",
+	"W:W1,2,3,4,6,11,12,14:B20,21,23,24,26,28,29,30",
+	"W:W1,2,4,6,7,12:B11,19,21,24,28,29,30",
+};
+
+struct BenchOptions
+{
+	BenchOptions()
+		: m_depth(s_defaultDepth)
+		, m_maxNodes(0)
+		, m_maxThreadCount(static_cast<int>(std::thread::hardware_concurrency()))
+		, m_hashMegabytes(s_defaultHashMegabytes)
+	{
+		if (m_maxThreadCount < 1)
+			m_maxThreadCount = 1;
+	}
+
+	int m_depth;
+	uint64_t m_maxNodes;
+	int m_maxThreadCount;
+	size_t m_hashMegabytes;
+};
+
+void PrintUsage()
+{
+	std::printf("usage: search-bench [--depth <plies>] [--nodes <count>] [--threads <max>] [--hash <MB>]\n"
+		"  --depth    depth every position is searched to, defaults to %d\n"
+		"  --nodes    node limit of every search instead of a depth, checks that searches repeat exactly\n"
+		"  --threads  highest thread count measured, defaults to the hardware threads\n"
+		"  --hash     transposition table size, defaults to %d MB\n",
+		s_defaultDepth, static_cast<int>(s_defaultHashMegabytes));
+}
+
+bool ParseOptions(int argc, char** argv, BenchOptions& optionsOut)
+{
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string argument(argv[i]);
+		int value = std::atoi(argv[i + 1]);
+
+		if (argument == "--depth")
+			optionsOut.m_depth = value;
+		else if (argument == "--nodes")
+			optionsOut.m_maxNodes = std::strtoull(argv[i + 1], nullptr, 10);
+		else if (argument == "--threads")
+			optionsOut.m_maxThreadCount = value;
+		else if (argument == "--hash")
+			optionsOut.m_hashMegabytes = static_cast<size_t>(value);
+		else
+			return false;
+	}
+
+	return (argc % 2) == 1 && optionsOut.m_depth > 0 && optionsOut.m_maxThreadCount > 0
+		&& optionsOut.m_hashMegabytes > 0;
+}
+
+// Whether two searches of the same position came to exactly the same result.
+bool IsSameResult(const SearchResult& result, const SearchResult& other)
+{
+	return result.m_bestTurn == other.m_bestTurn && result.m_score == other.m_score
+		&& result.m_depth == other.m_depth && result.m_nodes == other.m_nodes;
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+	BenchOptions options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	SearchLimits limits;
+	limits.m_maxDepth = options.m_maxNodes > 0 ? 0 : options.m_depth;
+	limits.m_moveTimeMs = 0;
+	limits.m_maxNodes = options.m_maxNodes;
+
+	std::printf("%7s %12s %10s %14s %8s\n", "threads", "nodes", "seconds", "nodes/sec", "speedup");
+
+	double singleThreadSeconds = 0.0;
+	for (int threadCount = 1; threadCount <= options.m_maxThreadCount; threadCount *= 2)
+	{
+		// A fresh engine per thread count, so no run starts with a table filled by the one before.
+		SearchEngine searchEngine(options.m_hashMegabytes, threadCount);
+
+		uint64_t nodes = 0;
+		double seconds = 0.0;
+		for (const char* fen : s_benchmarkFens)
+		{
+			Position position;
+			Position::FromFen(fen, position);
+
+			SearchResult result = searchEngine.Search(position, limits);
+			nodes += result.m_nodes;
+			seconds += result.m_seconds;
+
+			if (options.m_maxNodes > 0)
+			{
+				SearchResult repeatedResult = searchEngine.Search(position, limits);
+				if (!IsSameResult(result, repeatedResult))
+				{
+					std::printf("%7d  %s: searched depth %d, score %d, %llu nodes, then depth %d, score %d, %llu nodes\n",
+						threadCount, fen, result.m_depth, result.m_score, static_cast<unsigned long long>(result.m_nodes),
+						repeatedResult.m_depth, repeatedResult.m_score,
+						static_cast<unsigned long long>(repeatedResult.m_nodes));
+					return 1;
+				}
+			}
+		}
+
+		if (threadCount == 1)
+			singleThreadSeconds = seconds;
+
+		std::printf("%7d %12llu %10.3f %14.0f %7.2fx\n", threadCount, static_cast<unsigned long long>(nodes),
+			seconds, seconds > 0.0 ? nodes / seconds : 0.0, seconds > 0.0 ? singleThreadSeconds / seconds : 0.0);
+		std::fflush(stdout);
+	}
+
+	return 0;
+}
@@ -0,0 +1,376 @@
+//---------------------------------------------------------------
+//
+// SelfPlayMain.cpp
+//
+// Headless self-play runner. Plays many games at once on a pool of threads, every game on a Game
+// of its own, and reports throughput, game length and results. Moves are chosen at random or by
+// the engine after a few random opening moves. The games can be recorded, and recorded games
+// replayed.
+//
+// usage: self-play [--games <count>] [--threads <count>] [--player random|engine] [--depth <plies>]
+//   [--random-turns <count>] [--max-turns <count>] [--seed <seed>] [--record <file>] [--takebacks <count>]
+//        self-play --replay <file> [--replay <file> ...]
+//
+
+#include "Game.h"
+#include "GameRecord.h"
+#include "MoveGenerator.h"
+#include "Search.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+//==============================================================================
+
+const int s_defaultGameCount = 1000;
+const int s_defaultDepth = 4;
+const int s_defaultRandomTurns = 4;
+
+// A game still going after this many turns is scored a draw.
+const int s_defaultMaxTurns = 200;
+
+// Every engine player gets a small table, there is one per side and thread.
+const size_t s_engineHashMegabytes = 4;
+
+struct SelfPlayOptions
+{
+	SelfPlayOptions()
+		: m_gameCount(s_defaultGameCount)
+		, m_threadCount(static_cast<int>(std::thread::hardware_concurrency()))
+		, m_isEnginePlayer(false)
+		, m_depth(s_defaultDepth)
+		, m_randomTurns(s_defaultRandomTurns)
+		, m_maxTurns(s_defaultMaxTurns)
+		, m_seed(1)
+		, m_takebackCount(0)
+		, m_isReplay(false)
+	{
+		if (m_threadCount < 1)
+			m_threadCount = 1;
+	}
+
+	int m_gameCount;
+	int m_threadCount;
+	bool m_isEnginePlayer;
+	int m_depth;
+
+	// Turns played at random at the start of an engine game, so the games differ.
+	int m_randomTurns;
+
+	int m_maxTurns;
+	uint64_t m_seed;
+
+	// Every thread records its games to a file of its own, this path with the thread number added.
+	std::string m_recordPath;
+
+	// Turns every game takes back and plays again once it is over. Replaying the record must then
+	// give the same games, which checks that the record follows take backs.
+	int m_takebackCount;
+
+	// Record files to replay instead of playing.
+	bool m_isReplay;
+	std::vector<std::string> m_replayPaths;
+};
+
+// Results of the games one thread played. Every thread fills its own, they are added up once all
+// threads are done.
+struct SelfPlayStats
+{
+	SelfPlayStats()
+		: m_gameCount(0)
+		, m_turnCount(0)
+		, m_whiteWinCount(0)
+		, m_blackWinCount(0)
+		, m_drawCount(0)
+	{
+	}
+
+	void AddGame(int turnCount, GameResult result)
+	{
+		++m_gameCount;
+		m_turnCount += turnCount;
+
+		if (result == RESULT_WHITE_WIN)
+			++m_whiteWinCount;
+		else if (result == RESULT_BLACK_WIN)
+			++m_blackWinCount;
+		else
+			++m_drawCount;
+	}
+
+	void Add(const SelfPlayStats& other)
+	{
+		m_gameCount += other.m_gameCount;
+		m_turnCount += other.m_turnCount;
+		m_whiteWinCount += other.m_whiteWinCount;
+		m_blackWinCount += other.m_blackWinCount;
+		m_drawCount += other.m_drawCount;
+	}
+
+	uint64_t m_gameCount;
+	uint64_t m_turnCount;
+	uint64_t m_whiteWinCount;
+	uint64_t m_blackWinCount;
+	uint64_t m_drawCount;
+};
+
+void PrintUsage()
+{
+	std::printf("usage: self-play [--games <count>] [--threads <count>] [--player random|engine] [--depth <plies>]\n"
+		"  [--random-turns <count>] [--max-turns <count>] [--seed <seed>] [--record <file>] [--takebacks <count>]\n"
+		"       self-play --replay <file> [--replay <file> ...]\n"
+		"  --games         games to play, defaults to %d\n"
+		"  --threads       threads playing games at once, defaults to the hardware threads\n"
+		"  --player        how moves are chosen, defaults to random\n"
+		"  --depth         search depth of the engine player, defaults to %d\n"
+		"  --random-turns  random turns before the engine takes over, defaults to %d\n"
+		"  --max-turns     turns after which a game is a draw, defaults to %d\n"
+		"  --seed          seed of the random moves, the same seed plays the same games\n"
+		"  --record        records the games of thread N to <file>.N\n"
+		"  --takebacks     turns taken back and played again once a game is over\n"
+		"  --replay        replays recorded games and counts their results instead of playing\n",
+		s_defaultGameCount, s_defaultDepth, s_defaultRandomTurns, s_defaultMaxTurns);
+}
+
+bool ParseOptions(int argc, char** argv, SelfPlayOptions& optionsOut)
+{
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string argument(argv[i]);
+		std::string value(argv[i + 1]);
+
+		if (argument == "--games")
+			optionsOut.m_gameCount = std::atoi(value.c_str());
+		else if (argument == "--threads")
+			optionsOut.m_threadCount = std::atoi(value.c_str());
+		else if (argument == "--player" && (value == "random" || value == "engine"))
+			optionsOut.m_isEnginePlayer = value == "engine";
+		else if (argument == "--depth")
+			optionsOut.m_depth = std::atoi(value.c_str());
+		else if (argument == "--random-turns")
+			optionsOut.m_randomTurns = std::atoi(value.c_str());
+		else if (argument == "--max-turns")
+			optionsOut.m_maxTurns = std::atoi(value.c_str());
+		else if (argument == "--seed")
+			optionsOut.m_seed = std::strtoull(value.c_str(), nullptr, 10);
+		else if (argument == "--record")
+			optionsOut.m_recordPath = value;
+		else if (argument == "--takebacks")
+			optionsOut.m_takebackCount = std::atoi(value.c_str());
+		else if (argument == "--replay")
+		{
+			optionsOut.m_isReplay = true;
+			optionsOut.m_replayPaths.push_back(value);
+		}
+		else
+			return false;
+	}
+
+	return (argc % 2) == 1 && optionsOut.m_gameCount > 0 && optionsOut.m_threadCount > 0
+		&& optionsOut.m_depth > 0 && optionsOut.m_randomTurns >= 0 && optionsOut.m_maxTurns > 0
+		&& optionsOut.m_takebackCount >= 0;
+}
+
+// Plays the games of one thread: every threadCount-th game starting at firstGame. Each game seeds
+// its random moves from its own index and starts the engines with empty tables, so the results do
+// not depend on the number of threads.
+void PlayGames(const SelfPlayOptions& options, int firstGame, SelfPlayStats& statsOut)
+{
+	std::unique_ptr<SearchEngine> whiteEngine;
+	std::unique_ptr<SearchEngine> blackEngine;
+	if (options.m_isEnginePlayer)
+	{
+		whiteEngine.reset(new SearchEngine(s_engineHashMegabytes));
+		blackEngine.reset(new SearchEngine(s_engineHashMegabytes));
+	}
+
+	SearchLimits limits;
+	limits.m_maxDepth = options.m_depth;
+	limits.m_moveTimeMs = 0;
+
+	GameRecordWriter recordWriter;
+	if (!options.m_recordPath.empty())
+		recordWriter.Open(options.m_recordPath + "." + std::to_string(firstGame));
+
+	MoveList turns;
+	for (int gameIndex = firstGame; gameIndex < options.m_gameCount; gameIndex += options.m_threadCount)
+	{
+		std::mt19937_64 random(options.m_seed * 0x9E3779B97F4A7C15ull + gameIndex);
+		Game game;
+		if (recordWriter.IsOpen())
+			game.SetRecordWriter(&recordWriter);
+
+		// Results of the thread's earlier games would steer this one's search.
+		if (options.m_isEnginePlayer)
+		{
+			whiteEngine->ClearHash();
+			blackEngine->ClearHash();
+		}
+
+		int turn = 0;
+		for (; turn < options.m_maxTurns; ++turn)
+		{
+			const Position& position = game.GetPosition();
+
+			turns.Clear();
+			MoveGenerator::GenerateTurns(position, turns);
+			if (turns.IsEmpty())
+				break;
+
+			PackedMove chosenTurn = turns[static_cast<int>(random() % turns.GetSize())];
+			if (options.m_isEnginePlayer && turn >= options.m_randomTurns)
+			{
+				SearchEngine& engine = position.m_isWhitePlayerTurn ? *whiteEngine : *blackEngine;
+				chosenTurn = engine.Search(position, limits).m_bestTurn;
+			}
+
+			game.PlayMove(chosenTurn);
+		}
+
+		// The side to move without a legal move has lost, the game recorded that itself.
+		GameResult result = RESULT_DRAW;
+		if (turn < options.m_maxTurns)
+			result = game.GetPosition().m_isWhitePlayerTurn ? RESULT_BLACK_WIN : RESULT_WHITE_WIN;
+		else
+			recordWriter.EndGame(RESULT_DRAW);
+
+		if (options.m_takebackCount > 0)
+		{
+			std::vector<PackedMove> playedTurns;
+			game.GetTurns(playedTurns);
+
+			int takebackCount = std::min(options.m_takebackCount, turn);
+			for (int i = 0; i < takebackCount; ++i)
+			{
+				game.TakeBack();
+			}
+
+			for (int i = turn - takebackCount; i < turn; ++i)
+			{
+				game.PlayMove(playedTurns[i]);
+			}
+
+			if (result == RESULT_DRAW)
+				recordWriter.EndGame(RESULT_DRAW);
+		}
+
+		statsOut.AddGame(turn, result);
+	}
+}
+
+// Replays every game of the record file from the start position. Returns false if the file cannot
+// be read or holds a turn that is not legal.
+bool ReplayGames(const std::string& filePath, SelfPlayStats& statsOut, uint64_t& bytesOut)
+{
+	GameRecordReader reader;
+	if (!reader.Open(filePath))
+		return false;
+
+	bytesOut += reader.GetSize();
+	while (reader.NextGame())
+	{
+		Position position = Position::CreateStartPosition();
+		UndoRecord undo;
+
+		int turnCount = 0;
+		int turnIndex;
+		while (reader.NextTurn(turnIndex))
+		{
+			PackedMove turn;
+			if (!GameRecord::GetTurn(position, turnIndex, turn))
+			{
+				std::printf("%s: illegal turn in game %llu\n", filePath.c_str(),
+					static_cast<unsigned long long>(statsOut.m_gameCount + 1));
+				return false;
+			}
+
+			position.MakeMove(turn.GetSource(), turn.GetDestination(), turn.GetCapturedPieces(), undo);
+			++turnCount;
+		}
+
+		statsOut.AddGame(turnCount, reader.GetResult());
+	}
+
+	if (reader.IsTruncated())
+		std::printf("%s: the last game is cut off\n", filePath.c_str());
+
+	return true;
+}
+
+void PrintStats(const SelfPlayStats& stats)
+{
+	double gameCount = static_cast<double>(stats.m_gameCount);
+	if (stats.m_gameCount == 0)
+		return;
+
+	std::printf("average length %.1f turns\n", stats.m_turnCount / gameCount);
+	std::printf("white wins %.1f%%, draws %.1f%%, black wins %.1f%%\n", 100.0 * stats.m_whiteWinCount / gameCount,
+		100.0 * stats.m_drawCount / gameCount, 100.0 * stats.m_blackWinCount / gameCount);
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+	SelfPlayOptions options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	if (options.m_isReplay)
+	{
+		SelfPlayStats stats;
+		uint64_t byteCount = 0;
+		for (const std::string& replayPath : options.m_replayPaths)
+		{
+			if (!ReplayGames(replayPath, stats, byteCount))
+				return 1;
+		}
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+		std::printf("%llu games, %llu turns, %llu bytes replayed in %.3f seconds, %.1f turns/sec\n",
+			static_cast<unsigned long long>(stats.m_gameCount), static_cast<unsigned long long>(stats.m_turnCount),
+			static_cast<unsigned long long>(byteCount), seconds, seconds > 0.0 ? stats.m_turnCount / seconds : 0.0);
+		PrintStats(stats);
+		return 0;
+	}
+
+	std::vector<SelfPlayStats> threadStats(options.m_threadCount);
+	std::vector<std::thread> threads;
+	for (int i = 0; i < options.m_threadCount; ++i)
+	{
+		threads.emplace_back(PlayGames, std::cref(options), i, std::ref(threadStats[i]));
+	}
+
+	SelfPlayStats stats;
+	for (int i = 0; i < options.m_threadCount; ++i)
+	{
+		threads[i].join();
+		stats.Add(threadStats[i]);
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	double gameCount = static_cast<double>(stats.m_gameCount);
+
+	std::printf("%llu games on %d threads in %.3f seconds, %.1f games/sec\n",
+		static_cast<unsigned long long>(stats.m_gameCount), options.m_threadCount, seconds,
+		seconds > 0.0 ? gameCount / seconds : 0.0);
+	PrintStats(stats);
+
+	return 0;
+}
@@ -0,0 +1,421 @@
+//---------------------------------------------------------------
+//
+// Tablebase.cpp
+//
+
+#include "Tablebase.h"
+#include "Log.h"
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+//==============================================================================
+
+const char s_magic[4] = { 'C', 'K', 'T', 'B' };
+const uint8_t s_version = 1;
+const uint8_t s_distancesFlag = 1;
+
+// Magic, version, flags, two reserved bytes and the number of positions per side to move.
+const size_t s_headerSize = 16;
+
+// Squares a man may stand on: all but its crowning row.
+const int s_manSquareCount = s_squareCount - s_squaresPerRow;
+
+// Black men stand on squares 4-31, ranked from 0.
+const int s_blackManSquareOffset = s_squaresPerRow;
+
+// Material counts run 0 to s_maxTablebasePieces, the key packs four of them.
+const int s_materialBase = s_maxTablebasePieces + 1;
+const int s_materialKeyCount = s_materialBase * s_materialBase * s_materialBase * s_materialBase;
+
+typedef std::array<std::array<uint64_t, s_squareCount + 1>, s_squareCount + 1> BinomialTable;
+
+constexpr BinomialTable CreateBinomials()
+{
+	BinomialTable binomials = {};
+	for (int n = 0; n <= s_squareCount; ++n)
+	{
+		binomials[n][0] = 1;
+		for (int k = 1; k <= n; ++k)
+			binomials[n][k] = binomials[n - 1][k - 1] + (k < n ? binomials[n - 1][k] : 0);
+	}
+
+	return binomials;
+}
+
+// Binomial coefficients, s_binomials[n][k] is n choose k.
+constexpr BinomialTable s_binomials = CreateBinomials();
+
+uint64_t GetBinomial(int n, int k)
+{
+	return n >= 0 && k >= 0 && k <= n ? s_binomials[n][k] : 0;
+}
+
+// Colex rank of the relative squares, in ascending order.
+uint64_t RankCombination(const int* squares, int count)
+{
+	uint64_t rank = 0;
+	for (int i = 0; i < count; ++i)
+		rank += GetBinomial(squares[i], i + 1);
+
+	return rank;
+}
+
+void UnrankCombination(uint64_t rank, int count, int* squaresOut)
+{
+	for (int i = count; i > 0; --i)
+	{
+		int square = i - 1;
+		while (GetBinomial(square + 1, i) <= rank)
+			++square;
+
+		rank -= GetBinomial(square, i);
+		squaresOut[i - 1] = square;
+	}
+}
+
+// Squares of the pieces relative to the squares they may stand on: shifted down by the offset, and
+// with the squares taken by the pieces in skipped left out.
+int GetRelativeSquares(Bitboard pieces, Bitboard skipped, int offset, int* squaresOut)
+{
+	int count = 0;
+	for (; pieces; pieces &= pieces - 1)
+	{
+		int square = GetLowestSquare(pieces);
+		squaresOut[count++] = square - offset - GetSquareCount(skipped & (SquareMask(square) - 1));
+	}
+
+	return count;
+}
+
+// The relative squares turned back into a bitboard, skipping the squares taken.
+Bitboard GetAbsoluteSquares(const int* squares, int count, Bitboard skipped, int offset)
+{
+	Bitboard pieces = 0;
+	int square = offset;
+	int relativeSquare = 0;
+	for (int i = 0; i < count; ++i)
+	{
+		for (;; ++square)
+		{
+			if (skipped & SquareMask(square))
+				continue;
+			if (relativeSquare++ == squares[i])
+				break;
+		}
+
+		pieces |= SquareMask(square++);
+	}
+
+	return pieces;
+}
+
+uint64_t GetPackedSize(uint64_t positionCount)
+{
+	return (positionCount + 3) / 4;
+}
+
+bool IsValidHeader(const uint8_t* data, uint64_t size, uint64_t positionCount, bool& hasDistancesOut)
+{
+	if (size < s_headerSize || std::memcmp(data, s_magic, sizeof(s_magic)) != 0 || data[4] != s_version)
+		return false;
+
+	uint64_t storedCount;
+	std::memcpy(&storedCount, data + 8, sizeof(storedCount));
+	hasDistancesOut = (data[5] & s_distancesFlag) != 0;
+
+	uint64_t expectedSize = s_headerSize + 2 * GetPackedSize(positionCount) + (hasDistancesOut ? 2 * positionCount : 0);
+	return storedCount == positionCount && size == expectedSize;
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+TablebaseMaterial::TablebaseMaterial()
+	: m_whiteMen(0)
+	, m_whiteKings(0)
+	, m_blackMen(0)
+	, m_blackKings(0)
+{
+}
+
+TablebaseMaterial::TablebaseMaterial(int whiteMen, int whiteKings, int blackMen, int blackKings)
+	: m_whiteMen(whiteMen)
+	, m_whiteKings(whiteKings)
+	, m_blackMen(blackMen)
+	, m_blackKings(blackKings)
+{
+}
+
+TablebaseMaterial TablebaseMaterial::FromPosition(const Position& position)
+{
+	return TablebaseMaterial(GetSquareCount(position.m_whitePieces & ~position.m_kings),
+		GetSquareCount(position.m_whitePieces & position.m_kings),
+		GetSquareCount(position.m_blackPieces & ~position.m_kings),
+		GetSquareCount(position.m_blackPieces & position.m_kings));
+}
+
+std::string TablebaseMaterial::GetFileName() const
+{
+	return "tb-" + std::to_string(m_whiteMen) + std::to_string(m_whiteKings) + std::to_string(m_blackMen)
+		+ std::to_string(m_blackKings) + ".cktb";
+}
+
+//---------------------------------------------------------------
+
+TablebaseIndexer::TablebaseIndexer(const TablebaseMaterial& material)
+	: m_material(material)
+{
+	int menCount = material.m_whiteMen + material.m_blackMen;
+
+	m_blackMenCount = GetBinomial(s_manSquareCount, material.m_blackMen);
+	m_whiteKingCount = GetBinomial(s_squareCount - menCount, material.m_whiteKings);
+	m_blackKingCount = GetBinomial(s_squareCount - menCount - material.m_whiteKings, material.m_blackKings);
+	m_positionCount = GetBinomial(s_manSquareCount, material.m_whiteMen) * m_blackMenCount * m_whiteKingCount
+		* m_blackKingCount;
+}
+
+uint64_t TablebaseIndexer::GetIndex(const Position& position) const
+{
+	Bitboard whiteMen = position.m_whitePieces & ~position.m_kings;
+	Bitboard blackMen = position.m_blackPieces & ~position.m_kings;
+	Bitboard whiteKings = position.m_whitePieces & position.m_kings;
+	Bitboard blackKings = position.m_blackPieces & position.m_kings;
+	Bitboard men = whiteMen | blackMen;
+
+	int squares[s_maxTablebasePieces];
+	int count = GetRelativeSquares(whiteMen, 0, 0, squares);
+	uint64_t index = RankCombination(squares, count);
+
+	count = GetRelativeSquares(blackMen, 0, s_blackManSquareOffset, squares);
+	index = index * m_blackMenCount + RankCombination(squares, count);
+
+	count = GetRelativeSquares(whiteKings, men, 0, squares);
+	index = index * m_whiteKingCount + RankCombination(squares, count);
+
+	count = GetRelativeSquares(blackKings, men | whiteKings, 0, squares);
+	return index * m_blackKingCount + RankCombination(squares, count);
+}
+
+bool TablebaseIndexer::GetPosition(uint64_t index, bool isWhitePlayerTurn, Position& positionOut) const
+{
+	uint64_t blackKingRank = index % m_blackKingCount;
+	index /= m_blackKingCount;
+	uint64_t whiteKingRank = index % m_whiteKingCount;
+	index /= m_whiteKingCount;
+	uint64_t blackMenRank = index % m_blackMenCount;
+	uint64_t whiteMenRank = index / m_blackMenCount;
+
+	int squares[s_maxTablebasePieces];
+	UnrankCombination(whiteMenRank, m_material.m_whiteMen, squares);
+	Bitboard whiteMen = GetAbsoluteSquares(squares, m_material.m_whiteMen, 0, 0);
+
+	UnrankCombination(blackMenRank, m_material.m_blackMen, squares);
+	Bitboard blackMen = GetAbsoluteSquares(squares, m_material.m_blackMen, 0, s_blackManSquareOffset);
+	if (whiteMen & blackMen)
+		return false;
+
+	Bitboard men = whiteMen | blackMen;
+	UnrankCombination(whiteKingRank, m_material.m_whiteKings, squares);
+	Bitboard whiteKings = GetAbsoluteSquares(squares, m_material.m_whiteKings, men, 0);
+
+	UnrankCombination(blackKingRank, m_material.m_blackKings, squares);
+	Bitboard blackKings = GetAbsoluteSquares(squares, m_material.m_blackKings, men | whiteKings, 0);
+
+	positionOut.m_whitePieces = whiteMen | whiteKings;
+	positionOut.m_blackPieces = blackMen | blackKings;
+	positionOut.m_kings = whiteKings | blackKings;
+	positionOut.m_isWhitePlayerTurn = isWhitePlayerTurn;
+	return true;
+}
+
+//---------------------------------------------------------------
+
+// The mapped table of one material, results and distances for white and black to move.
+struct Tablebase::MaterialTable
+{
+	explicit MaterialTable(const TablebaseMaterial& material)
+		: m_indexer(material)
+		, m_results()
+		, m_distances()
+	{
+	}
+
+	MappedFile m_file;
+	TablebaseIndexer m_indexer;
+	const uint8_t* m_results[2];
+	const uint8_t* m_distances[2];
+};
+
+Tablebase::Tablebase()
+	: m_tables(new std::unique_ptr<MaterialTable>[s_materialKeyCount])
+	, m_hasDistances(true)
+{
+}
+
+Tablebase::~Tablebase()
+{
+}
+
+bool Tablebase::Open(const std::string& directory)
+{
+	bool isAnyOpen = false;
+	for (int whiteMen = 0; whiteMen <= s_maxTablebasePieces; ++whiteMen)
+	{
+		for (int whiteKings = 0; whiteMen + whiteKings <= s_maxTablebasePieces; ++whiteKings)
+		{
+			for (int blackMen = 0; whiteMen + whiteKings + blackMen <= s_maxTablebasePieces; ++blackMen)
+			{
+				for (int blackKings = 0; whiteMen + whiteKings + blackMen + blackKings <= s_maxTablebasePieces; ++blackKings)
+				{
+					if (whiteMen + whiteKings != 0 && blackMen + blackKings != 0)
+						isAnyOpen |= OpenMaterial(directory, TablebaseMaterial(whiteMen, whiteKings, blackMen, blackKings));
+				}
+			}
+		}
+	}
+
+	return isAnyOpen;
+}
+
+bool Tablebase::OpenMaterial(const std::string& directory, const TablebaseMaterial& material)
+{
+	std::string filePath = directory + "/" + material.GetFileName();
+
+	std::unique_ptr<MaterialTable> table(new MaterialTable(material));
+	if (!table->m_file.Open(filePath, FILE_ACCESS_RANDOM))
+		return false;
+
+	uint64_t positionCount = table->m_indexer.GetPositionCount();
+	bool hasDistances = false;
+	if (!IsValidHeader(table->m_file.GetData(), table->m_file.GetSize(), positionCount, hasDistances))
+	{
+		LOG_ERROR(Logger::CATEGORY_SEARCH, "Not a complete tablebase file: " + filePath);
+		return false;
+	}
+
+	const uint8_t* data = table->m_file.GetData() + s_headerSize;
+	for (int side = 0; side < 2; ++side)
+	{
+		table->m_results[side] = data + side * GetPackedSize(positionCount);
+		if (hasDistances)
+			table->m_distances[side] = data + 2 * GetPackedSize(positionCount) + side * positionCount;
+	}
+
+	m_hasDistances &= hasDistances;
+	m_tables[GetMaterialKey(material)] = std::move(table);
+	return true;
+}
+
+int Tablebase::GetMaxPieces() const
+{
+	// The largest count with the tables of every material up to it open.
+	for (int pieceCount = 2; pieceCount <= s_maxTablebasePieces; ++pieceCount)
+	{
+		for (int whiteMen = 0; whiteMen <= pieceCount; ++whiteMen)
+		{
+			for (int whiteKings = 0; whiteMen + whiteKings <= pieceCount; ++whiteKings)
+			{
+				for (int blackMen = 0; whiteMen + whiteKings + blackMen <= pieceCount; ++blackMen)
+				{
+					TablebaseMaterial material(whiteMen, whiteKings, blackMen,
+						pieceCount - whiteMen - whiteKings - blackMen);
+					if (whiteMen + whiteKings != 0 && material.m_blackMen + material.m_blackKings != 0
+						&& !m_tables[GetMaterialKey(material)])
+					{
+						return pieceCount - 1;
+					}
+				}
+			}
+		}
+	}
+
+	return s_maxTablebasePieces;
+}
+
+bool Tablebase::Probe(const Position& position, TablebaseResult& resultOut, int& distanceOut) const
+{
+	// A side without pieces has lost, no table is needed for that.
+	distanceOut = 0;
+	if (position.GetPlayerPieces() == 0 || position.GetEnemyPieces() == 0)
+	{
+		resultOut = position.GetPlayerPieces() == 0 ? TABLEBASE_LOSS : TABLEBASE_WIN;
+		return true;
+	}
+
+	TablebaseMaterial material = TablebaseMaterial::FromPosition(position);
+	if (material.m_whiteMen > s_maxTablebasePieces || material.m_whiteKings > s_maxTablebasePieces
+		|| material.m_blackMen > s_maxTablebasePieces || material.m_blackKings > s_maxTablebasePieces)
+	{
+		return false;
+	}
+
+	const MaterialTable* table = m_tables[GetMaterialKey(material)].get();
+	if (!table)
+		return false;
+
+	uint64_t index = table->m_indexer.GetIndex(position);
+	int side = position.m_isWhitePlayerTurn ? 0 : 1;
+
+	resultOut = static_cast<TablebaseResult>((table->m_results[side][index / 4] >> (2 * (index % 4))) & 3);
+	if (table->m_distances[side])
+		distanceOut = table->m_distances[side][index];
+
+	return true;
+}
+
+int Tablebase::GetMaterialKey(const TablebaseMaterial& material)
+{
+	return ((material.m_whiteMen * s_materialBase + material.m_whiteKings) * s_materialBase + material.m_blackMen)
+		* s_materialBase + material.m_blackKings;
+}
+
+//---------------------------------------------------------------
+
+bool WriteTablebaseFile(const std::string& directory, const TablebaseMaterial& material, uint64_t positionCount,
+	const uint8_t* const results[2], const uint8_t* const distances[2], bool shouldWriteDistances)
+{
+	std::string filePath = directory + "/" + material.GetFileName();
+	AtomicFileWriter file;
+	if (!file.Open(filePath))
+	{
+		LOG_ERROR(Logger::CATEGORY_SEARCH, "Cannot write the tablebase file " + filePath);
+		return false;
+	}
+
+	uint8_t header[s_headerSize] = {};
+	std::memcpy(header, s_magic, sizeof(s_magic));
+	header[4] = s_version;
+	header[5] = shouldWriteDistances ? s_distancesFlag : 0;
+	std::memcpy(header + 8, &positionCount, sizeof(positionCount));
+	file.Write(header, s_headerSize);
+
+	// Four results to a byte, the first one in the lowest bits.
+	std::vector<uint8_t> packed(GetPackedSize(positionCount));
+	for (int side = 0; side < 2; ++side)
+	{
+		std::fill(packed.begin(), packed.end(), 0);
+		for (uint64_t index = 0; index < positionCount; ++index)
+			packed[index / 4] |= static_cast<uint8_t>(results[side][index] << (2 * (index % 4)));
+
+		file.Write(packed.data(), packed.size());
+	}
+
+	if (shouldWriteDistances)
+	{
+		for (int side = 0; side < 2; ++side)
+			file.Write(distances[side], positionCount);
+	}
+
+	if (!file.Commit())
+	{
+		LOG_ERROR(Logger::CATEGORY_SEARCH, "Cannot write the tablebase file " + filePath);
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,118 @@
+//---------------------------------------------------------------
+//
+// Tablebase.h
+//
+
+#pragma once
+
+#include "MappedFile.h"
+#include "Position.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace {
+	// Most pieces on the board a tablebase is made for.
+	const int s_maxTablebasePieces = 8;
+}
+
+enum TablebaseResult
+{
+	TABLEBASE_DRAW,
+	TABLEBASE_WIN,
+	TABLEBASE_LOSS,
+
+	// Index of an impossible placement, such as two men on one square.
+	TABLEBASE_INVALID,
+};
+
+// Number of men and kings of each side. Every material has a table of its own.
+struct TablebaseMaterial
+{
+	TablebaseMaterial();
+	TablebaseMaterial(int whiteMen, int whiteKings, int blackMen, int blackKings);
+
+	static TablebaseMaterial FromPosition(const Position& position);
+
+	int GetPieceCount() const { return m_whiteMen + m_whiteKings + m_blackMen + m_blackKings; }
+
+	// File the table of the material is stored in, e.g. "tb-2011.cktb".
+	std::string GetFileName() const;
+
+	int m_whiteMen;
+	int m_whiteKings;
+	int m_blackMen;
+	int m_blackKings;
+};
+
+// Perfect hash of the positions of one material. Each group of pieces is ranked as a combination
+// of the squares it may stand on: men on the 28 squares short of their crowning row, kings on the
+// squares the men left empty. Men of both colors rank independently, so a few indices place two
+// men on one square and are marked invalid. The side to move picks one of two tables.
+class TablebaseIndexer
+{
+public:
+	explicit TablebaseIndexer(const TablebaseMaterial& material);
+
+	// Positions of one side to move.
+	uint64_t GetPositionCount() const { return m_positionCount; }
+
+	// The position must have this material.
+	uint64_t GetIndex(const Position& position) const;
+
+	// Returns false if the index is an impossible placement.
+	bool GetPosition(uint64_t index, bool isWhitePlayerTurn, Position& positionOut) const;
+
+private:
+	TablebaseMaterial m_material;
+
+	// Combinations of each group, multiplied together into the index from the white men down.
+	uint64_t m_blackMenCount;
+	uint64_t m_whiteKingCount;
+	uint64_t m_blackKingCount;
+	uint64_t m_positionCount;
+};
+
+//---------------------------------------------------------------
+
+// Win, draw and loss of every position up to some number of pieces, read through memory mapped
+// files. Each material is a file holding a header, two bits per position for each side to move and,
+// optionally, a byte per position with the plies to the end of the game, capped at 255. A probe is
+// an index computation and one or two byte reads.
+class Tablebase
+{
+public:
+	Tablebase();
+	~Tablebase();
+
+	// Maps every table in the directory. Returns false if there is none.
+	bool Open(const std::string& directory);
+
+	// Maps the table of one material. Returns false if the file is missing or not a table.
+	bool OpenMaterial(const std::string& directory, const TablebaseMaterial& material);
+
+	// Every position with at most this many pieces is in the tables, zero if none is.
+	int GetMaxPieces() const;
+
+	// Whether the tables hold the distances to the end of the game.
+	bool HasDistances() const { return m_hasDistances; }
+
+	// Result of the position for the side to move, and the plies until the game ends with best play,
+	// zero without distances. Returns false if the position is not in the tables.
+	bool Probe(const Position& position, TablebaseResult& resultOut, int& distanceOut) const;
+
+private:
+	struct MaterialTable;
+
+	static int GetMaterialKey(const TablebaseMaterial& material);
+
+	std::unique_ptr<std::unique_ptr<MaterialTable>[]> m_tables;
+	bool m_hasDistances;
+};
+
+// Writes the table of a material, results and distances per side to move as produced by the
+// generator. Results are TablebaseResult values, written to a temporary file that is renamed once
+// complete, so a file that exists is always whole. Returns false if it cannot be written.
+bool WriteTablebaseFile(const std::string& directory, const TablebaseMaterial& material, uint64_t positionCount,
+	const uint8_t* const results[2], const uint8_t* const distances[2], bool shouldWriteDistances);
@@ -0,0 +1,128 @@
+//---------------------------------------------------------------
+//
+// TablebaseGenMain.cpp
+//
+// Endgame tablebase generator. Solves every material up to the given number of pieces into the
+// output directory, smallest first. Materials already in the directory are kept, so a run that was
+// stopped resumes with the material it was working on. On one thread four pieces take about ten
+// seconds and five pieces about five minutes. Six pieces have eighteen times as many positions as
+// five, so expect well over an hour on one thread, and the largest of their materials needs about
+// 1.5 GB of memory while it is solved.
+//
+// usage: tablebase-gen --pieces <count> --output <directory> [--threads <count>] [--no-distances]
+//
+
+#include "TablebaseGenerator.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+//==============================================================================
+
+const int s_defaultPieceCount = 4;
+
+struct TablebaseGenOptions
+{
+	TablebaseGenOptions()
+		: m_pieceCount(s_defaultPieceCount)
+		, m_threadCount(static_cast<int>(std::thread::hardware_concurrency()))
+		, m_shouldWriteDistances(true)
+	{
+		if (m_threadCount <= 0)
+			m_threadCount = 1;
+	}
+
+	int m_pieceCount;
+	int m_threadCount;
+	bool m_shouldWriteDistances;
+	std::string m_directory;
+};
+
+void PrintUsage()
+{
+	std::printf("usage: tablebase-gen --pieces <count> --output <directory> [--threads <count>] [--no-distances]\n"
+		"  --pieces        most pieces on the board, 2 to %d, defaults to %d\n"
+		"  --output        directory to write the tables to\n"
+		"  --threads       threads to solve with, defaults to the hardware threads\n"
+		"  --no-distances  store only win, draw and loss\n", s_maxTablebasePieces, s_defaultPieceCount);
+}
+
+bool ParseOptions(int argc, char** argv, TablebaseGenOptions& optionsOut)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument(argv[i]);
+		if (argument == "--pieces" && i + 1 < argc)
+		{
+			optionsOut.m_pieceCount = std::atoi(argv[++i]);
+		}
+		else if (argument == "--output" && i + 1 < argc)
+		{
+			optionsOut.m_directory = argv[++i];
+		}
+		else if (argument == "--threads" && i + 1 < argc)
+		{
+			optionsOut.m_threadCount = std::atoi(argv[++i]);
+		}
+		else if (argument == "--no-distances")
+		{
+			optionsOut.m_shouldWriteDistances = false;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return !optionsOut.m_directory.empty() && optionsOut.m_pieceCount >= 2
+		&& optionsOut.m_pieceCount <= s_maxTablebasePieces && optionsOut.m_threadCount > 0;
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+	TablebaseGenOptions options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	std::vector<TablebaseMaterial> materials;
+	TablebaseGenerator::GetMaterials(options.m_pieceCount, materials);
+
+	TablebaseGenerator generator(options.m_directory, options.m_threadCount, options.m_shouldWriteDistances);
+	for (const TablebaseMaterial& material : materials)
+	{
+		std::string fileName = material.GetFileName();
+		if (generator.IsGenerated(material))
+		{
+			std::printf("%s  already generated\n", fileName.c_str());
+			continue;
+		}
+
+		TablebaseGenerationStats stats;
+		if (!generator.Generate(material, stats))
+		{
+			std::fprintf(stderr, "Error: cannot write %s to %s\n", fileName.c_str(), options.m_directory.c_str());
+			return 1;
+		}
+
+		std::printf("%s  %llu positions, %llu wins, %llu losses, %llu draws, longest %d plies, %d passes, "
+			"%.2f seconds\n", fileName.c_str(), static_cast<unsigned long long>(stats.m_positionCount),
+			static_cast<unsigned long long>(stats.m_winCount), static_cast<unsigned long long>(stats.m_lossCount),
+			static_cast<unsigned long long>(stats.m_drawCount), stats.m_maxDistance, stats.m_passCount,
+			stats.m_seconds);
+		std::fflush(stdout);
+	}
+
+	return 0;
+}
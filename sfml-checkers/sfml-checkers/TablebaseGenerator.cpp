@@ -0,0 +1,447 @@
+//---------------------------------------------------------------
+//
+// TablebaseGenerator.cpp
+//
+
+#include "TablebaseGenerator.h"
+#include "MoveGenerator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+//==============================================================================
+
+// Positions a thread takes from the shared counter at a time.
+const uint64_t s_chunkSize = 4096;
+
+// Distances are stored in a byte.
+const int s_maxDistance = 255;
+
+// Set in the open turn count of a position with a turn out of the material that does not lose, so
+// the position is never lost.
+const uint8_t s_cannotLoseFlag = 0x80;
+
+// A solved position packs its result into the high byte and its distance into the low byte.
+// Unresolved positions are zero, which reads as a draw once the last pass is done.
+typedef uint16_t SolvedState;
+
+// A position, numbered across both sides to move with white first, to resolve in a later pass.
+struct ScheduledState
+{
+	uint64_t m_entry;
+	SolvedState m_state;
+};
+
+// What one thread found during a pass, merged once it is done.
+struct PassOutput
+{
+	std::vector<uint64_t> m_solvedEntries;
+	std::vector<std::pair<int, ScheduledState>> m_scheduledStates;
+};
+
+SolvedState PackState(TablebaseResult result, int distance)
+{
+	return static_cast<SolvedState>((result << 8) | std::min(distance, s_maxDistance));
+}
+
+TablebaseResult GetStateResult(SolvedState state)
+{
+	return static_cast<TablebaseResult>(state >> 8);
+}
+
+int GetStateDistance(SolvedState state)
+{
+	return state & 0xFF;
+}
+
+int GetSideIndex(bool isWhitePlayerTurn)
+{
+	return isWhitePlayerTurn ? 0 : 1;
+}
+
+// The squares diagonally next to each square.
+void GetNeighbourSquares(Bitboard neighboursOut[s_squareCount])
+{
+	for (int square = 0; square < s_squareCount; ++square)
+	{
+		BoardIndex boardIndex = BoardIndexFromSquare(square);
+		neighboursOut[square] = 0;
+		for (int rowStep = -1; rowStep <= 1; rowStep += 2)
+		{
+			for (int columnStep = -1; columnStep <= 1; columnStep += 2)
+			{
+				int neighbour = SquareFromBoardIndex(BoardIndex(boardIndex.first + rowStep, boardIndex.second + columnStep));
+				if (neighbour >= 0)
+					neighboursOut[square] |= SquareMask(neighbour);
+			}
+		}
+	}
+}
+
+// Visits every position with the same material that the position follows from by a legal turn.
+// Within a material those are the quiet moves that crown nothing, so a piece of the side that just
+// moved steps back to a neighbouring empty square: a man to the row behind it, a king to any. The
+// move only was legal if there was no capture to make instead.
+template <typename Visit>
+void VisitParents(const Position& position, const Bitboard neighbours[s_squareCount], const Visit& visit)
+{
+	bool isWhiteMover = !position.m_isWhitePlayerTurn;
+	Bitboard movers = isWhiteMover ? position.m_whitePieces : position.m_blackPieces;
+	Bitboard empty = position.GetEmpty();
+
+	for (Bitboard destinations = movers; destinations; destinations &= destinations - 1)
+	{
+		int destination = GetLowestSquare(destinations);
+
+		// White men move down the board, to higher squares, black men up.
+		Bitboard sources = neighbours[destination] & empty;
+		if (!(position.m_kings & SquareMask(destination)))
+			sources &= isWhiteMover ? SquareMask(destination) - 1 : ~(SquareMask(destination) - 1);
+
+		for (; sources; sources &= sources - 1)
+		{
+			UndoRecord undo;
+			undo.m_capturedPieces = 0;
+			undo.m_capturedKings = 0;
+			undo.m_source = static_cast<int8_t>(GetLowestSquare(sources));
+			undo.m_destination = static_cast<int8_t>(destination);
+			undo.m_isCrowned = false;
+			undo.m_isTurnEnd = true;
+
+			Position parent = position;
+			parent.UnmakeMove(undo);
+			if (!MoveGenerator::GetJumpers(parent))
+				visit(parent);
+		}
+	}
+}
+
+// Runs the work on every thread and waits for them.
+template <typename Work>
+void RunThreads(int threadCount, const Work& work)
+{
+	std::vector<std::thread> threads;
+	for (int i = 1; i < threadCount; ++i)
+		threads.emplace_back(work);
+
+	work();
+	for (std::thread& thread : threads)
+		thread.join();
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+TablebaseGenerationStats::TablebaseGenerationStats()
+	: m_positionCount(0)
+	, m_winCount(0)
+	, m_lossCount(0)
+	, m_drawCount(0)
+	, m_passCount(0)
+	, m_maxDistance(0)
+	, m_seconds(0.0)
+{
+}
+
+//---------------------------------------------------------------
+
+TablebaseGenerator::TablebaseGenerator(const std::string& directory, int threadCount, bool shouldWriteDistances)
+	: m_directory(directory)
+	, m_threadCount(std::max(threadCount, 1))
+	, m_shouldWriteDistances(shouldWriteDistances)
+{
+}
+
+void TablebaseGenerator::GetMaterials(int maxPieces, std::vector<TablebaseMaterial>& materialsOut)
+{
+	materialsOut.clear();
+	maxPieces = std::min(maxPieces, s_maxTablebasePieces);
+	for (int pieceCount = 2; pieceCount <= maxPieces; ++pieceCount)
+	{
+		// Captures lead to fewer pieces, crownings to fewer men, so more men come later.
+		for (int menCount = 0; menCount <= pieceCount; ++menCount)
+		{
+			for (int whiteMen = 0; whiteMen <= menCount; ++whiteMen)
+			{
+				int blackMen = menCount - whiteMen;
+				for (int whiteKings = 0; whiteKings <= pieceCount - menCount; ++whiteKings)
+				{
+					int blackKings = pieceCount - menCount - whiteKings;
+					if (whiteMen + whiteKings != 0 && blackMen + blackKings != 0)
+						materialsOut.push_back(TablebaseMaterial(whiteMen, whiteKings, blackMen, blackKings));
+				}
+			}
+		}
+	}
+}
+
+bool TablebaseGenerator::IsGenerated(const TablebaseMaterial& material)
+{
+	return m_tablebase.OpenMaterial(m_directory, material);
+}
+
+bool TablebaseGenerator::Generate(const TablebaseMaterial& material, TablebaseGenerationStats& statsOut)
+{
+	auto startTime = std::chrono::steady_clock::now();
+
+	TablebaseIndexer indexer(material);
+	uint64_t positionCount = indexer.GetPositionCount();
+	uint64_t entryCount = 2 * positionCount;
+
+	// For every position of both sides to move: its result once solved, the turns within the
+	// material to positions not solved yet or won by the opponent, and the longest win the opponent
+	// has after a turn out of the material.
+	std::unique_ptr<std::atomic<SolvedState>[]> states(new std::atomic<SolvedState>[entryCount]);
+	std::unique_ptr<std::atomic<uint8_t>[]> openTurnCounts(new std::atomic<uint8_t>[entryCount]);
+	std::unique_ptr<uint8_t[]> exitWinDistances(new uint8_t[entryCount]);
+	for (uint64_t entry = 0; entry < entryCount; ++entry)
+	{
+		states[entry].store(0, std::memory_order_relaxed);
+		openTurnCounts[entry].store(0, std::memory_order_relaxed);
+		exitWinDistances[entry] = 0;
+	}
+
+	Bitboard neighbours[s_squareCount];
+	GetNeighbourSquares(neighbours);
+
+	// The positions solved in the last pass, and those whose result and distance are known before
+	// their pass comes, by the pass.
+	std::vector<uint64_t> solvedEntries;
+	std::vector<std::vector<ScheduledState>> scheduledStates;
+	std::mutex outputMutex;
+
+	auto mergeOutput = [&](PassOutput& output)
+	{
+		std::lock_guard<std::mutex> lock(outputMutex);
+		solvedEntries.insert(solvedEntries.end(), output.m_solvedEntries.begin(), output.m_solvedEntries.end());
+		for (const std::pair<int, ScheduledState>& scheduled : output.m_scheduledStates)
+		{
+			if (static_cast<int>(scheduledStates.size()) <= scheduled.first)
+				scheduledStates.resize(scheduled.first + 1);
+
+			scheduledStates[scheduled.first].push_back(scheduled.second);
+		}
+	};
+
+	auto resolve = [&](uint64_t entry, SolvedState state)
+	{
+		SolvedState unresolved = 0;
+		return states[entry].compare_exchange_strong(unresolved, state, std::memory_order_relaxed);
+	};
+
+	std::atomic<uint64_t> nextIndex(0);
+
+	// Generates the turns of every position once. Positions without one are lost, turns out of the
+	// material are probed right away and the ones within it counted.
+	auto countTurns = [&]()
+	{
+		PassOutput output;
+		MoveList turns;
+		for (;;)
+		{
+			uint64_t chunkStart = nextIndex.fetch_add(s_chunkSize);
+			if (chunkStart >= entryCount)
+				break;
+
+			uint64_t chunkEnd = std::min(chunkStart + s_chunkSize, entryCount);
+			for (uint64_t entry = chunkStart; entry < chunkEnd; ++entry)
+			{
+				int side = entry < positionCount ? 0 : 1;
+				Position position;
+				if (!indexer.GetPosition(entry - side * positionCount, side == 0, position))
+				{
+					states[entry].store(PackState(TABLEBASE_INVALID, 0), std::memory_order_relaxed);
+					continue;
+				}
+
+				turns.Clear();
+				MoveGenerator::GenerateTurns(position, turns);
+				if (turns.IsEmpty())
+				{
+					states[entry].store(PackState(TABLEBASE_LOSS, 0), std::memory_order_relaxed);
+					output.m_solvedEntries.push_back(entry);
+					continue;
+				}
+
+				int openTurnCount = 0;
+				int minExitLossDistance = s_maxDistance + 1;
+				int maxExitWinDistance = 0;
+				bool canLose = true;
+				for (const PackedMove& turn : turns)
+				{
+					UndoRecord undo;
+					Position child = position;
+					child.MakeMove(turn.GetSource(), turn.GetDestination(), turn.GetCapturedPieces(), undo);
+					if (!turn.IsCapture() && !undo.m_isCrowned)
+					{
+						++openTurnCount;
+						continue;
+					}
+
+					TablebaseResult result = TABLEBASE_DRAW;
+					int distance = 0;
+					m_tablebase.Probe(child, result, distance);
+					if (result == TABLEBASE_LOSS)
+						minExitLossDistance = std::min(minExitLossDistance, distance);
+					else if (result == TABLEBASE_WIN)
+						maxExitWinDistance = std::max(maxExitWinDistance, distance);
+					else
+						canLose = false;
+				}
+
+				// Won at the latest one ply after the capture or crowning that wins, and lost only once
+				// the turns within the material all turn out lost too.
+				if (minExitLossDistance <= s_maxDistance)
+				{
+					canLose = false;
+					output.m_scheduledStates.push_back(std::make_pair(minExitLossDistance + 1,
+						ScheduledState{ entry, PackState(TABLEBASE_WIN, minExitLossDistance + 1) }));
+				}
+				else if (canLose && openTurnCount == 0)
+				{
+					output.m_scheduledStates.push_back(std::make_pair(maxExitWinDistance + 1,
+						ScheduledState{ entry, PackState(TABLEBASE_LOSS, maxExitWinDistance + 1) }));
+				}
+
+				openTurnCounts[entry].store(static_cast<uint8_t>(openTurnCount | (canLose ? 0 : s_cannotLoseFlag)),
+					std::memory_order_relaxed);
+				exitWinDistances[entry] = static_cast<uint8_t>(maxExitWinDistance);
+			}
+		}
+
+		mergeOutput(output);
+	};
+
+	// Resolves the parents of the positions solved in the last pass: a parent of a lost position is
+	// won, a parent whose last open turn led to a won position is lost. Those are all the positions
+	// the pass's distance from the end, apart from the ones scheduled for it.
+	auto solvePass = [&](int pass, const std::vector<uint64_t>& lastSolvedEntries)
+	{
+		PassOutput output;
+		for (;;)
+		{
+			uint64_t chunkStart = nextIndex.fetch_add(s_chunkSize);
+			if (chunkStart >= lastSolvedEntries.size())
+				break;
+
+			uint64_t chunkEnd = std::min<uint64_t>(chunkStart + s_chunkSize, lastSolvedEntries.size());
+			for (uint64_t i = chunkStart; i < chunkEnd; ++i)
+			{
+				uint64_t childEntry = lastSolvedEntries[i];
+				int childSide = childEntry < positionCount ? 0 : 1;
+				bool isChildLost = GetStateResult(states[childEntry].load(std::memory_order_relaxed)) == TABLEBASE_LOSS;
+
+				Position child;
+				indexer.GetPosition(childEntry - childSide * positionCount, childSide == 0, child);
+				VisitParents(child, neighbours, [&](const Position& parent)
+				{
+					uint64_t entry = GetSideIndex(parent.m_isWhitePlayerTurn) * positionCount + indexer.GetIndex(parent);
+					if (states[entry].load(std::memory_order_relaxed) != 0)
+						return;
+
+					if (isChildLost)
+					{
+						if (resolve(entry, PackState(TABLEBASE_WIN, pass)))
+							output.m_solvedEntries.push_back(entry);
+
+						return;
+					}
+
+					uint8_t openTurnCount = openTurnCounts[entry].fetch_sub(1, std::memory_order_relaxed);
+					if (openTurnCount != 1)
+						return;
+
+					// The longest win the opponent has decides how long the loss takes.
+					int lossDistance = std::max(pass, exitWinDistances[entry] + 1);
+					if (lossDistance > pass)
+					{
+						output.m_scheduledStates.push_back(std::make_pair(lossDistance,
+							ScheduledState{ entry, PackState(TABLEBASE_LOSS, lossDistance) }));
+					}
+					else if (resolve(entry, PackState(TABLEBASE_LOSS, pass)))
+					{
+						output.m_solvedEntries.push_back(entry);
+					}
+				});
+			}
+		}
+
+		mergeOutput(output);
+	};
+
+	RunThreads(m_threadCount, countTurns);
+
+	// Every pass only visits the parents of the positions the one before solved, the positions in
+	// between are never looked at again.
+	int pass = 1;
+	for (;; ++pass)
+	{
+		std::vector<uint64_t> lastSolvedEntries;
+		lastSolvedEntries.swap(solvedEntries);
+		if (lastSolvedEntries.empty() && pass >= static_cast<int>(scheduledStates.size()))
+			break;
+
+		if (pass < static_cast<int>(scheduledStates.size()))
+		{
+			for (const ScheduledState& scheduled : scheduledStates[pass])
+			{
+				if (resolve(scheduled.m_entry, scheduled.m_state))
+					solvedEntries.push_back(scheduled.m_entry);
+			}
+
+			std::vector<ScheduledState>().swap(scheduledStates[pass]);
+		}
+
+		nextIndex = 0;
+		RunThreads(m_threadCount, [&]() { solvePass(pass, lastSolvedEntries); });
+	}
+
+	std::unique_ptr<uint8_t[]> results[2];
+	std::unique_ptr<uint8_t[]> distances[2];
+	statsOut = TablebaseGenerationStats();
+	statsOut.m_passCount = pass;
+	for (int side = 0; side < 2; ++side)
+	{
+		results[side].reset(new uint8_t[positionCount]);
+		distances[side].reset(new uint8_t[positionCount]);
+		for (uint64_t index = 0; index < positionCount; ++index)
+		{
+			SolvedState state = states[side * positionCount + index].load(std::memory_order_relaxed);
+			TablebaseResult result = GetStateResult(state);
+			results[side][index] = static_cast<uint8_t>(result);
+			distances[side][index] = static_cast<uint8_t>(GetStateDistance(state));
+
+			if (result == TABLEBASE_INVALID)
+				continue;
+
+			++statsOut.m_positionCount;
+			if (result == TABLEBASE_WIN)
+				++statsOut.m_winCount;
+			else if (result == TABLEBASE_LOSS)
+				++statsOut.m_lossCount;
+			else
+				++statsOut.m_drawCount;
+
+			statsOut.m_maxDistance = std::max(statsOut.m_maxDistance, GetStateDistance(state));
+		}
+	}
+
+	states.reset();
+	openTurnCounts.reset();
+	exitWinDistances.reset();
+
+	const uint8_t* const resultData[2] = { results[0].get(), results[1].get() };
+	const uint8_t* const distanceData[2] = { distances[0].get(), distances[1].get() };
+	if (!WriteTablebaseFile(m_directory, material, positionCount, resultData, distanceData, m_shouldWriteDistances))
+		return false;
+
+	statsOut.m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	return m_tablebase.OpenMaterial(m_directory, material);
+}
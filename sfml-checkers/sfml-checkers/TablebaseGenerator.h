@@ -0,0 +1,64 @@
+//---------------------------------------------------------------
+//
+// TablebaseGenerator.h
+//
+
+#pragma once
+
+#include "Tablebase.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct TablebaseGenerationStats
+{
+	TablebaseGenerationStats();
+
+	uint64_t m_positionCount;
+	uint64_t m_winCount;
+	uint64_t m_lossCount;
+	uint64_t m_drawCount;
+
+	// Passes it took until none solved anything, one per ply of distance from the end.
+	int m_passCount;
+
+	// Longest win or loss, in plies.
+	int m_maxDistance;
+
+	double m_seconds;
+};
+
+// Solves the materials of a tablebase by retrograde analysis, with the move generator the game
+// plays by. The turns of every position are generated once: positions without one are lost,
+// captures and crownings lead into smaller materials, solved first and probed from their files,
+// and the other turns are counted. Then every pass solves the positions one ply further from the
+// end, by stepping back from the positions the pass before solved: a position before a lost one is
+// won, one whose last counted turn led to a won position is lost. Whatever no pass solves is a draw.
+// Each position is looked at once more for every turn leading into it, however long the material
+// takes to solve.
+//
+// The work of a pass is dealt out to the threads in chunks. Each material is written to its own
+// file once solved, so an interrupted run picks up where it left off.
+class TablebaseGenerator
+{
+public:
+	TablebaseGenerator(const std::string& directory, int threadCount, bool shouldWriteDistances);
+
+	// Every material with at most this many pieces, each one after the materials it leads into.
+	static void GetMaterials(int maxPieces, std::vector<TablebaseMaterial>& materialsOut);
+
+	// Whether the material was solved and written by an earlier run.
+	bool IsGenerated(const TablebaseMaterial& material);
+
+	// Solves the material and writes it out. The materials it leads into must be generated.
+	bool Generate(const TablebaseMaterial& material, TablebaseGenerationStats& statsOut);
+
+private:
+	std::string m_directory;
+	int m_threadCount;
+	bool m_shouldWriteDistances;
+
+	// The materials solved so far, read back from their files.
+	Tablebase m_tablebase;
+};
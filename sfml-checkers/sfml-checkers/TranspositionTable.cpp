@@ -0,0 +1,226 @@
+//---------------------------------------------------------------
+//
+// TranspositionTable.cpp
+//
+
+#include "TranspositionTable.h"
+
+namespace {
+
+//==============================================================================
+
+// Layout of the packed data word.
+const int s_depthShift = 32;
+const int s_boundShift = 40;
+const int s_generationShift = 42;
+const int s_moveShift = 48;
+
+const uint64_t s_scoreMask = 0xFFFFFFFFull;
+const uint64_t s_depthMask = 0xFF;
+const uint64_t s_boundMask = 0x3;
+const uint64_t s_generationMask = 0x3F;
+const uint64_t s_moveMask = 0x7FF;
+
+// Buckets looked at by GetUsagePermille.
+const size_t s_usageSampleBuckets = 250;
+
+uint64_t PackData(int score, int depth, TranspositionBound bound, int generation, int move)
+{
+	return (static_cast<uint64_t>(static_cast<uint32_t>(score)) & s_scoreMask)
+		| (static_cast<uint64_t>(depth) & s_depthMask) << s_depthShift
+		| (static_cast<uint64_t>(bound) & s_boundMask) << s_boundShift
+		| (static_cast<uint64_t>(generation) & s_generationMask) << s_generationShift
+		| (static_cast<uint64_t>(move + 1) & s_moveMask) << s_moveShift;
+}
+
+int GetDepth(uint64_t data)
+{
+	return static_cast<int>((data >> s_depthShift) & s_depthMask);
+}
+
+int GetGeneration(uint64_t data)
+{
+	return static_cast<int>((data >> s_generationShift) & s_generationMask);
+}
+
+void UnpackData(uint64_t data, TranspositionEntry& entryOut)
+{
+	entryOut.m_score = static_cast<int32_t>(static_cast<uint32_t>(data & s_scoreMask));
+	entryOut.m_depth = GetDepth(data);
+	entryOut.m_bound = static_cast<TranspositionBound>((data >> s_boundShift) & s_boundMask);
+	entryOut.m_move = static_cast<int>((data >> s_moveShift) & s_moveMask) - 1;
+}
+
+//==============================================================================
+
+} // anonymous namespace
+
+TranspositionEntry::TranspositionEntry()
+	: m_score(0)
+	, m_depth(0)
+	, m_bound(BOUND_NONE)
+	, m_move(-1)
+{
+}
+
+//---------------------------------------------------------------
+
+TranspositionTable::TranspositionTable(size_t megabytes)
+	: m_bucketMask(0)
+	, m_partitionMask(0)
+	, m_partitionShift(0)
+	, m_generation(0)
+{
+	size_t budget = megabytes * 1024 * 1024;
+	size_t bucketCount = 1;
+	while (bucketCount * 2 * sizeof(Bucket) <= budget)
+	{
+		bucketCount *= 2;
+	}
+
+	m_buckets.reset(new Bucket[bucketCount]);
+	m_bucketMask = bucketCount - 1;
+	SetPartitionCount(1);
+	Clear();
+}
+
+TranspositionTable::~TranspositionTable()
+{
+}
+
+void TranspositionTable::Clear()
+{
+	for (uint64_t i = 0; i <= m_bucketMask; ++i)
+	{
+		for (int slot = 0; slot < s_bucketSize; ++slot)
+		{
+			m_buckets[i].m_keys[slot].store(0, std::memory_order_relaxed);
+			m_buckets[i].m_data[slot].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	m_generation = 0;
+}
+
+void TranspositionTable::NewSearch()
+{
+	m_generation = static_cast<uint8_t>((m_generation + 1) & s_generationMask);
+}
+
+void TranspositionTable::SetPartitionCount(int partitionCount)
+{
+	int partitionBits = 0;
+	while ((1 << partitionBits) < partitionCount && (m_bucketMask >> partitionBits) > 0)
+	{
+		++partitionBits;
+	}
+
+	m_partitionMask = m_bucketMask >> partitionBits;
+
+	m_partitionShift = 0;
+	while ((m_partitionMask >> m_partitionShift) > 0)
+	{
+		++m_partitionShift;
+	}
+}
+
+TranspositionProbeResult TranspositionTable::Probe(uint64_t key, TranspositionEntry& entryOut, int partition) const
+{
+	Bucket& bucket = GetBucket(key, partition);
+
+	bool isBucketTaken = false;
+	for (int slot = 0; slot < s_bucketSize; ++slot)
+	{
+		uint64_t data = bucket.m_data[slot].load(std::memory_order_relaxed);
+		uint64_t storedKey = bucket.m_keys[slot].load(std::memory_order_relaxed);
+
+		if (data == 0)
+			continue;
+
+		if ((storedKey ^ data) == key)
+		{
+			UnpackData(data, entryOut);
+			return PROBE_HIT;
+		}
+
+		isBucketTaken = true;
+	}
+
+	return isBucketTaken ? PROBE_COLLISION : PROBE_MISS;
+}
+
+void TranspositionTable::Store(uint64_t key, int score, int depth, TranspositionBound bound, int move,
+	int partition)
+{
+	Bucket& bucket = GetBucket(key, partition);
+
+	// Reuse the slot of this position if there is one. Otherwise replace the entry that is worth the
+	// least: shallow entries from old searches go first.
+	int replaceSlot = 0;
+	int lowestWorth = 1 << 30;
+	for (int slot = 0; slot < s_bucketSize; ++slot)
+	{
+		uint64_t data = bucket.m_data[slot].load(std::memory_order_relaxed);
+		uint64_t storedKey = bucket.m_keys[slot].load(std::memory_order_relaxed);
+
+		if (data == 0 || (storedKey ^ data) == key)
+		{
+			// Keep the best move of a deeper result when this one has none.
+			if (data != 0 && move < 0)
+			{
+				TranspositionEntry existing;
+				UnpackData(data, existing);
+				move = existing.m_move;
+			}
+
+			replaceSlot = slot;
+			break;
+		}
+
+		int age = (m_generation - GetGeneration(data)) & s_generationMask;
+		int worth = GetDepth(data) - 8 * age;
+		if (worth < lowestWorth)
+		{
+			lowestWorth = worth;
+			replaceSlot = slot;
+		}
+	}
+
+	uint64_t data = PackData(score, depth < 0 ? 0 : depth, bound, m_generation, move);
+	bucket.m_keys[replaceSlot].store(key ^ data, std::memory_order_relaxed);
+	bucket.m_data[replaceSlot].store(data, std::memory_order_relaxed);
+}
+
+size_t TranspositionTable::GetSizeBytes() const
+{
+	return (m_bucketMask + 1) * sizeof(Bucket);
+}
+
+size_t TranspositionTable::GetEntryCount() const
+{
+	return (m_bucketMask + 1) * s_bucketSize;
+}
+
+int TranspositionTable::GetUsagePermille() const
+{
+	size_t sampleBuckets = s_usageSampleBuckets < m_bucketMask + 1 ? s_usageSampleBuckets : m_bucketMask + 1;
+
+	int used = 0;
+	for (size_t i = 0; i < sampleBuckets; ++i)
+	{
+		for (int slot = 0; slot < s_bucketSize; ++slot)
+		{
+			uint64_t data = m_buckets[i].m_data[slot].load(std::memory_order_relaxed);
+			if (data != 0 && GetGeneration(data) == m_generation)
+				++used;
+		}
+	}
+
+	return static_cast<int>(used * 1000 / (sampleBuckets * s_bucketSize));
+}
+
+TranspositionTable::Bucket& TranspositionTable::GetBucket(uint64_t key, int partition) const
+{
+	uint64_t partitionStart = static_cast<uint64_t>(partition) << m_partitionShift;
+	return m_buckets[(partitionStart + (key & m_partitionMask)) & m_bucketMask];
+}
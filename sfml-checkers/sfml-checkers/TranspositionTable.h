@@ -0,0 +1,96 @@
+//---------------------------------------------------------------
+//
+// TranspositionTable.h
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+enum TranspositionBound
+{
+	BOUND_NONE,
+	BOUND_UPPER,
+	BOUND_LOWER,
+	BOUND_EXACT,
+};
+
+enum TranspositionProbeResult
+{
+	// Nothing is stored for this position.
+	PROBE_MISS,
+
+	// The entry for this position was found.
+	PROBE_HIT,
+
+	// Nothing is stored for this position, and its bucket is taken by other positions.
+	PROBE_COLLISION,
+};
+
+struct TranspositionEntry
+{
+	TranspositionEntry();
+
+	int m_score;
+	int m_depth;
+	TranspositionBound m_bound;
+
+	// Best move encoded by the search, -1 if none.
+	int m_move;
+};
+
+// Fixed-size hash table of search results keyed by Zobrist key. Entries are grouped into buckets
+// of one cache line, so a probe touches a single line.
+//
+// Probing and storing are safe from any number of threads without locks. Every entry is two 64-bit
+// words, the packed data and the key xored with that data. A reader only accepts an entry whose
+// words xor back to its own key, so a torn write from another thread reads as a miss instead of
+// a corrupt entry.
+class TranspositionTable
+{
+public:
+	// Sizes the table to the largest power of two number of buckets that fits the budget.
+	explicit TranspositionTable(size_t megabytes);
+	~TranspositionTable();
+
+	void Clear();
+
+	// Ages the existing entries, so they are replaced first by the next search.
+	void NewSearch();
+
+	// Splits the buckets into equal, independent partitions, rounded up to a power of two. Searches
+	// that must not see each other's results each probe and store in their own partition.
+	void SetPartitionCount(int partitionCount);
+
+	TranspositionProbeResult Probe(uint64_t key, TranspositionEntry& entryOut, int partition = 0) const;
+	void Store(uint64_t key, int score, int depth, TranspositionBound bound, int move, int partition = 0);
+
+	size_t GetSizeBytes() const;
+	size_t GetEntryCount() const;
+
+	// Share of a sample of entries written by the current search, in permille.
+	int GetUsagePermille() const;
+
+private:
+	static const int s_bucketSize = 4;
+
+	struct alignas(64) Bucket
+	{
+		std::atomic<uint64_t> m_keys[s_bucketSize];
+		std::atomic<uint64_t> m_data[s_bucketSize];
+	};
+
+	Bucket& GetBucket(uint64_t key, int partition) const;
+
+	std::unique_ptr<Bucket[]> m_buckets;
+	uint64_t m_bucketMask;
+
+	// Buckets of one partition minus one, and the shift from partition index to its first bucket.
+	uint64_t m_partitionMask;
+	int m_partitionShift;
+
+	uint8_t m_generation;
+};
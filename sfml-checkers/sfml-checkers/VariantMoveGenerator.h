@@ -0,0 +1,235 @@
+//---------------------------------------------------------------
+//
+// VariantMoveGenerator.h
+//
+// Move generation for any rule set of BoardVariant.h. The rules are compile-time constants, so
+// every variant gets a generator with the branches of the other rule sets compiled out.
+//
+
+#pragma once
+
+#include "BoardVariant.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace VariantMoveGenerator {
+
+//==============================================================================
+
+namespace Detail {
+
+// The state of a capture sequence that does not change from hop to hop.
+template <class Rules>
+struct CaptureChain
+{
+	typedef typename BoardGeometry<Rules::s_boardSize>::Bitboard Bitboard;
+
+	int m_source;
+	Bitboard m_enemies;
+
+	// Empty squares, including the source the piece left. Captured pieces stay on the board until
+	// the turn is over, so they block the path of the rest of the sequence.
+	Bitboard m_empty;
+
+	Bitboard m_crownRow;
+	bool m_isWhitePlayer;
+};
+
+inline bool IsForward(BoardDirection direction, bool isWhitePlayer)
+{
+	bool isSouth = direction == DIRECTION_SOUTH_EAST || direction == DIRECTION_SOUTH_WEST;
+	return isSouth == isWhitePlayer;
+}
+
+template <class Rules>
+void AddCaptureSequences(const CaptureChain<Rules>& chain, int square, bool isKing,
+	typename CaptureChain<Rules>::Bitboard captured, std::vector<VariantMove<Rules>>& capturesOut)
+{
+	typedef BoardGeometry<Rules::s_boardSize> Geometry;
+	typedef typename Geometry::Bitboard Bitboard;
+	typedef typename Geometry::Traits Traits;
+
+	bool hasJumped = false;
+	for (int direction = 0; direction < DIRECTION_COUNT; ++direction)
+	{
+		BoardDirection boardDirection = static_cast<BoardDirection>(direction);
+		if (!isKing && !Rules::s_canMenCaptureBackward && !IsForward(boardDirection, chain.m_isWhitePlayer))
+			continue;
+
+		// A flying king may start its jump from anywhere along the empty diagonal.
+		int jumped = Geometry::GetNeighbor(square, boardDirection);
+		if (Rules::s_hasFlyingKings && isKing)
+		{
+			while (jumped >= 0 && (chain.m_empty & Traits::SquareMask(jumped)))
+			{
+				jumped = Geometry::GetNeighbor(jumped, boardDirection);
+			}
+		}
+
+		if (jumped < 0)
+			continue;
+
+		Bitboard jumpedMask = Traits::SquareMask(jumped);
+		if (!(chain.m_enemies & jumpedMask & ~captured))
+			continue;
+
+		// A flying king may land on any empty square behind the captured piece.
+		for (int landing = Geometry::GetNeighbor(jumped, boardDirection);
+			landing >= 0 && (chain.m_empty & Traits::SquareMask(landing));
+			landing = Geometry::GetNeighbor(landing, boardDirection))
+		{
+			hasJumped = true;
+
+			bool isCrowned = !isKing && (chain.m_crownRow & Traits::SquareMask(landing));
+			if (isCrowned && Rules::s_doesCrowningEndTurn)
+			{
+				VariantMove<Rules> capture;
+				capture.m_capturedPieces = captured | jumpedMask;
+				capture.m_source = static_cast<int8_t>(chain.m_source);
+				capture.m_destination = static_cast<int8_t>(landing);
+				capturesOut.push_back(capture);
+			}
+			else
+			{
+				// Otherwise a man keeps capturing as a man, it is only crowned where the turn ends.
+				AddCaptureSequences(chain, landing, isKing, captured | jumpedMask, capturesOut);
+			}
+
+			if (!(Rules::s_hasFlyingKings && isKing))
+				break;
+		}
+	}
+
+	// The chain ends where no further jump is possible.
+	if (!hasJumped && captured)
+	{
+		VariantMove<Rules> capture;
+		capture.m_capturedPieces = captured;
+		capture.m_source = static_cast<int8_t>(chain.m_source);
+		capture.m_destination = static_cast<int8_t>(square);
+		capturesOut.push_back(capture);
+	}
+}
+
+} // namespace Detail
+
+//==============================================================================
+
+// Appends every quiet (non capturing) move available to the side to move.
+template <class Rules>
+void GenerateMoves(const VariantPosition<Rules>& position, std::vector<VariantMove<Rules>>& movesOut)
+{
+	typedef BoardGeometry<Rules::s_boardSize> Geometry;
+	typedef typename Geometry::Bitboard Bitboard;
+	typedef typename Geometry::Traits Traits;
+
+	Bitboard empty = position.GetEmpty();
+	for (Bitboard pieces = position.GetPlayerPieces(); pieces; pieces = Traits::RemoveLowestSquare(pieces))
+	{
+		int source = Traits::GetLowestSquare(pieces);
+		bool isKing = static_cast<bool>(position.m_kings & Traits::SquareMask(source));
+
+		// Men only move forward, kings move both ways.
+		for (int direction = 0; direction < DIRECTION_COUNT; ++direction)
+		{
+			BoardDirection boardDirection = static_cast<BoardDirection>(direction);
+			if (!isKing && !Detail::IsForward(boardDirection, position.m_isWhitePlayerTurn))
+				continue;
+
+			for (int destination = Geometry::GetNeighbor(source, boardDirection);
+				destination >= 0 && (empty & Traits::SquareMask(destination));
+				destination = Geometry::GetNeighbor(destination, boardDirection))
+			{
+				VariantMove<Rules> move;
+				move.m_capturedPieces = Bitboard();
+				move.m_source = static_cast<int8_t>(source);
+				move.m_destination = static_cast<int8_t>(destination);
+				movesOut.push_back(move);
+
+				if (!(Rules::s_hasFlyingKings && isKing))
+					break;
+			}
+		}
+	}
+}
+
+// Appends every legal capture sequence of the side to move as one move from the first source to
+// the last destination, with every piece captured on the way. Where the maximum capture is
+// mandatory only the sequences capturing the most pieces are legal.
+template <class Rules>
+void GenerateCaptures(const VariantPosition<Rules>& position, std::vector<VariantMove<Rules>>& capturesOut)
+{
+	typedef BoardGeometry<Rules::s_boardSize> Geometry;
+	typedef typename Geometry::Bitboard Bitboard;
+	typedef typename Geometry::Traits Traits;
+
+	size_t firstCapture = capturesOut.size();
+	for (Bitboard pieces = position.GetPlayerPieces(); pieces; pieces = Traits::RemoveLowestSquare(pieces))
+	{
+		int source = Traits::GetLowestSquare(pieces);
+
+		Detail::CaptureChain<Rules> chain;
+		chain.m_source = source;
+		chain.m_enemies = position.GetEnemyPieces();
+		chain.m_empty = position.GetEmpty() | Traits::SquareMask(source);
+		chain.m_crownRow = position.GetCrownRow();
+		chain.m_isWhitePlayer = position.m_isWhitePlayerTurn;
+
+		bool isKing = static_cast<bool>(position.m_kings & Traits::SquareMask(source));
+		Detail::AddCaptureSequences(chain, source, isKing, Bitboard(), capturesOut);
+	}
+
+	if (Rules::s_isMaximumCaptureMandatory)
+	{
+		int maxCaptureCount = 0;
+		for (size_t i = firstCapture; i < capturesOut.size(); ++i)
+		{
+			int captureCount = Traits::GetSquareCount(capturesOut[i].m_capturedPieces);
+			if (captureCount > maxCaptureCount)
+				maxCaptureCount = captureCount;
+		}
+
+		size_t keptCount = firstCapture;
+		for (size_t i = firstCapture; i < capturesOut.size(); ++i)
+		{
+			if (Traits::GetSquareCount(capturesOut[i].m_capturedPieces) == maxCaptureCount)
+				capturesOut[keptCount++] = capturesOut[i];
+		}
+
+		capturesOut.resize(keptCount);
+	}
+
+	if (!Rules::s_isCapturePathSignificant)
+	{
+		size_t keptCount = firstCapture;
+		for (size_t i = firstCapture; i < capturesOut.size(); ++i)
+		{
+			bool isDuplicate = false;
+			for (size_t j = firstCapture; j < keptCount && !isDuplicate; ++j)
+			{
+				isDuplicate = capturesOut[j] == capturesOut[i];
+			}
+
+			if (!isDuplicate)
+				capturesOut[keptCount++] = capturesOut[i];
+		}
+
+		capturesOut.resize(keptCount);
+	}
+}
+
+// Appends every legal turn of the side to move: the captures if there are any, since capturing is
+// mandatory, and the quiet moves otherwise.
+template <class Rules>
+void GenerateTurns(const VariantPosition<Rules>& position, std::vector<VariantMove<Rules>>& turnsOut)
+{
+	size_t firstTurn = turnsOut.size();
+	GenerateCaptures(position, turnsOut);
+	if (turnsOut.size() == firstTurn)
+		GenerateMoves(position, turnsOut);
+}
+
+//==============================================================================
+
+} // namespace VariantMoveGenerator
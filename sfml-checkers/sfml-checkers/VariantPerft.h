@@ -0,0 +1,67 @@
+//---------------------------------------------------------------
+//
+// VariantPerft.h
+//
+
+#pragma once
+
+#include "VariantMoveGenerator.h"
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// Perft for the rule sets of BoardVariant.h. Counts like Perft does on the 8x8 Position, so
+// running it with EnglishRules gives the same numbers through the generic generator.
+template <class Rules>
+class VariantPerft
+{
+public:
+	// Returns the number of leaf nodes depth moves below the position.
+	uint64_t CountNodes(const VariantPosition<Rules>& position, int depth)
+	{
+		if (depth <= 0)
+			return 1;
+
+		return CountNodesAtLevel(position, depth, 0);
+	}
+
+private:
+	typedef std::vector<VariantMove<Rules>> TurnList;
+
+	uint64_t CountNodesAtLevel(const VariantPosition<Rules>& position, int depth, int level)
+	{
+		TurnList& turns = GetTurnList(level);
+		turns.clear();
+		VariantMoveGenerator::GenerateTurns(position, turns);
+
+		// Bulk count the last ply, the turns themselves are all we need.
+		if (depth == 1)
+			return turns.size();
+
+		uint64_t nodes = 0;
+		for (const VariantMove<Rules>& turn : turns)
+		{
+			VariantPosition<Rules> child = position;
+			child.MakeMove(turn);
+			nodes += CountNodesAtLevel(child, depth - 1, level + 1);
+		}
+
+		return nodes;
+	}
+
+	// Turn list storage, one per recursion level. The lists keep their capacity, so after the first
+	// walk down nothing is allocated while counting.
+	TurnList& GetTurnList(int level)
+	{
+		while (static_cast<int>(m_turnLists.size()) <= level)
+		{
+			m_turnLists.push_back(TurnList());
+		}
+
+		return m_turnLists[level];
+	}
+
+	// A deque, so growing it keeps the lists of the levels above valid.
+	std::deque<TurnList> m_turnLists;
+};
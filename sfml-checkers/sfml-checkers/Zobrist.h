@@ -0,0 +1,104 @@
+//---------------------------------------------------------------
+//
+// Zobrist.h
+//
+
+#pragma once
+
+#include "MoveList.h"
+#include "Position.h"
+
+#include <cstdint>
+
+namespace Zobrist {
+
+//==============================================================================
+
+struct KeyTable
+{
+	// Indexed by PieceDisplayType and square. The EMPTY row is all zero, so xoring the key of an
+	// empty square is a no-op.
+	uint64_t m_pieceKeys[EMPTY + 1][s_squareCount];
+
+	// Xored in while white is to move.
+	uint64_t m_whiteToMoveKey;
+};
+
+// The keys are generated at compile time from a fixed seed, so hash keys are identical across runs
+// and builds.
+constexpr KeyTable CreateKeyTable()
+{
+	KeyTable table = {};
+	uint64_t state = 0x4A3B2C1D5E6F7081ull;
+	auto nextKey = [&state]()
+	{
+		// SplitMix64.
+		uint64_t key = (state += 0x9E3779B97F4A7C15ull);
+		key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+		key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+		return key ^ (key >> 31);
+	};
+
+	for (int piece = 0; piece < EMPTY; ++piece)
+	{
+		for (int square = 0; square < s_squareCount; ++square)
+		{
+			table.m_pieceKeys[piece][square] = nextKey();
+		}
+	}
+
+	table.m_whiteToMoveKey = nextKey();
+	return table;
+}
+
+inline constexpr KeyTable s_keyTable = CreateKeyTable();
+
+inline uint64_t GetPieceKey(PieceDisplayType piece, int square)
+{
+	return s_keyTable.m_pieceKeys[piece][square];
+}
+
+inline uint64_t GetSideKey()
+{
+	return s_keyTable.m_whiteToMoveKey;
+}
+
+// Computes the key of a position from scratch. Game and the search keep keys up to date
+// incrementally, this is for setting up and for verifying them.
+inline uint64_t ComputeKey(const Position& position)
+{
+	uint64_t key = position.m_isWhitePlayerTurn ? GetSideKey() : 0;
+	for (Bitboard pieces = position.GetOccupied(); pieces; pieces &= pieces - 1)
+	{
+		int square = GetLowestSquare(pieces);
+		key ^= GetPieceKey(position.GetPiece(square), square);
+	}
+
+	return key;
+}
+
+// Returns the key of the position after the turn from the key before it, without playing it.
+inline uint64_t GetKeyAfterTurn(const Position& position, uint64_t key, const PackedMove& turn)
+{
+	for (Bitboard captured = turn.GetCapturedPieces(); captured; captured &= captured - 1)
+	{
+		int square = GetLowestSquare(captured);
+		key ^= GetPieceKey(position.GetPiece(square), square);
+	}
+
+	// A man is crowned on the far row.
+	PieceDisplayType piece = position.GetPiece(turn.GetSource());
+	PieceDisplayType landedPiece = piece;
+	Bitboard destinationMask = SquareMask(turn.GetDestination());
+	if (piece == WHITE && (destinationMask & s_bottomRow))
+		landedPiece = WHITE_KING;
+	else if (piece == BLACK && (destinationMask & s_topRow))
+		landedPiece = BLACK_KING;
+
+	return key ^ GetSideKey() ^ GetPieceKey(piece, turn.GetSource())
+		^ GetPieceKey(landedPiece, turn.GetDestination());
+}
+
+//==============================================================================
+
+} // namespace Zobrist
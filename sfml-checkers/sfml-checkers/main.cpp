@@ -2,13 +2,74 @@
 //
 // main.cpp
 //
+// usage: sfml-checkers [--computer white|black] [--depth <plies>] [--movetime <ms>] [--hash <MB>]
+//   [--threads <count>] [--ponder on|off] [--log <file>] [--flip on|off] [--record <file>]
+//
 
 #include "AppController.h"
+#include "Log.h"
+
+#include <cstdlib>
+#include <string>
 
-int main()
+int main(int argc, char** argv)
 {
-	AppController appController;
+	AppSettings settings;
+	std::string logFilePath;
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string argument(argv[i]);
+		std::string value(argv[i + 1]);
+
+		if (argument == "--computer")
+		{
+			settings.m_hasComputerPlayer = true;
+			settings.m_isComputerWhite = value == "white";
+		}
+		else if (argument == "--depth")
+		{
+			settings.m_searchLimits.m_maxDepth = std::atoi(value.c_str());
+		}
+		else if (argument == "--movetime")
+		{
+			settings.m_searchLimits.m_moveTimeMs = std::atoi(value.c_str());
+		}
+		else if (argument == "--hash")
+		{
+			settings.m_hashMegabytes = static_cast<size_t>(std::atoi(value.c_str()));
+		}
+		else if (argument == "--threads")
+		{
+			settings.m_threadCount = std::atoi(value.c_str());
+		}
+		else if (argument == "--ponder")
+		{
+			settings.m_isPonderingEnabled = value == "on";
+		}
+		else if (argument == "--flip")
+		{
+			settings.m_isBoardFlipped = value == "on";
+		}
+		else if (argument == "--record")
+		{
+			settings.m_recordFilePath = value;
+		}
+		else if (argument == "--log")
+		{
+			logFilePath = value;
+		}
+	}
+
+	// Messages are written by a thread of their own, so logging never stalls the game loop.
+	if (!Logger::StartBackgroundLogging(logFilePath))
+		Logger::StartBackgroundLogging();
+
+	{
+		AppController appController(settings);
+		appController.Run();
+	}
 
-	appController.Run();
+	Logger::StopBackgroundLogging();
 	return 0;
 }